@@ -0,0 +1,47 @@
+#ifndef ADC_DECODE_H
+#define ADC_DECODE_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Dekodierung der DMA-Daten im Format ADC_DIGI_OUTPUT_FORMAT_TYPE1:
+ * Jeder Eintrag ist 16 Bit breit, Bits 0..11 = Messwert, Bits 12..15 = Kanal.
+ * Die Funktionen entpacken Messwert und Kanal in einer Schleife, verwerfen Einträge
+ * fremder Kanäle und schreiben direkt in die Analysepuffer.
+ */
+
+#define ADC_DECODE_MAX_CHANNELS 16
+
+// Kanal → Ausgangsindex (-1 = Kanal gehört nicht zum Pattern)
+typedef struct {
+    int8_t slot[ADC_DECODE_MAX_CHANNELS];
+    int num_slots;
+} adc_decode_map_t;
+
+// Baut die Zuordnung für num_channels Kanäle in Pattern-Reihenfolge auf.
+void adc_decode_map_init(adc_decode_map_t *map, const uint8_t *channels, int num_channels);
+
+// Ein Kanal → int16 (0..4095). Liefert die Anzahl geschriebener Samples (max. max_out),
+// *invalid wird um die Anzahl verworfener Einträge erhöht. raw muss 4-Byte-ausgerichtet sein.
+uint32_t adc_decode_type1_s16(const uint8_t *raw, uint32_t bytes, uint8_t channel,
+                              int16_t *out, uint32_t max_out, uint32_t *invalid);
+
+// Ein Kanal → float (0..4095), sonst wie adc_decode_type1_s16.
+uint32_t adc_decode_type1_f32(const uint8_t *raw, uint32_t bytes, uint8_t channel,
+                              float *out, uint32_t max_out, uint32_t *invalid);
+
+// Mehrere Kanäle (Pattern mit num_slots Einträgen) → je ein int16-Puffer pro Kanal.
+// counts[slot] wird pro geschriebenem Sample erhöht (max. max_out je Kanal).
+void adc_decode_type1_multi_s16(const uint8_t *raw, uint32_t bytes, const adc_decode_map_t *map,
+                                int16_t *const *outs, uint32_t *counts, uint32_t max_out,
+                                uint32_t *invalid);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // ADC_DECODE_H
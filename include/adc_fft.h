@@ -6,27 +6,188 @@
 #include "driver/adc.h"
 #include "esp_adc/adc_continuous.h"
 #include "config.h"  // Enthält u.a. NUM_BUFFERS, FFT_SIZE, SAMPLE_RATE, LF_LOW_FREQ, LF_HIGH_FREQ, etc.
+#include "tone_tracker.h"
+#include "spectrum_avg.h"
+#include "spectrogram.h"
+#include "window.h"
 
 // ADC-Handle für den kontinuierlichen Betrieb
 extern adc_continuous_handle_t adc_handle;
 
-// Globale Variablen für die ermittelte Hauptfrequenz (LF-Bereich) und deren Magnitude
-extern float main_frequency;
-extern float max_magnitude;
+// Globale Variablen für die ermittelte Hauptfrequenz (LF-Bereich) und deren Magnitude je Kanal
+extern float main_frequency[ADC_NUM_CHANNELS];
+extern float max_magnitude[ADC_NUM_CHANNELS];
 
-// Ringpuffer für die FFT-Daten
-extern int16_t collected_data[NUM_BUFFERS][FFT_SIZE];
-extern int current_buffer_index; // Aktueller Index im Ringpuffer
+// Zeilen (zu FFT_SIZE Samples) hinter dem Ring, in die der Anfang für zusammenhängende Frames gespiegelt wird
+#define RING_MIRROR_ROWS (FFT_MAX_SIZE / FFT_SIZE)
+
+// Ringpuffer für die FFT-Daten je Kanal (NUM_BUFFERS Zeilen + Spiegelbereich für Frames bis FFT_MAX_SIZE)
+extern int16_t collected_data[ADC_NUM_CHANNELS][NUM_BUFFERS + RING_MIRROR_ROWS][FFT_SIZE];
+extern int current_buffer_index; // Aktueller Index im Ringpuffer (für alle Kanäle gleich)
+
+// Zähler des ADC-Datenstroms
+typedef struct {
+    uint32_t samples_received;   // insgesamt in die Ringpuffer geschriebene Samples (alle Kanäle, nach Dezimierung)
+    uint32_t frames_analyzed;    // ausgeführte FFT-Frames
+    uint32_t frames_dropped;     // verworfene Frames (DSP-Task ausgelastet)
+    uint32_t dma_overruns;       // Überläufe des DMA-Pools
+    uint32_t dropped_samples;    // dabei verworfene Samples
+    uint32_t invalid_samples;    // DMA-Einträge mit falscher Kanalnummer
+} adc_stream_stats_t;
+
+// Energie-Gate und Stationarität der normalen FFT (ENABLE_ENERGY_GATE, STATIONARY_MAX_INTERVAL), über alle Kanäle
+typedef struct {
+    uint32_t frames;               // geprüfte Frames (je Kanal gezählt)
+    uint32_t silent;               // ohne FFT als leise erkannt
+    uint32_t held;                 // ohne FFT mit dem letzten Ergebnis
+    uint32_t analyzed;             // voll ausgewertet
+    uint32_t avg_analysis_cycles;  // mittlere Zyklen einer vollen Auswertung
+    uint32_t avg_gate_cycles;      // mittlere Zyklen der Entscheidung (Energie über den Block)
+    float cpu_saved;               // eingesparter Anteil der Rechenzeit (0..1, abzüglich der Entscheidung)
+    uint32_t changes;              // Änderungen, die erst nach gehaltenen Frames erkannt wurden
+    float avg_latency_ms;          // dadurch zusätzliche Verzögerung (Mittel, Maximum)
+    float max_latency_ms;
+    int interval;                  // aktueller Abstand der vollen Auswertungen (Kanal 0)
+} adc_gate_stats_t;
+
+// Ergebnis der Bandsuche: Fenster mit hoher integrierter Amplitude im LF-Bereich
+typedef struct {
+    float center_hz;   // Fenstermitte in Hz (ohne OFFSET)
+    float width_hz;    // Fensterbreite in Hz
+    float sum;         // integrierte Amplitude (0 = nicht belegt)
+} adc_band_t;
+
+// Grundfrequenz-Detektoren (Auswahl über FREQ_DETECTOR)
+typedef enum {
+    DETECTOR_BAND = 0,    // Spitze im stärksten WINDOW_BANDWIDTH_HZ-Fenster (springt bei starken Obertönen)
+    DETECTOR_HPS,         // Harmonic Product Spectrum über die Magnituden
+    DETECTOR_YIN,         // YIN (normierte Differenzfunktion im Zeitbereich, nur normale FFT)
+    DETECTOR_COUNT
+} adc_detector_id_t;
+
+// Glättung der Hauptfrequenz (Auswahl über FREQ_SMOOTHER)
+typedef enum {
+    FREQ_SMOOTH_RATE_LIMIT = 0,   // Sprung je Frame auf RATE_LIMIT_MAX_JUMP_HZ begrenzt
+    FREQ_SMOOTH_KALMAN,           // Kalman-Filter über Frequenz und Steigung (freq_kalman.h)
+} adc_freq_smoother_t;
+
+// Rechenzeit und Stabilität eines Detektors (über alle Kanäle)
+typedef struct {
+    const char *name;
+    bool active;             // liefert main_frequency
+    uint32_t frames;         // Aufrufe seit dem Start
+    uint32_t avg_cycles;     // mittlere Zyklen je Aufruf
+    uint32_t last_cycles;    // Zyklen des letzten Aufrufs
+    uint32_t octave_jumps;   // Sprünge um etwa eine Oktave oder mehr zwischen zwei Frames
+    uint32_t failures;       // Aufrufe ohne Ergebnis (Rückfall auf DETECTOR_BAND)
+} adc_detector_stats_t;
+
+// Kenndaten des gemittelten Spektrums eines Kanals (ENABLE_SPECTRUM_AVG)
+typedef struct {
+    int bins;          // Bins ab 0 Hz (SPECTRUM_AVG_BINS)
+    float bin_hz;      // Abstand der Bins
+    float scale;       // Faktor auf die Leistung, damit ein Sinus der Amplitude A den Wert A² hat
+    float enbw;        // Rauschbandbreite des Fensters in Bins (Rauschdichte = Leistung * scale / (enbw * bin_hz))
+    uint32_t frames;   // aufgenommene Frames seit dem letzten Zurücksetzen
+    uint32_t blocks;   // vollständige Blöcke der linearen Mittelung
+} adc_spectrum_info_t;
+
+// Kenndaten des Spektrogramms eines Kanals (ENABLE_SPECTROGRAM, Zeilenformat siehe spectrogram.h)
+typedef struct {
+    int bins;            // belegte Bins ab 0 Hz bei der aktiven FFT-Größe (SPECTROGRAM_BINS_FOR, bis LF_HIGH_FREQ)
+    int rows;            // Zeilen im Ring
+    int row_size;        // Bytes je Zeile inkl. Kopf (Platz für SPECTROGRAM_BINS, unabhängig von der FFT-Größe)
+    float bin_hz;        // Abstand der Bins
+    float row_seconds;   // Zeit zwischen zwei Zeilen
+    uint32_t oldest;     // Nummer der ältesten lesbaren Zeile (ältere stammen von einer anderen FFT-Größe)
+    uint32_t head;       // Nummer der nächsten Zeile
+} adc_spectrogram_info_t;
+
+// Aktive FFT-Größe und Fenster der normalen FFT und Zustand des Plan-Caches
+typedef struct {
+    int fft_size;        // aktive Größe
+    int requested;       // angeforderte Größe (übernommen vor dem nächsten Frame)
+    const char *window;  // aktives Fenster (window_name)
+    float coherent_gain; // Kenngrößen des Fensters (window.h)
+    float enbw;
+    float bin_hz;        // Abstand der Bins
+    int hop;             // Samples zwischen zwei Frames
+    int cached_plans;    // aufgebaute Pläne im Cache
+    uint32_t plan_hits;  // Größenwechsel mit bereits aufgebautem Plan
+    uint32_t plan_misses;
+} adc_fft_size_info_t;
+
+// Einstellung der Zoom-FFT (ENABLE_ZOOM_FFT)
+typedef struct {
+    float low_hz;      // untere Bandgrenze
+    float high_hz;     // obere Bandgrenze
+    int factor;        // verwendeter Zoomfaktor (0 = Zoom-FFT nicht aktiv)
+    float bin_hz;      // Auflösung der Zoom-FFT
+} adc_zoom_config_t;
 
 // Initialisiert den ADC im Continuous-Modus
 void configure_adc_continuous();
 
-// Startet den Task, der ADC-Daten sammelt und die FFT ausführt
-void collect_adc_continuous_data();
+// Startet den ADC-Reader (ADC_READER_CORE), der die Daten lückenlos sammelt, und den DSP-Task
+// (DSP_TASK_CORE), der alle STFT_HOP_SIZE Samples die FFT ausführt.
+void start_adc_fft_tasks();
+
+// Führt die FFT über die Samples eines Kanals (0..ADC_NUM_CHANNELS-1, aktive FFT-Größe) aus, bestimmt die
+// Hauptfrequenz im LF-Bereich anhand eines gleitenden Fensters, berücksichtigt die relative
+// Amplitude und wendet Rate Limiting an.
+void perform_fft(int channel, const int16_t *samples);
+
+// Kopiert die Bänder der letzten Bandsuche eines Kanals nach out (je Fensterbreite aus
+// BAND_WIDTHS_HZ die BAND_SEARCH_TOP_K stärksten, absteigend). Liefert die Anzahl der Einträge.
+int adc_fft_get_bands(int channel, adc_band_t *out, int max_bands);
+
+// Kopiert die Ergebnisse der Tracker-Bank eines Kanals nach out (je Zielfrequenz aus
+// TONE_TRACKER_FREQS ein Eintrag). Liefert die Anzahl der Einträge (0 ohne ENABLE_TONE_TRACKER).
+int adc_fft_get_tones(int channel, tone_result_t *out, int max_tones);
+
+// Kopiert Rechenzeit und Stabilität der Detektoren nach out (nur der aktive läuft, mit
+// ENABLE_DETECTOR_BENCHMARK alle; Stand des zuletzt ausgewerteten Frames). Liefert die Anzahl der Einträge.
+int adc_fft_get_detector_stats(adc_detector_stats_t *out, int max);
+
+// Gemitteltes Spektrum (normale FFT, siehe spectrum_avg.h): Kenndaten, Leistungen der Bins
+// first..first+n-1 eines Verfahrens (unskaliert, siehe scale) und Zurücksetzen (channel -1 = alle,
+// ausgeführt vor dem nächsten Frame). ESP_ERR_NOT_SUPPORTED ohne ENABLE_SPECTRUM_AVG.
+esp_err_t adc_fft_get_spectrum_info(int channel, adc_spectrum_info_t *info);
+esp_err_t adc_fft_read_spectrum(int channel, spectrum_avg_mode_t mode, int first, int n, float *out);
+esp_err_t adc_fft_reset_spectrum(int channel);
+
+// Spektrogramm (normale FFT, siehe spectrogram.h): Kenndaten und bis zu count Zeilen ab Nummer from
+// (zu alte Nummern werden auf die älteste vorhandene angehoben, *first = erste kopierte Nummer).
+// Liefert die Anzahl der Zeilen (0 ohne ENABLE_SPECTROGRAM). Konnte der Ring beim Start nicht angelegt
+// werden, liefert adc_fft_get_spectrogram_info ESP_ERR_INVALID_STATE.
+esp_err_t adc_fft_get_spectrogram_info(int channel, adc_spectrogram_info_t *info);
+int adc_fft_read_spectrogram(int channel, uint32_t from, int count, uint8_t *out, uint32_t *first);
+
+// Stellt die Größe der normalen FFT ein (Zweierpotenz FFT_MIN_SIZE..FFT_MAX_SIZE). Der Plan wird beim
+// ersten Gebrauch aufgebaut und zwischengespeichert; der DSP-Task übernimmt die Größe vor dem nächsten
+// Frame, der Abstand der Frames wächst mit (gleiche Überlappung). Gemitteltes Spektrum und Spektrogramm
+// beginnen dabei neu. ESP_ERR_NOT_SUPPORTED mit ENABLE_ZOOM_FFT, ESP_ERR_INVALID_ARG bei ungültiger Größe.
+esp_err_t adc_fft_set_fft_size(int fft_size);
+void adc_fft_get_fft_size(adc_fft_size_info_t *info);
+
+// Stellt das Fenster der normalen FFT ein (Tabelle je Größe einmal berechnet, übernommen vor dem
+// nächsten Frame). Tonamplituden, Bandsummen und MIN_TOTAL_AMPLITUDE bleiben vergleichbar, nur der
+// Rauschboden im gemittelten Spektrum ändert sich mit enbw. ESP_ERR_NOT_SUPPORTED mit ENABLE_ZOOM_FFT.
+esp_err_t adc_fft_set_window(window_type_t type);
+
+// Stellt Band und Faktor der Zoom-FFT ein (factor 0 = größter passender Faktor). Die Einstellung
+// wird vom DSP-Task vor dem nächsten Frame übernommen. ESP_ERR_NOT_SUPPORTED ohne ENABLE_ZOOM_FFT,
+// ESP_ERR_INVALID_ARG bei ungültigem Band oder zu großem Faktor.
+esp_err_t adc_fft_set_zoom(float low_hz, float high_hz, int factor);
+
+// Liefert die aktive Einstellung der Zoom-FFT (factor 0, wenn sie nicht aktiv ist).
+void adc_fft_get_zoom(adc_zoom_config_t *config);
+
+// Liefert die aktuellen Zähler des ADC-Datenstroms (verlorene Samples, Überläufe, ...)
+void adc_fft_get_stats(adc_stream_stats_t *stats);
 
-// Führt die FFT aus, bestimmt die Hauptfrequenz im LF-Bereich anhand eines gleitenden Fensters,
-// berücksichtigt die relative Amplitude und wendet Rate Limiting an.
-void perform_fft();
+// Liefert die Zähler von Energie-Gate und Stationarität (ohne beide Verfahren bzw. mit Zoom-FFT alle 0).
+void adc_fft_get_gate_stats(adc_gate_stats_t *stats);
 
 // Speichert die ADC-Daten (Beispielimplementierung)
 void save_adc_data();
@@ -0,0 +1,46 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Statischer Scratch-Speicher mit festem Budget je Subsystem (Bump-Allocator).
+ * Allokationen eines Subsystems werden am Ende einer Anfrage gesammelt mit arena_reset()
+ * freigegeben, so dass im laufenden Betrieb weder malloc() noch Heap-Fragmentierung auftreten.
+ * Jedes Subsystem darf nur aus einem Task heraus verwendet werden (HTTP und WebSocket laufen
+ * beide im httpd-Task).
+ */
+typedef enum {
+    ARENA_HTTP = 0,   // HTTP-Handler: Dateipuffer, JSON-Antworten
+    ARENA_WS,         // WebSocket: empfangene Nachricht, JSON-Antwort
+    ARENA_FFT,        // DSP-Task: Arbeitspuffer der aktiven FFT-Größe (neu aufgeteilt beim Größenwechsel)
+    ARENA_COUNT
+} arena_id_t;
+
+typedef struct {
+    const char *name;
+    uint32_t size;       // Budget in Bytes
+    uint32_t used;       // aktuell belegt
+    uint32_t peak;       // maximal belegt seit dem Start
+    uint32_t failures;   // abgelehnte Anforderungen (Budget überschritten)
+} arena_stats_t;
+
+// Liefert size Bytes (8-Byte-ausgerichtet) aus dem Budget des Subsystems oder NULL.
+void *arena_alloc(arena_id_t id, size_t size);
+
+// Gibt alle Allokationen des Subsystems frei.
+void arena_reset(arena_id_t id);
+
+// Liefert Budget, aktuelle und maximale Belegung des Subsystems.
+void arena_get_stats(arena_id_t id, arena_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // ARENA_H
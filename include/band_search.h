@@ -0,0 +1,53 @@
+#ifndef BAND_SEARCH_H
+#define BAND_SEARCH_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Bandsuche über ein Magnitudenspektrum: Für jede Fensterbreite (in Bins) werden die integrierten
+ * Amplituden aller Fensterpositionen mit einer laufenden Summe bestimmt (O(n) je Breite statt
+ * O(n * Breite)) und die top_k stärksten, nicht überlappenden Fenster absteigend sortiert
+ * zurückgegeben: das stärkste Fenster, dann das stärkste, das dieses nicht überlappt, usw. (ein
+ * Durchlauf je Eintrag). Alle Breiten werden in einem Aufruf auf demselben Spektrum ausgewertet.
+ */
+
+#define BAND_SEARCH_MAX_WIDTHS 8
+#define BAND_SEARCH_MAX_TOP_K 8
+
+typedef struct {
+    int start;     // erster Bin des Fensters (relativ zum übergebenen Spektrum)
+    int width;     // Fensterbreite in Bins
+    float sum;     // integrierte Amplitude
+} band_window_t;
+
+// Durchsucht mag[0..n-1] für num_widths Fensterbreiten. Ergebnisse für Breite w liegen in
+// results[w * top_k .. w * top_k + top_k - 1]; nicht belegte Einträge haben sum = 0 und start = 0.
+// Breiten größer als n werden auf n begrenzt. Wie bisher zählen nur Fenster mit sum > 0.
+void band_search(const float *mag, int n, const int *widths, int num_widths, int top_k,
+                 band_window_t *results);
+
+// Maß für den Beitrag eines Bins zur Bandsumme
+typedef enum {
+    BAND_METRIC_POWER = 0,        // re² + im² (ohne Wurzel)
+    BAND_METRIC_MAGNITUDE,        // sqrtf(re² + im²), exakt
+    BAND_METRIC_MAGNITUDE_FAST,   // re² + im² mit dsps_sqrt_f32 (Näherung über den Exponenten, wenige % Fehler)
+    BAND_METRIC_AMBM,             // Alpha-Max-plus-Beta-Min, ohne Multiplikation der Komponenten (max. ~4 % Fehler)
+} band_metric_t;
+
+// Berechnet das Maß für n Bins aus dem interleaved re/im-Spektrum nach out. POWER und
+// MAGNITUDE_FAST laufen über die esp-dsp-Vektorfunktionen und benötigen scratch (n Werte),
+// die übrigen Maße kommen mit einem Durchlauf ohne Zwischenpuffer aus (scratch darf NULL sein).
+void band_magnitudes(const float *spectrum, int n, band_metric_t metric, float *out, float *scratch);
+
+// Bisherige Suche (O(n * width), nur bestes Fenster) als Referenz für Vergleichsmessungen.
+band_window_t band_search_naive(const float *mag, int n, int width);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // BAND_SEARCH_H
@@ -6,14 +6,66 @@
 // ---------------------
 #define ENABLE_FASTDETECT_LOGS 0  // Set to 1 to enable logs for fastdetect, 0 to disable
 #define ENABLE_ADC_FFT_LOGS 0     // Set to 1 to enable logs for adc_fft, 0 to disable
+#define ENABLE_FRAME_LOAD_BENCHMARK 0   // 1 = FFT-Eingangsstufe beim Start isoliert vermessen (Log)
+#define ENABLE_BAND_SEARCH_BENCHMARK 0  // 1 = laufender Vergleich mit der bisherigen O(n * Breite)-Suche (Log alle 256 Frames)
+#define ENABLE_ZOOM_FFT_BENCHMARK 0     // 1 = Zoom-FFT beim Start mit der normalen FFT vergleichen (Genauigkeit, Zyklen; Log)
+#define ENABLE_TONE_TRACKER_BENCHMARK 0 // 1 = Tracker-Bank beim Start mit der vollen FFT vergleichen (Log)
+#define ENABLE_PEAK_INTERP_BENCHMARK 0  // 1 = Genauigkeit und Zyklen der Peak-Schätzer beim Start vermessen (Log)
+#define ENABLE_DETECTOR_BENCHMARK 0     // 1 = alle Grundfrequenz-Detektoren je Frame ausführen (Zyklen, Oktavsprünge; Log alle 256 Frames)
+#define ENABLE_SPECTROGRAM_BENCHMARK 0  // 1 = dB-Umrechnung des Spektrogramms beim Start mit log10f vergleichen (Log)
+#define ENABLE_FREQ_KALMAN_BENCHMARK 0  // 1 = Kalman-Filter beim Start auf synthetischen Sweeps mit dem Rate Limiting vergleichen (Log)
 
 // ---------------------
 // Audio and FFT Configuration
 // ---------------------
 #define SAMPLE_RATE 44100          // Sample rate in Hz
-#define FFT_SIZE 1024              // FFT size (number of samples to collect)
+#define FFT_SIZE 1024              // FFT size (number of samples to collect); Startgröße, zur Laufzeit änderbar (/fft)
+#define FFT_MIN_SIZE 256           // kleinste Laufzeit-Größe (Zweierpotenz, >= 256)
+#define FFT_MAX_SIZE 2048          // größte Laufzeit-Größe (Vielfaches von FFT_SIZE, <= 8192; bestimmt ARENA_FFT_BUDGET
+                                   // und den Spiegelbereich des Ringpuffers, 8192 nur mit PSRAM bzw. kleinerem NUM_BUFFERS)
 #define ADC_CHANNEL ADC_CHANNEL_0  // ADC channel
+#define ADC_NUM_CHANNELS 1         // Anzahl der Kanäle im DMA-Pattern (je Kanal eine eigene Analyse-Pipeline)
+#define ADC_CHANNEL_LIST { ADC_CHANNEL }   // Kanäle in Pattern-Reihenfolge, z. B. { ADC_CHANNEL_0, ADC_CHANNEL_3 }
 #define ADC_ATTEN ADC_ATTEN_DB_12  // ADC attenuation (0-3.3V range)
+#define DECIMATION_FACTOR 1        // 1 = aus; z. B. 8 → 5512,5 Hz Analyserate, Bins ≈ 5,4 Hz statt 43 Hz (Frames dauern 8x länger)
+#define DECIMATION_FIR_TAPS (32 * DECIMATION_FACTOR)   // Länge des Anti-Aliasing-Filters (Vielfaches von 4)
+#define ANALYSIS_SAMPLE_RATE ((float)SAMPLE_RATE / DECIMATION_FACTOR)   // Abtastrate der Samples im Ringpuffer / der FFT
+#define FFT_REAL_INPUT 1           // 1 = Real-FFT (N/2 komplexe FFT + dsps_cplx2real), 0 = komplexe FFT mit Imaginärteil 0
+#define FFT_WINDOW WINDOW_HANN      // Startfenster (window.h): WINDOW_HANN, _BLACKMAN, _BLACKMAN_HARRIS, _BLACKMAN_NUTTALL,
+                                   // _NUTTALL oder _FLAT_TOP (genaue Amplituden); zur Laufzeit änderbar (/fft?window=)
+
+// Zoom-FFT (siehe zoom_fft.h): Band ins Basisband mischen, dezimieren und nur dieses Band transformieren.
+// Ersetzt die FFT über FFT_SIZE in der Auswertung; Band und Faktor sind zur Laufzeit änderbar (/zoom).
+#define ENABLE_ZOOM_FFT 0          // 1 = Zoom-FFT statt normaler FFT
+#define ZOOM_FFT_SIZE 1024         // komplexe Punkte der Zoom-FFT (<= CONFIG_DSP_MAX_FFT_SIZE)
+#define ZOOM_LOW_FREQ LF_LOW_FREQ  // Startwerte für das Zoom-Band in Hz
+#define ZOOM_HIGH_FREQ LF_HIGH_FREQ
+#define ZOOM_FACTOR 0              // 0 = größter Faktor, bei dem das Band passt (200..2500 Hz → 15, Bins ≈ 2,9 Hz)
+#define ZOOM_MAX_FACTOR 32         // obere Grenze für den Faktor (bestimmt die Filterpuffer)
+#define ZOOM_FIR_TAPS_PER_FACTOR 20   // Filterlänge = Faktor * Wert (Vielfaches von 4)
+
+// Tracker-Bank (siehe tone_tracker.h): Amplitude, Phase und Frequenz bekannter Zielfrequenzen ohne
+// volle FFT. Die normale FFT läuft dann nur noch alle TONE_TRACKER_FFT_INTERVAL Frames als Scan.
+#define ENABLE_TONE_TRACKER 0      // 1 = Tracker-Bank aktiv
+#define TONE_TRACKER_FREQS { 1000.0f, 1500.0f }   // Zielfrequenzen in Hz (höchstens 8)
+#define TONE_TRACKER_MODE TONE_TRACKER_GOERTZEL   // oder TONE_TRACKER_SLIDING (Ergebnis nach jedem Sample)
+#define TONE_TRACKER_LEN 256       // Block- bzw. Fensterlänge in Samples (Auflösung ≈ ANALYSIS_SAMPLE_RATE / Länge)
+#define TONE_TRACKER_FFT_INTERVAL 8   // volle FFT nur jeden n-ten Frame (1 = jeden Frame)
+
+// Spektrum-Mittelung (siehe spectrum_avg.h): lineare (Welch) und exponentielle Mittelung, Peak- und
+// Min-Hold über die Leistungsspektren der normalen FFT; abrufbar über /spectrum und WebSocket ("spectrum:<ch>:<mode>").
+#define ENABLE_SPECTRUM_AVG 1
+#define SPECTRUM_AVG_BINS (FFT_SIZE / 2)   // gemittelte Bins ab 0 Hz (je Kanal 5 * 4 Byte pro Bin)
+#define SPECTRUM_AVG_FRAMES 16     // lineare Mittelung über Blöcke von n Frames
+#define SPECTRUM_AVG_ALPHA 0.1f    // exponentielle Mittelung: Anteil des neuen Frames
+
+// Spektrogramm (siehe spectrogram.h): Ring der letzten Zeilen der normalen FFT mit 8 Bit dB je Bin und
+// eigener Skala je Zeile; Zeitausschnitte als Binärblock über /spectrogram. Liegt im PSRAM, falls vorhanden.
+#define ENABLE_SPECTROGRAM 1
+#define SPECTROGRAM_BINS_FOR(size) ((int)(LF_HIGH_FREQ * (size) / ANALYSIS_SAMPLE_RATE) + 2)   // Bins ab 0 Hz bis LF_HIGH_FREQ
+#define SPECTROGRAM_BINS SPECTROGRAM_BINS_FOR(FFT_MAX_SIZE)   // Platz je Zeile; kleinere FFT-Größen belegen weniger Bins
+#define SPECTROGRAM_ROWS 256       // Zeilen im Ring (je Kanal ROWS * (BINS + 8) Byte, Standard ≈ 33 KB; mit PSRAM deutlich mehr)
+#define SPECTROGRAM_DIVIDER 4      // Frames je Zeile (Mittelwert der Leistung); 256 Zeilen ≈ 12 s bei FFT_SIZE 1024, 24 s bei 2048
 
 // ---------------------
 // Frequency Range & Detection Parameters
@@ -25,6 +77,39 @@
 // Fensterbreite für die Segmentintegration (z. B. 200 Hz)
 #define WINDOW_BANDWIDTH_HZ 200.0f
 
+// Fensterbreiten, die in derselben Bandsuche ausgewertet werden (die erste bestimmt die Hauptfrequenz),
+// z. B. { WINDOW_BANDWIDTH_HZ, 100.0f, 400.0f }
+#define BAND_WIDTHS_HZ { WINDOW_BANDWIDTH_HZ }
+#define BAND_SEARCH_TOP_K 3        // stärkste, nicht überlappende Fenster je Breite
+
+// Maß je Bin für die Bandsumme (siehe band_search.h): BAND_METRIC_MAGNITUDE (exakt),
+// BAND_METRIC_MAGNITUDE_FAST, BAND_METRIC_AMBM oder BAND_METRIC_POWER (ohne Wurzel)
+#define BAND_METRIC BAND_METRIC_MAGNITUDE
+
+// Schätzung der Hauptfrequenz zwischen den Bins (siehe peak_interp.h): PEAK_EST_NONE (Mitte des besten
+// Fensters wie bisher), PEAK_EST_QUADRATIC, PEAK_EST_GAUSSIAN, PEAK_EST_JACOBSEN oder
+// PEAK_EST_PHASE_VOCODER (braucht überlappende Frames). Mit Jacobsen erreicht FFT_SIZE 512 bereits < 0,1 Hz.
+#define PEAK_ESTIMATOR PEAK_EST_JACOBSEN
+
+// Grundfrequenz-Detektor: DETECTOR_BAND (stärkstes Fenster), DETECTOR_HPS (Harmonic Product Spectrum,
+// robust gegen Obertöne, die stärker als der Grundton sind) oder DETECTOR_YIN (Zeitbereich, nur normale FFT).
+// Ohne Ergebnis fällt die Auswertung auf DETECTOR_BAND zurück; die Schwelle MIN_TOTAL_AMPLITUDE gilt für alle.
+#define FREQ_DETECTOR DETECTOR_BAND
+#define HPS_HARMONICS 3            // Anzahl der multiplizierten Harmonischen (inkl. Grundton)
+#define HPS_MIN_FUNDAMENTAL 0.1f   // Grundton muss mindestens diesen Anteil des stärksten Bins (Maß BAND_METRIC) haben
+#define YIN_THRESHOLD 0.15f        // Schwelle der normierten Differenzfunktion (kleiner = strenger)
+
+// Glättung der Hauptfrequenz: FREQ_SMOOTH_RATE_LIMIT (Sprung je Frame begrenzt) oder FREQ_SMOOTH_KALMAN
+// (Frequenz und Steigung, siehe freq_kalman.h; die Bandsumme bestimmt das Messrauschen, Ausreißer wie
+// Oktavfehler werden verworfen). Das Filter senkt die Streuung so weit, dass oft eine kleinere FFT reicht.
+// Kalman ist opt-in, bis die Parameter an echten Frames gemessen sind.
+#define FREQ_SMOOTHER FREQ_SMOOTH_RATE_LIMIT
+#define KALMAN_ACCEL_HZ_S2 30000.0f  // erwartete Änderung der Steigung (Vibrato 5 Hz +-30 Hz: bis 30000 Hz/s²)
+#define KALMAN_MEAS_NOISE_HZ 1.0f    // Standardabweichung einer Messung bei KALMAN_REF_LEVEL
+#define KALMAN_REF_LEVEL 10.0f       // Bandsumme als Vielfaches der Pegelschwelle, für das KALMAN_MEAS_NOISE_HZ gilt
+#define KALMAN_GATE 4.0f             // Ausreißergrenze in Standardabweichungen der Innovation
+#define KALMAN_MAX_OUTLIERS 2        // übereinstimmende Ausreißer in Folge bis zum Neustart (neuer Ton)
+
 // Rate Limiter: maximal erlaubter Frequenzsprung pro Messzyklus (z. B. alle 10 ms)
 #define RATE_LIMIT_MAX_JUMP_HZ 200.0f
 
@@ -32,6 +117,20 @@
 // Liegt der Wert unter diesem Schwellwert, wird die Hauptfrequenz als 0 ausgegeben.
 #define MIN_TOTAL_AMPLITUDE 1000.0f
 
+// Energie-Gate und Stationarität (siehe frame_gate.h, nur normale FFT): Frames, deren Energie im
+// Zeitbereich unter der eines Sinus liegt, der MIN_TOTAL_AMPLITUDE gerade erreicht (mal ENERGY_GATE_MARGIN),
+// laufen ohne FFT als leise durch. Leise Frames fehlen im gemittelten Spektrum (für Rauschmessungen
+// abschalten) und gehen als Stille ins Spektrogramm.
+#define ENABLE_ENERGY_GATE 1
+#define ENERGY_GATE_MARGIN 0.7f    // Anteil der Sinus-Amplitude; Rauschen verteilt sich auf alle Bins, daher sicher bis ~0,7
+// Bei übereinstimmenden Ergebnissen nur noch jeden 2., 4., ... bis STATIONARY_MAX_INTERVAL-ten Frame voll
+// auswerten (dazwischen gilt das letzte Ergebnis); Energieänderungen und abweichende Ergebnisse führen
+// sofort zurück auf jeden Frame; gehaltene Frames zählen im Spektrogramm mit dem nächsten ausgewerteten,
+// im gemittelten Spektrum nicht. Verzögerung und eingesparte Rechenzeit siehe /stats ("gate"). 1 = aus.
+#define STATIONARY_MAX_INTERVAL 1
+#define STATIONARY_FREQ_TOL_HZ 2.0f   // Frequenzen gelten bis zu dieser Abweichung als gleich
+#define STATIONARY_LEVEL_TOL 0.25f    // relative Abweichung von Bandsumme und Energie
+
 // ---------------------
 // Wi-Fi Configuration
 // ---------------------
@@ -41,22 +140,53 @@
 // ---------------------
 // Buffer and Task Configuration
 // ---------------------
-#define NUM_BUFFERS 60             // Number of buffers in the ring buffer
-#define ADC_TASK_DELAY_MS 10       // ADC task delay in milliseconds (z. B. 10 ms für schnellere Aktualisierung)
+#define NUM_BUFFERS 60             // Number of buffers in the ring buffer (je Kanal; bei mehreren Kanälen verkleinern)
+#define STFT_HOP_SIZE (FFT_SIZE / 2)   // Samples zwischen zwei FFT-Frames (FFT_SIZE/2 = 50 %, FFT_SIZE/4 = 75 % Überlappung)
+#define ADC_DMA_POOL_SAMPLES (FFT_SIZE * 4) // Größe des DMA-Pools des ADC-Treibers in Samples
+#define FRAME_QUEUE_LEN 16         // Frames zwischen ADC-Reader und DSP-Task (Zweierpotenz)
+#define ADC_READER_CORE 0          // Kern für den ADC-Reader (DMA lesen, Ringpuffer füllen)
+#define DSP_TASK_CORE 1            // Kern für FFT, Bandsuche und store_frequency()
 
 // ---------------------
 // Frequency and JSON Configuration
 // ---------------------
 #define FREQ_STORAGE_SIZE 64       // Size of the frequency storage buffer
-#define NUM_CHUNKS 20              // Number of chunks for trend analysis
-#define JSON_BUFFER_SIZE 1024      // Buffer size for JSON data (1536)
+#define NUM_CHUNKS 256             // Chunks je Kanal im Ring der Trendanalyse (20 Bytes je Chunk, auch Tausende möglich)
+#define FASTDETECT_JSON_CHUNKS 20  // neueste Chunks im Chunk-JSON (höchstens NUM_CHUNKS)
+#define JSON_BUFFER_SIZE (64 + FASTDETECT_JSON_CHUNKS * 96)  // Buffer size for JSON data (bis 96 Bytes je Chunk)
+
+// ---------------------
+// Arena Configuration (statischer Scratch-Speicher je Subsystem, siehe arena.h)
+// ---------------------
+#define HTTP_FILE_CHUNK_SIZE 1024  // Blockgröße beim Ausliefern der HTML-Dateien aus SPIFFS (auch Blöcke von /spectrum)
+#define HTTP_MAX_URI_HANDLERS 12   // registrierte URIs (Standard von esp_http_server: 8)
+#define WS_MAX_PAYLOAD 128         // maximale Länge einer eingehenden WebSocket-Nachricht
+#define WS_BANDS_MAX 16            // höchstens so viele Bänder in der Antwort auf "bands:<ch>"
+#define ARENA_HTTP_BUDGET (HTTP_FILE_CHUNK_SIZE + 512)          // Dateiblock + JSON für /stats
+// Nachricht + Chunk-JSON, Spektrum-Frame (Kopf + 1 Byte je Bin + Lesepuffer) bzw. Bänder- oder Ton-JSON
+// (bis 64 Bytes je Band, höchstens 8 Töne zu 96 Bytes)
+#define ARENA_WS_SPECTRUM_SIZE (SPECTRUM_AVG_BINS + 512)
+#define WS_RESULT_JSON_SIZE (64 + WS_BANDS_MAX * 64)
+#define ARENA_WS_MAX2(a, b) ((a) > (b) ? (a) : (b))
+#define ARENA_WS_BUDGET (WS_MAX_PAYLOAD + 16 + \
+                         ARENA_WS_MAX2(JSON_BUFFER_SIZE, ARENA_WS_MAX2(ARENA_WS_SPECTRUM_SIZE, WS_RESULT_JSON_SIZE)))
+// Arbeitspuffer der aktiven FFT bei FFT_MAX_SIZE: Eingang/Spektrum, Magnituden und YIN-Samples (+ Ausrichtung)
+#define ARENA_FFT_BUDGET ((FFT_MAX_SIZE * (FFT_REAL_INPUT ? 1 : 2) + FFT_MAX_SIZE / 2 + FFT_MAX_SIZE) * 4 + 64)
 
 // ---------------------
 // Fastdetect Configuration
 // ---------------------
-#define FASTDETECT_NUM_MEASUREMENTS 3           // Anzahl der Messungen pro Chunk
+#define FASTDETECT_NUM_MEASUREMENTS 3           // Frames pro Chunk (1..FREQ_STORAGE_SIZE/2); jeder volle Chunk weckt die Task
 #define FASTDETECT_ENABLE_PARABOLIC_INTERP 1      // 1 = Parabolische Interpolation aktivieren, 0 = nur Mittelwert
 
+// Verlauf in Stufen (history.h): Minimum, Maximum und Mittelwert von Frequenz und Magnitude je Intervall,
+// gespeist aus store_frequency(), abrufbar als Binärblock über /history. 20 Bytes je Intervall und Kanal,
+// bevorzugt im PSRAM. Der Standard passt ins interne RAM (esp32dev ohne PSRAM: ≈ 9,4 KB je Kanal);
+// mit PSRAM z. B. { 3600, 1440, 720 } für 1 h, 1 Tag und 30 Tage.
+#define ENABLE_HISTORY 1
+#define HISTORY_PERIODS_S { 1, 60, 3600 }     // Intervalllänge je Stufe in s (Vielfaches der vorigen Stufe)
+#define HISTORY_LENGTHS { 300, 120, 48 }      // Intervalle je Stufe: 5 min, 2 h, 2 Tage
+
 #define OFFSET 320
 
 #endif // CONFIG_H
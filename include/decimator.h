@@ -0,0 +1,46 @@
+#ifndef DECIMATOR_H
+#define DECIMATOR_H
+
+#include <stdint.h>
+#include "esp_err.h"
+#include "dsps_fir.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Dezimierende Eingangsstufe: Anti-Aliasing-Tiefpass (gefensterter Sinc) + Abtastratenreduktion
+ * um factor mit dsps_fird_f32. Die Eingangsblöcke dürfen beliebig lang sein; Samples, die noch
+ * keinen vollständigen Dezimierungsschritt ergeben, werden bis zum nächsten Aufruf aufbewahrt.
+ */
+typedef struct {
+    fir_f32_t fir;          // esp-dsp FIR-Zustand (Koeffizienten, Verzögerungsleitung, Position)
+    int factor;             // Dezimierungsfaktor
+    float *coeffs;          // Filterkoeffizienten (taps Werte)
+    float *delay;           // Verzögerungsleitung (taps Werte)
+    float *in;              // Eingangspuffer (float) inkl. Rest des letzten Blocks
+    float *out;             // Ausgangspuffer (float)
+    uint32_t in_len;        // Samples im Eingangspuffer, die noch nicht verarbeitet wurden
+    uint32_t max_in;        // maximale Blocklänge pro Aufruf
+} decimator_t;
+
+// Legt Filter und Puffer an. taps sollte ein Vielfaches von 4 sein (Anforderung der ESP32-S3-Kernel).
+esp_err_t decimator_init(decimator_t *dec, int factor, int taps, uint32_t max_in);
+
+// Gibt alle Puffer wieder frei.
+void decimator_deinit(decimator_t *dec);
+
+// Entwirft einen Tiefpass (gefensterter Sinc) mit Grenzfrequenz fc, bezogen auf die Eingangsrate
+// (0 < fc < 0.5). Wird auch von der Zoom-FFT (zoom_fft.h) verwendet.
+void decimator_design_lowpass(float *coeffs, int taps, float fc);
+
+// Filtert und dezimiert n (<= max_in) Samples. Liefert die Anzahl der nach out geschriebenen
+// Samples (höchstens (n + factor - 1) / factor).
+uint32_t decimator_process(decimator_t *dec, const int16_t *in, uint32_t n, int16_t *out);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // DECIMATOR_H
@@ -1,15 +1,51 @@
 #ifndef FASTDETECT_H
 #define FASTDETECT_H
 
+#include <stdbool.h>
+#include <stdint.h>
 #include "esp_err.h"
 #include "esp_http_server.h"
+#include "history.h"
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
-// Speichert eine Frequenzmessung im ringförmigen Puffer.
-void store_frequency(float freq);
+typedef enum {
+    FASTDETECT_TREND_SAME = 0,
+    FASTDETECT_TREND_RISE,
+    FASTDETECT_TREND_FALL,
+} fastdetect_trend_t;
+
+// Ein Chunk der Trendanalyse (20 Bytes; NUM_CHUNKS davon je Kanal im Ring).
+typedef struct {
+    float freq;          // verfeinerte Frequenz des Chunks
+    float magnitude;     // mittlere integrierte Magnitude der Frames
+    uint32_t frame;      // Nummer des letzten Frames
+    uint32_t time_ms;    // Zeitpunkt dieses Frames (esp_timer, ms)
+    uint8_t trend;       // fastdetect_trend_t gegenüber dem vorigen Chunk
+} fastdetect_chunk_t;
+
+// Speichert eine Frequenzmessung (mit integrierter Magnitude) eines Kanals (0..ADC_NUM_CHANNELS-1)
+// im ringförmigen Puffer; voiced = false für leise Frames (zählen im Verlauf nicht zur Frequenz).
+void store_frequency(int channel, float freq, float magnitude, bool voiced);
+
+// Kopiert die neuesten (höchstens max) Chunks eines Kanals nach dst, neuester zuerst; liefert die Anzahl.
+int fastdetect_read_chunks(int channel, fastdetect_chunk_t *dst, int max);
+
+// Kenndaten einer Stufe des Verlaufs (ENABLE_HISTORY)
+typedef struct {
+    int tiers;           // Anzahl der Stufen
+    uint32_t period_s;   // Intervalllänge dieser Stufe
+    int length;          // Intervalle im Ring
+    uint32_t head;       // Nummer des laufenden Intervalls (Zeit seit dem Start / period_s)
+} fastdetect_history_info_t;
+
+// Kenndaten einer Stufe; ESP_ERR_INVALID_ARG bei ungültigem Kanal oder Stufe, ESP_ERR_INVALID_STATE ohne Verlauf.
+esp_err_t fastdetect_get_history_info(int channel, int tier, fastdetect_history_info_t *info);
+
+// Kopiert die Intervalle from .. from + count - 1 einer Stufe (siehe history_read).
+void fastdetect_read_history(int channel, int tier, uint32_t from, int count, history_bucket_t *out);
 
 // Initialisiert die Fastdetect-Task.
 void init_fastdetect_task(void);
@@ -21,7 +57,8 @@ esp_err_t fastdetect_handler(httpd_req_t *req);
 esp_err_t ws_handler(httpd_req_t *req);
 
 // Deklaration für build_chunk_json, damit diese Funktion in anderen Modulen (z. B. http.c) bekannt ist.
-void build_chunk_json(char *outbuf, size_t outsize);
+// Baut das Chunk-JSON für einen Kanal.
+void build_chunk_json(int channel, char *outbuf, size_t outsize);
 
 #ifdef __cplusplus
 }
@@ -0,0 +1,116 @@
+#ifndef FFT_PLAN_H
+#define FFT_PLAN_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Größte unterstützte FFT (die esp-dsp-Kernel arbeiten mit den Tabellen des Plans, unabhängig
+// von CONFIG_DSP_MAX_FFT_SIZE; ab 8192 Punkten fehlen die vorberechneten Bitumkehr-Tabellen)
+#define FFT_PLAN_MAX_SIZE 8192
+
+/*
+ * Die Pläne setzen nur die "initialized"-Flags von esp-dsp, die globalen FFT-Tabellen bleiben leer.
+ * In dieser Firmware dürfen deshalb die globalen Einstiege nicht benutzt werden: dsps_fft2r_fc32,
+ * dsps_fft4r_fc32, dsps_cplx2real_fc32 (ohne Tabellenargument) sowie dsps_fft2r_init_fc32,
+ * dsps_fft4r_init_fc32 und die zugehörigen deinit. Jede FFT läuft über einen Plan (fft_plan_execute);
+ * ist eine globale Tabelle schon belegt, scheitert der Aufbau eines Plans mit ESP_ERR_INVALID_STATE.
+ * Der Host-Test check_no_global_fft prüft src/ und include/ darauf.
+ */
+
+// Plätze im Plan-Cache (fft_plan_cache_get)
+#define FFT_PLAN_CACHE_SLOTS 4
+
+// Art der Transformation
+typedef enum {
+    FFT_PLAN_COMPLEX = 0,   // komplexe N-Punkt-FFT, Imaginärteil der Eingangsdaten = 0
+    FFT_PLAN_REAL    = 1,   // N/2-Punkt komplexe FFT über die reellen Samples + dsps_cplx2real_fc32
+    FFT_PLAN_IQ      = 2,   // komplexe N-Punkt-FFT über I/Q-Daten, volles Spektrum (Zoom-FFT)
+} fft_plan_mode_t;
+
+/**
+ * FFT-Plan: Enthält alle Tabellen und Arbeitspuffer, die für eine FFT der Größe fft_size
+ * benötigt werden. Der Plan wird einmalig beim Start aufgebaut, damit pro Frame nur noch
+ * die eigentliche Transformation läuft.
+ *
+ * Eingangsformat in fft_input:
+ *   FFT_PLAN_COMPLEX: fft_input[2*i] = x[i], fft_input[2*i+1] = 0   (2 * fft_size Werte)
+ *   FFT_PLAN_REAL:    fft_input[i]   = x[i]                         (fft_size Werte)
+ *   FFT_PLAN_IQ:      fft_input[2*i] = I[i], fft_input[2*i+1] = Q[i] (2 * fft_size Werte)
+ * Ausgangsformat: Bins 0..fft_size/2-1 als interleaved re/im in fft_input. Beide Modi liefern
+ * dieselbe Skalierung (der Faktor 2 des komplexen Pfads ist im Fenster des Real-Pfads enthalten).
+ * FFT_PLAN_IQ liefert alle fft_size Bins (ab fft_size/2 die negativen Frequenzen) ohne Skalierung.
+ */
+typedef struct {
+    int fft_size;              // Anzahl der Samples pro Frame (Zweierpotenz)
+    fft_plan_mode_t mode;
+    float *twiddle;            // Twiddle-Faktoren für dsps_fft2r (Komplex: fft_size, Real: fft_size/2 Punkte)
+    float *twiddle4r;          // nur Real-Modus: Tabelle für dsps_fft4r/dsps_cplx2real
+    int twiddle4r_size;        // Tabellengröße im Sinne von dsps_fft4r (2 * fft_size/2)
+    bool use_fft4r;            // Real-Modus: fft_size/2 ist eine Viererpotenz → Radix-4
+    uint16_t *bitrev_table;    // Tauschpaare für die Bitumkehr (NULL = direkte Berechnung)
+    int bitrev_size;           // Anzahl der Tauschpaare in bitrev_table
+    float *window;             // Fenstertabelle (Hann), fft_size Werte; NULL bei fft_plan_init_tables
+    float *fft_input;          // Arbeitspuffer, siehe Eingangsformat
+    float *magnitudes;         // Arbeitspuffer für Magnituden (fft_size / 2 Werte, FFT_PLAN_IQ: fft_size)
+    bool owns_buffers;         // false: Fenster, fft_input/magnitudes stellt der Aufrufer (fft_plan_init_tables)
+} fft_plan_t;
+
+/**
+ * Cache für Pläne verschiedener Größen (nur FFT-Tabellen; Fenster und Arbeitspuffer stellt der
+ * Aufrufer für den jeweils aktiven Plan). Pläne werden beim ersten Abruf aufgebaut; ist der Cache
+ * voll, wird der am längsten nicht abgerufene verdrängt.
+ */
+typedef struct {
+    fft_plan_t plans[FFT_PLAN_CACHE_SLOTS];   // fft_size 0 = freier Platz
+    uint32_t last_used[FFT_PLAN_CACHE_SLOTS];
+    uint32_t clock;
+    uint32_t hits;
+    uint32_t misses;
+} fft_plan_cache_t;
+
+// Anzahl der Werte in fft_input bzw. magnitudes für einen Plan dieser Größe
+static inline int fft_plan_input_floats(int fft_size, fft_plan_mode_t mode)
+{
+    return (mode == FFT_PLAN_REAL) ? fft_size : fft_size * 2;
+}
+
+static inline int fft_plan_magnitude_floats(int fft_size, fft_plan_mode_t mode)
+{
+    return (mode == FFT_PLAN_IQ) ? fft_size : fft_size / 2;
+}
+
+// Baut den Plan für fft_size im gewünschten Modus auf (Tabellen berechnen, Puffer allokieren).
+esp_err_t fft_plan_init(fft_plan_t *plan, int fft_size, fft_plan_mode_t mode);
+
+// Wie fft_plan_init, aber ohne Fenster und Arbeitspuffer: fft_input und magnitudes setzt der Aufrufer,
+// das Fenster wendet er beim Laden an (z. B. aus window.h).
+esp_err_t fft_plan_init_tables(fft_plan_t *plan, int fft_size, fft_plan_mode_t mode);
+
+// Gibt alle Tabellen und (falls eigene) Puffer des Plans wieder frei.
+void fft_plan_deinit(fft_plan_t *plan);
+
+// Liefert den Plan für fft_size/mode aus dem Cache und baut ihn bei Bedarf auf. keep wird nicht
+// verdrängt (der gerade benutzte Plan). Die Zeiger bleiben bis zur Verdrängung gültig.
+esp_err_t fft_plan_cache_get(fft_plan_cache_t *cache, int fft_size, fft_plan_mode_t mode,
+                             const fft_plan_t *keep, fft_plan_t **out);
+
+// Anzahl der aufgebauten Pläne im Cache
+int fft_plan_cache_count(const fft_plan_cache_t *cache);
+
+// Gibt alle Pläne des Caches frei.
+void fft_plan_cache_deinit(fft_plan_cache_t *cache);
+
+// Führt die FFT in-place auf plan->fft_input aus. Das Ergebnis (Spektrum der reellen
+// Eingangsdaten) liegt danach ebenfalls in plan->fft_input.
+void fft_plan_execute(const fft_plan_t *plan);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // FFT_PLAN_H
@@ -0,0 +1,70 @@
+#ifndef FRAME_GATE_H
+#define FRAME_GATE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Vorentscheidung je Frame und Kanal, ob die volle Auswertung (Fenster, FFT, Magnituden, Bandsuche,
+ * Detektor) nötig ist:
+ *   FRAME_GATE_SILENT:  die Energie des Blocks (Σ (x - mean)², ein ganzzahliger Durchlauf) liegt unter
+ *                       silence_energy; der Frame kann die Pegelschwelle nicht erreichen.
+ *   FRAME_GATE_HOLD:    die letzten Ergebnisse stimmten überein (Frequenz bis freq_tol, Pegel bis
+ *                       level_tol) und die Energie blieb innerhalb level_tol; das letzte Ergebnis gilt weiter.
+ *                       Der Abstand der vollen Auswertungen verdoppelt sich bei jeder Übereinstimmung
+ *                       bis max_interval und fällt bei einer Änderung sofort auf 1 zurück.
+ *   FRAME_GATE_ANALYZE: volle Auswertung, danach frame_gate_update() mit dem Ergebnis.
+ * Nach gehaltenen Frames wird ein leiser Frame noch voll ausgewertet, damit das Ende eines Tons
+ * mit dem richtigen Ergebnis abschließt.
+ */
+
+typedef enum {
+    FRAME_GATE_ANALYZE = 0,
+    FRAME_GATE_SILENT,
+    FRAME_GATE_HOLD,
+} frame_gate_action_t;
+
+typedef struct {
+    int max_interval;          // größter Abstand der vollen Auswertungen (1 = kein Halten)
+    float freq_tol;            // Frequenzen gelten bis zu dieser Abweichung (Hz) als gleich
+    float level_tol;           // relative Abweichung von Pegel und Energie (z. B. 0,25)
+    int interval;              // aktueller Abstand in Frames
+    int held;                  // gehaltene Frames seit der letzten vollen Auswertung
+    bool valid;                // ref_* belegt
+    float ref_energy;          // Energie, Frequenz und Pegel der letzten vollen Auswertung
+    bool ref_quiet;
+    float ref_frequency;
+    float ref_level;
+    // Zähler
+    uint32_t frames;
+    uint32_t silent;
+    uint32_t holds;
+    uint32_t analyzed;
+    uint32_t changes;          // Änderungen, die nach gehaltenen Frames erkannt wurden
+    uint32_t latency_sum;      // gehaltene Frames vor diesen Änderungen (obere Grenze der Verzögerung)
+    uint32_t latency_max;
+} frame_gate_t;
+
+// Energie des Blocks ohne Gleichanteil: Σ (x[i] - mean)²
+float frame_gate_energy_s16(const int16_t *x, int len);
+
+void frame_gate_init(frame_gate_t *gate, int max_interval, float freq_tol, float level_tol);
+
+// Entscheidung für einen Frame mit der Energie energy (silence_energy <= 0: kein Energie-Gate).
+frame_gate_action_t frame_gate_check(frame_gate_t *gate, float energy, float silence_energy);
+
+// Ergebnis einer vollen Auswertung (quiet: unter der Pegelschwelle); passt den Abstand an.
+void frame_gate_update(frame_gate_t *gate, float energy, bool quiet, float frequency, float level);
+
+// Beginnt ohne Referenz (z. B. nach einem Wechsel der FFT-Größe); die Zähler bleiben.
+void frame_gate_reset(frame_gate_t *gate);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // FRAME_GATE_H
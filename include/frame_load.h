@@ -0,0 +1,39 @@
+#ifndef FRAME_LOAD_H
+#define FRAME_LOAD_H
+
+#include <stdint.h>
+#include "sdkconfig.h"
+#include "dsps_mul_platform.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * FFT-Eingangsstufe in einem Kernel: Mittelwert (DC) der int16-Samples entfernen, Fenster anwenden
+ * und das Ergebnis mit Schrittweite stride ablegen (1 = Real-FFT, 2 = Realteil der komplexen FFT).
+ * Statt drei Durchläufen über float-Zwischenpuffer (Mittelwert, Abziehen, Fenster) gibt es nur
+ * noch eine ganzzahlige Summe und einen Durchlauf, der direkt in den FFT-Puffer schreibt.
+ *
+ * out[i * stride] = (x[i] - mean(x)) * window[i],  i = 0..len-1
+ */
+void frame_load_s16_ansi(const int16_t *x, const float *window, float *out, int len, int stride);
+void frame_load_s16_ae32(const int16_t *x, const float *window, float *out, int len, int stride);
+
+// Auswahl der Implementierung analog zu esp-dsp (dsps_mul_platform.h)
+#if CONFIG_DSP_OPTIMIZED && (dsps_mul_f32_ae32_enabled == 1)
+#define frame_load_s16_ae32_enabled 1
+#define frame_load_s16 frame_load_s16_ae32
+#else
+#define frame_load_s16 frame_load_s16_ansi
+#endif
+
+// Misst die Eingangsstufe isoliert (bisherige drei Durchläufe, ANSI, optimiert) über
+// iterations Frames der Länge len und gibt die mittleren Zyklen pro Frame im Log aus.
+void frame_load_benchmark(int len, int iterations);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // FRAME_LOAD_H
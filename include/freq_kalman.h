@@ -0,0 +1,66 @@
+#ifndef FREQ_KALMAN_H
+#define FREQ_KALMAN_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Kalman-Filter für die Hauptfrequenz eines Kanals auf Basis der ekf-Klasse von esp-dsp
+ * (components/esp-dsp/modules/kalman, dspm::Mat). Zustand x = [Frequenz (Hz), Steigung (Hz/s)]:
+ *   x' = F x + G w,  F = [0 1; 0 0],  G = [0; 1],  w: Änderung der Steigung mit Varianz accel² (Hz²/s⁴)
+ *   z  = H x + v,    H = [1 0],       v: Messrauschen mit der Standardabweichung
+ *                                        meas_noise_hz * ref_magnitude / magnitude
+ * Eine Messung mit großer integrierter Magnitude (hohe Konfidenz) zieht die Schätzung also stärker
+ * an als eine schwache. Innovationen über gate Standardabweichungen gelten als Ausreißer (z. B.
+ * Oktavfehler) und werden verworfen; nach max_outliers übereinstimmenden Ausreißern in Folge beginnt
+ * das Filter beim Messwert neu (neuer Ton).
+ */
+
+typedef struct {
+    void *ekf;              // Filter (freq_ekf, freq_kalman.cpp)
+    float accel;            // Standardabweichung der Steigungsänderung in Hz/s² (Prozessrauschen)
+    float meas_noise_hz;    // Standardabweichung einer Messung bei ref_magnitude
+    float ref_magnitude;
+    float gate;             // Ausreißergrenze in Standardabweichungen der Innovation
+    int max_outliers;       // so viele Ausreißer in Folge: Neustart beim Messwert
+    int outliers;           // aktuelle, untereinander übereinstimmende Ausreißer in Folge
+    float outlier_hz;       // letzter Ausreißer und seine Messvarianz
+    float outlier_var;
+    bool valid;             // false: die nächste Messung startet das Filter
+    float frequency;        // Schätzung nach dem letzten Aufruf (Hz)
+    float slope;            // geschätzte Steigung (Hz/s)
+    float stddev;           // Standardabweichung der Frequenzschätzung (Hz)
+    // Zähler
+    uint32_t updates;
+    uint32_t rejected;
+    uint32_t restarts;
+} freq_kalman_t;
+
+esp_err_t freq_kalman_init(freq_kalman_t *kf, float accel, float meas_noise_hz, float ref_magnitude,
+                           float gate, int max_outliers);
+
+// Gibt das Filter wieder frei.
+void freq_kalman_deinit(freq_kalman_t *kf);
+
+// Verwirft den Zustand (z. B. bei Stille); die nächste Messung startet das Filter neu.
+void freq_kalman_reset(freq_kalman_t *kf);
+
+// Schreibt den Zustand um dt Sekunden fort und verarbeitet die Messung measured_hz mit der
+// integrierten Magnitude magnitude. Liefert die neue Frequenzschätzung.
+float freq_kalman_update(freq_kalman_t *kf, float measured_hz, float magnitude, float dt);
+
+// Vergleicht Rohwerte, das Rate Limiting (max_jump_hz je Frame) und das Filter (accel, meas_noise_hz)
+// auf synthetischen Messreihen (linearer Sweep, Vibrato, Tonwechsel; 3 % Oktavfehler) mit frame_rate
+// Messungen pro Sekunde: RMS-Fehler je Verfahren und Zyklen je Aktualisierung (Log).
+void freq_kalman_benchmark(float frame_rate, float accel, float meas_noise_hz, float max_jump_hz);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // FREQ_KALMAN_H
@@ -0,0 +1,87 @@
+#ifndef HISTORY_H
+#define HISTORY_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Verlauf in Stufen (z. B. Sekunden, Minuten, Stunden): Jede Stufe hält je Intervall Minimum, Maximum
+ * und Mittelwert von Frequenz und Magnitude sowie die Anzahl der Frames in einem Ring fester Größe.
+ * Frames laufen nur in die feinste Stufe; ist deren Intervall abgeschlossen, wird das Aggregat in die
+ * nächste Stufe übernommen (amortisiert O(1) je Frame, log10f nur beim Abschluss eines Intervalls).
+ *
+ * Intervall n einer Stufe mit der Länge period_s umfasst die Zeit [n * period_s, (n + 1) * period_s)
+ * seit dem Start (esp_timer) und liegt an Position n % length. Intervalle ohne Frames (z. B. vor dem
+ * Start) fehlen im Ring und werden beim Lesen als HISTORY_SEQ_INVALID geliefert.
+ *
+ * Geschrieben wird aus einem Task, gelesen aus beliebigen anderen (wie beim Spektrogramm): Der
+ * Schreiber markiert einen Eintrag vor dem Überschreiben als ungültig, der Leser verwirft Einträge,
+ * deren Nummer sich während des Kopierens geändert hat.
+ */
+
+#define HISTORY_MAX_TIERS 4
+#define HISTORY_SEQ_INVALID 0xFFFFFFFFu
+#define HISTORY_FREQ_STEP 0.125f     // Hz je Stufe von freq_* (int16: +-4096 Hz)
+#define HISTORY_MAG_STEP_DB 0.5f     // dB je Stufe von mag_* (20 log10 der Magnitude, 0 = 0 dB oder kleiner)
+
+// Aggregat eines Intervalls (20 Bytes, Little Endian auch im /history-Block)
+typedef struct {
+    uint32_t seq;         // Nummer des Intervalls, HISTORY_SEQ_INVALID = fehlt bzw. wird geschrieben
+    uint32_t count;       // Frames mit Ton (Frequenzwerte nur bei count > 0 gültig)
+    int16_t freq_min;     // Frequenz in HISTORY_FREQ_STEP
+    int16_t freq_max;
+    int16_t freq_mean;
+    uint8_t mag_min;      // Magnitude aller Frames in HISTORY_MAG_STEP_DB
+    uint8_t mag_max;
+    uint8_t mag_mean;     // dB des linearen Mittelwerts
+    uint8_t voiced;       // Anteil der Frames mit Ton (255 = alle)
+} history_bucket_t;
+
+// Laufende Summen eines Intervalls
+typedef struct {
+    uint32_t frames;
+    uint32_t count;
+    float freq_min, freq_max, freq_sum;
+    float mag_min, mag_max, mag_sum;
+} history_acc_t;
+
+typedef struct {
+    uint32_t period_s;          // Intervalllänge in Sekunden (Vielfaches der vorigen Stufe)
+    int length;                 // Intervalle im Ring
+    history_bucket_t *buckets;  // length Einträge (PSRAM, falls vorhanden)
+    uint32_t head;              // Nummer des laufenden Intervalls; fertig sind höchstens head - length + 1 .. head - 1
+    bool started;
+    history_acc_t acc;          // laufendes Intervall
+} history_tier_t;
+
+typedef struct {
+    int num_tiers;
+    history_tier_t tiers[HISTORY_MAX_TIERS];
+} history_t;
+
+// Legt num_tiers Stufen mit den Intervalllängen periods_s und lengths Einträgen an (bevorzugt im PSRAM).
+esp_err_t history_init(history_t *h, const uint32_t *periods_s, const int *lengths, int num_tiers);
+
+// Gibt die Ringe frei.
+void history_deinit(history_t *h);
+
+// Nimmt einen Frame zum Zeitpunkt time_us auf; voiced = false: kein Ton (nur Magnitude und Frame-Anzahl).
+void history_add(history_t *h, int64_t time_us, float freq_hz, float magnitude, bool voiced);
+
+// Nummer des laufenden Intervalls einer Stufe (fertig sind die Intervalle davor).
+uint32_t history_head(const history_t *h, int tier);
+
+// Kopiert die Intervalle from .. from + count - 1 einer Stufe nach out. Fehlende, noch laufende oder
+// während des Kopierens überschriebene Intervalle erhalten seq = HISTORY_SEQ_INVALID.
+void history_read(const history_t *h, int tier, uint32_t from, int count, history_bucket_t *out);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // HISTORY_H
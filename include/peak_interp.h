@@ -0,0 +1,80 @@
+#ifndef PEAK_INTERP_H
+#define PEAK_INTERP_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Schätzung der Frequenz einer Spektralspitze zwischen den Bins. Ausgangspunkt ist der stärkste Bin k
+ * eines gefensterten Spektrums (interleaved re/im, Hann oder ein Fenster aus window.h), das Ergebnis die Verschiebung delta in Bins:
+ * f = (k + delta) * Binbreite. Damit erreicht eine kleine FFT (kurze Latenz, wenig Rechenzeit) die
+ * Genauigkeit einer deutlich größeren.
+ *
+ *   PEAK_EST_QUADRATIC:     Parabel durch die Beträge der Bins k-1, k, k+1
+ *   PEAK_EST_GAUSSIAN:      Parabel durch die logarithmierten Beträge (Gauß-förmige Spitze)
+ *   PEAK_EST_JACOBSEN:      komplexer Dreipunkt-Schätzer nach Jacobsen mit Korrektur für das Fenster
+ *   PEAK_EST_PHASE_VOCODER: Phasenfortschritt von Bin k zwischen zwei aufeinanderfolgenden Frames
+ *                           (ohne passenden Vorgänger Rückfall auf Jacobsen)
+ */
+
+typedef enum {
+    PEAK_EST_NONE = 0,          // keine Interpolation (Bin- bzw. Fenstermitte)
+    PEAK_EST_QUADRATIC = 1,
+    PEAK_EST_GAUSSIAN = 2,
+    PEAK_EST_JACOBSEN = 3,
+    PEAK_EST_PHASE_VOCODER = 4,
+} peak_estimator_t;
+
+#define PEAK_EST_COUNT 5
+
+// Bins um die Spitze, die für den Phase-Vocoder vom letzten Frame gemerkt werden (k-1..k+1)
+#define PEAK_TRACK_BINS 3
+
+// Zustand des Phase-Vocoders je Kanal
+typedef struct {
+    bool valid;
+    int bin;                    // Peak-Bin des letzten Frames
+    uint32_t pos;               // Position des ersten Samples des letzten Frames
+    float re[PEAK_TRACK_BINS];  // Bins bin-1..bin+1 des letzten Frames
+    float im[PEAK_TRACK_BINS];
+} peak_track_t;
+
+// Name des Schätzers (Log, JSON)
+const char *peak_estimator_name(peak_estimator_t est);
+
+// Korrekturfaktor des Jacobsen-Schätzers für das Hann-Fenster (andere Fenster: window.h, jacobsen_q)
+#define PEAK_JACOBSEN_Q_HANN 2.0f
+
+// Dreipunkt-Schätzer (QUADRATIC, GAUSSIAN, JACOBSEN): Verschiebung der Spitze gegenüber Bin k in Bins
+// (-1..1). Die Bins k-1..k+1 müssen im Spektrum liegen; jacobsen_q passt JACOBSEN an das Fenster an.
+float peak_interp_offset(peak_estimator_t est, const float *spectrum, int k, float jacobsen_q);
+
+/**
+ * Phase-Vocoder: Verschiebung der Spitze aus der Phasendifferenz von Bin k zum letzten Frame.
+ * fft_bin ist der vorzeichenbehaftete Frequenzindex von Bin k in der FFT (normale FFT: k, Zoom-FFT:
+ * k - fft_size / 2), pos die Position des ersten Frame-Samples in Samples der FFT-Eingangsrate.
+ * Eindeutig bis +-fft_size / (2 * Abstand) Bins, daher nur für Abstände bis 3/4 fft_size. Merkt sich
+ * die Bins k-1..k+1 für den nächsten Frame und liefert false, wenn kein passender Vorgänger existiert.
+ */
+bool peak_interp_vocoder(peak_track_t *track, const float *spectrum, int k, int fft_bin, int fft_size,
+                         uint32_t pos, float *offset);
+
+// Vergisst den Vorgänger (z. B. nach einem Wechsel des Spektrums oder bei Stille).
+static inline void peak_track_reset(peak_track_t *track)
+{
+    track->valid = false;
+}
+
+// Genauigkeit (mittlerer/maximaler Fehler in Hz) und Zyklen je Schätzung aller Schätzer auf Testtönen
+// (dsps_tone_gen_f32) zwischen low_hz und high_hz für FFT-Größen von min_size bis max_size (Log).
+void peak_interp_benchmark(float sample_rate, float low_hz, float high_hz, int min_size, int max_size);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // PEAK_INTERP_H
@@ -0,0 +1,50 @@
+#ifndef SAMPLE_RING_H
+#define SAMPLE_RING_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Ringpuffer für ADC-Samples mit Spiegelbereich:
+ * Der Speicher umfasst capacity + frame_len Werte. Die ersten frame_len Samples werden beim
+ * Schreiben zusätzlich hinter das Ende kopiert, so dass jeder Frame der Länge frame_len
+ * ab einer beliebigen Startposition zusammenhängend gelesen werden kann (ohne Umkopieren).
+ */
+typedef struct {
+    int16_t *data;         // Speicher (capacity + frame_len Werte)
+    uint32_t capacity;     // Anzahl der Samples im Ring
+    uint32_t frame_len;    // Länge eines Analyse-Frames
+    uint32_t write_idx;    // nächste Schreibposition (0..capacity-1)
+} sample_ring_t;
+
+// Initialisiert den Ring auf dem übergebenen Speicher (mind. capacity + frame_len Werte).
+void sample_ring_init(sample_ring_t *ring, int16_t *storage, uint32_t capacity, uint32_t frame_len);
+
+// Hängt n Samples an (n darf größer als capacity sein, dann bleiben die letzten capacity Samples).
+void sample_ring_write(sample_ring_t *ring, const int16_t *src, uint32_t n);
+
+// Schreibzeiger für direktes Befüllen (z. B. durch den Dekoder) mit bis zu frame_len Samples
+// am Stück. Ein Überhang über das Ringende landet im Spiegelbereich und wird von
+// sample_ring_commit() an den Anfang übernommen.
+static inline int16_t *sample_ring_write_ptr(const sample_ring_t *ring)
+{
+    return ring->data + ring->write_idx;
+}
+
+// Übernimmt n (<= frame_len) über sample_ring_write_ptr() geschriebene Samples.
+void sample_ring_commit(sample_ring_t *ring, uint32_t n);
+
+// Zeiger auf frame_len zusammenhängende Samples ab Startposition start.
+static inline const int16_t *sample_ring_frame(const sample_ring_t *ring, uint32_t start)
+{
+    return ring->data + start;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SAMPLE_RING_H
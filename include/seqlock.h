@@ -0,0 +1,48 @@
+#ifndef SEQLOCK_H
+#define SEQLOCK_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdatomic.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Seqlock für genau einen Schreiber und beliebig viele Leser. Der Schreiber wartet nie: Er erhöht
+ * seq vor und nach dem Ändern der Daten (ungerade = Schreiben läuft). Ein Leser kopiert die Daten
+ * und prüft danach, ob seq gerade und unverändert ist; sonst wiederholt er das Kopieren. Kommt wie
+ * spsc_ring ohne FreeRTOS aus (auch auf dem Host mit pthreads nutzbar).
+ *
+ * Ein Leser auf demselben Kern wie ein unterbrochener Schreiber kann nie eine gültige Kopie
+ * bekommen; seqlock_read() gibt daher nach max_tries Versuchen auf, der Aufrufer überlässt dann
+ * dem Schreiber die CPU (z. B. vTaskDelay) und versucht es erneut.
+ */
+typedef struct {
+    atomic_uint_least32_t seq;
+} seqlock_t;
+
+void seqlock_init(seqlock_t *lock);
+
+// Schreiber: umschließt jede Änderung der geschützten Daten.
+void seqlock_write_begin(seqlock_t *lock);
+void seqlock_write_end(seqlock_t *lock);
+
+// Leser: Stand vor dem Lesen; nach dem Lesen true, wenn die gelesenen Daten verworfen werden müssen.
+uint32_t seqlock_read_begin(seqlock_t *lock);
+bool seqlock_read_retry(seqlock_t *lock, uint32_t start);
+
+// Leser: kopiert size Bytes ab src als konsistente Momentaufnahme nach dst (höchstens max_tries
+// Versuche). false, wenn jeder Versuch mit dem Schreiber kollidierte.
+bool seqlock_read(seqlock_t *lock, void *dst, const void *src, size_t size, int max_tries);
+
+// Anzahl der abgeschlossenen Schreibvorgänge (Momentaufnahme).
+uint32_t seqlock_generation(seqlock_t *lock);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SEQLOCK_H
@@ -0,0 +1,90 @@
+#ifndef SPECTROGRAM_H
+#define SPECTROGRAM_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Spektrogramm-Ring: die letzten rows Zeilen eines Leistungsspektrums (Mittelwert über je divider
+ * Frames) mit einem Byte je Bin. Jede Zeile bietet Platz für max_bins Bins; belegt sind die ersten bins
+ * (z. B. abhängig von der FFT-Größe, siehe spectrogram_reset), der Rest der Zeile ist 0. Jede Zeile trägt ihre eigene Skala: Wert 255 entspricht top_db
+ * (stärkster Bin der Zeile), jede Stufe darunter SPECTROGRAM_DB_STEP dB (255 Stufen = 127,5 dB).
+ * Der Logarithmus läuft über eine Tabelle für die Mantisse, nicht über log10f je Bin.
+ *
+ * Zeilenformat (row_size Bytes, 4-Byte-ausgerichtet):
+ *   uint32_t seq     fortlaufende Nummer der Zeile (SPECTROGRAM_SEQ_INVALID während des Schreibens)
+ *   float    top_db  dB des stärksten Bins (nach scale)
+ *   uint8_t  db[max_bins]   (ab bins: 0)
+ *
+ * Geschrieben wird aus einem Task, gelesen aus beliebigen anderen: Der Schreiber markiert eine Zeile
+ * vor dem Überschreiben als ungültig, der Leser verwirft Zeilen, deren Nummer sich während des
+ * Kopierens geändert hat.
+ */
+
+#define SPECTROGRAM_DB_STEP 0.5f
+#define SPECTROGRAM_SEQ_INVALID 0xFFFFFFFFu
+#define SPECTROGRAM_ROW_HEADER 8
+
+typedef struct {
+    int bins;                   // belegte Bins je Zeile (höchstens max_bins)
+    int max_bins;               // Platz je Zeile
+    int rows;
+    int row_size;               // Bytes je Zeile inkl. Kopf
+    int divider;                // Frames je Zeile
+    float scale;                // Faktor auf die Leistung vor der dB-Umrechnung
+    uint8_t *data;              // rows * row_size Bytes (PSRAM, falls vorhanden)
+    float *acc;                 // Summe der Frames der laufenden Zeile
+    int acc_count;
+    uint32_t head;              // Nummer der nächsten Zeile (= Anzahl geschriebener Zeilen)
+    uint32_t first_valid;       // erste Zeile nach dem letzten Zurücksetzen
+} spectrogram_t;
+
+// Legt den Ring für max_bins Bins je Zeile an (bevorzugt im PSRAM), zunächst sind alle belegt. scale wird
+// vor der dB-Umrechnung auf die Leistung angewendet.
+esp_err_t spectrogram_init(spectrogram_t *sg, int max_bins, int rows, int divider, float scale);
+
+// Gibt den Ring frei.
+void spectrogram_deinit(spectrogram_t *sg);
+
+// Beginnt eine neue Zeilenfolge mit bins belegten Bins (1..max_bins) und neuer Skala (z. B. nach einem
+// Wechsel der FFT-Größe): die laufende Zeile wird verworfen, ältere Zeilen sind danach nicht mehr lesbar.
+// Nur aus dem schreibenden Task.
+void spectrogram_reset(spectrogram_t *sg, int bins, float scale);
+
+// Belegte Bins je Zeile (auch aus anderen Tasks).
+int spectrogram_bins(const spectrogram_t *sg);
+
+// Nimmt die Leistungen power[0..bins-1] eines Frames auf (bins = belegte Bins); liefert true, wenn eine Zeile fertig wurde.
+bool spectrogram_push(spectrogram_t *sg, const float *power);
+
+// Wie spectrogram_push, aber power steht für frames aufeinanderfolgende Frames (z. B. gehaltene
+// Ergebnisse); power NULL = Stille. Die Zeilen bleiben bei genau divider Frames.
+bool spectrogram_push_frames(spectrogram_t *sg, const float *power, int frames);
+
+// Nummer der nächsten Zeile; gültig sind höchstens die Zeilen head - rows .. head - 1.
+uint32_t spectrogram_head(const spectrogram_t *sg);
+
+// Nummer der ältesten lesbaren Zeile (höchstens head).
+uint32_t spectrogram_oldest(const spectrogram_t *sg);
+
+// Kopiert bis zu count vollständige Zeilen ab Nummer from nach out (count * row_size Bytes). Zu alte
+// Nummern werden auf die älteste gültige Zeile angehoben (*first = tatsächliche erste Nummer).
+// Liefert die Anzahl der kopierten Zeilen.
+int spectrogram_read(const spectrogram_t *sg, uint32_t from, int count, uint8_t *out, uint32_t *first);
+
+// Quantisiert n Leistungen (nach scale) zu Bytes mit der Skala einer Zeile (*top_db = dB des Maximums).
+void spectrogram_quantize(const float *power, int n, float scale, uint8_t *out, float *top_db);
+
+// Vergleicht spectrogram_quantize mit log10f je Bin (Zyklen und größter Fehler in dB, Log).
+void spectrogram_benchmark(int bins);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SPECTROGRAM_H
@@ -0,0 +1,84 @@
+#ifndef SPECTRUM_AVG_H
+#define SPECTRUM_AVG_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Dauerhafter Spektrum-Akkumulator über die Leistungsspektren (re² + im²) aufeinanderfolgender Frames.
+ * Alle Verfahren laufen gleichzeitig und in-place über dieselben Eingangsdaten:
+ *   SPECTRUM_AVG_LINEAR: Mittelwert über Blöcke von linear_frames Frames (Welch); das Ergebnis ist der
+ *                        letzte vollständige Block (vor dem ersten der laufende Mittelwert),
+ *   SPECTRUM_AVG_EXP:    exponentielle Mittelung mit Anteil alpha des neuen Frames,
+ *   SPECTRUM_AVG_PEAK:   Maximum je Bin seit dem letzten Zurücksetzen,
+ *   SPECTRUM_AVG_MIN:    Minimum je Bin seit dem letzten Zurücksetzen.
+ *
+ * Die Aktualisierung kann in Teilbereichen erfolgen (spectrum_avg_update für jeden Bereich, danach
+ * einmal spectrum_avg_commit), damit ein Leser zwischen den Bereichen zugreifen kann.
+ */
+
+typedef enum {
+    SPECTRUM_AVG_LINEAR = 0,
+    SPECTRUM_AVG_EXP,
+    SPECTRUM_AVG_PEAK,
+    SPECTRUM_AVG_MIN,
+    SPECTRUM_AVG_COUNT
+} spectrum_avg_mode_t;
+
+// Kompakte Darstellung für die Übertragung: 0,5 dB je Stufe ab SPECTRUM_DB_MIN (0..255 → -40..87,5 dB)
+#define SPECTRUM_DB_MIN (-40.0f)
+#define SPECTRUM_DB_STEP 0.5f
+
+typedef struct {
+    int bins;
+    int linear_frames;          // Blocklänge der linearen Mittelung
+    float alpha;                // Anteil des neuen Frames bei der exponentiellen Mittelung
+    float *sum;                 // laufende Summe des aktuellen Blocks
+    float *out[SPECTRUM_AVG_COUNT];
+    int count;                  // Frames im aktuellen Block
+    uint32_t frames;            // Frames seit dem letzten Zurücksetzen
+    uint32_t blocks;            // vollständige Blöcke der linearen Mittelung
+} spectrum_avg_t;
+
+// Legt die Arrays für bins Bins an.
+esp_err_t spectrum_avg_init(spectrum_avg_t *avg, int bins, int linear_frames, float alpha);
+
+// Gibt die Arrays wieder frei.
+void spectrum_avg_deinit(spectrum_avg_t *avg);
+
+// Verwirft alle Mittelwerte und Extremwerte.
+void spectrum_avg_reset(spectrum_avg_t *avg);
+
+// Nimmt die Leistungen power[0..n-1] der Bins first..first+n-1 des aktuellen Frames auf.
+void spectrum_avg_update(spectrum_avg_t *avg, const float *power, int first, int n);
+
+// Schließt den aktuellen Frame ab (nach den Aufrufen von spectrum_avg_update für alle Bins).
+void spectrum_avg_commit(spectrum_avg_t *avg);
+
+// Kopiert die Ergebnisse eines Verfahrens für die Bins first..first+n-1 nach out (Leistung).
+void spectrum_avg_read(const spectrum_avg_t *avg, spectrum_avg_mode_t mode, int first, int n, float *out);
+
+// Name des Verfahrens ("avg", "exp", "peak", "min") bzw. Verfahren zum Namen (-1 = unbekannt)
+const char *spectrum_avg_mode_name(spectrum_avg_mode_t mode);
+int spectrum_avg_mode_from_name(const char *name);
+
+// Leistung in dB (bereits auf die gewünschte Referenz skaliert) als Stufe 0..255
+static inline uint8_t spectrum_db_u8(float db)
+{
+    float step = (db - SPECTRUM_DB_MIN) / SPECTRUM_DB_STEP;
+    if (!(step > 0.0f)) {
+        return 0;
+    }
+    return (step >= 255.0f) ? 255 : (uint8_t)(step + 0.5f);
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SPECTRUM_AVG_H
@@ -0,0 +1,43 @@
+#ifndef SPSC_RING_H
+#define SPSC_RING_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Lock-freier Ringpuffer für genau einen Produzenten und einen Konsumenten (SPSC).
+ * Transportiert nur Indizes (uint32_t), z. B. Startpositionen von Frames im sample_ring,
+ * und kommt ohne FreeRTOS aus (auch auf dem Host mit pthreads nutzbar).
+ *
+ * head wird nur vom Produzenten, tail nur vom Konsumenten geschrieben. Die Kapazität muss
+ * eine Zweierpotenz sein; head/tail laufen frei über und werden per Maske abgebildet.
+ */
+typedef struct {
+    uint32_t *slots;
+    uint32_t mask;              // capacity - 1
+    atomic_uint_least32_t head; // nächster Schreibindex (Produzent)
+    atomic_uint_least32_t tail; // nächster Leseindex (Konsument)
+} spsc_ring_t;
+
+// Initialisiert den Ring auf storage (capacity Einträge, Zweierpotenz). false bei ungültiger Größe.
+bool spsc_ring_init(spsc_ring_t *ring, uint32_t *storage, uint32_t capacity);
+
+// Produzent: legt value ab. false, wenn der Ring voll ist.
+bool spsc_ring_push(spsc_ring_t *ring, uint32_t value);
+
+// Konsument: entnimmt den ältesten Eintrag. false, wenn der Ring leer ist.
+bool spsc_ring_pop(spsc_ring_t *ring, uint32_t *value);
+
+// Anzahl der belegten Einträge (Momentaufnahme).
+uint32_t spsc_ring_count(spsc_ring_t *ring);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SPSC_RING_H
@@ -0,0 +1,91 @@
+#ifndef TONE_TRACKER_H
+#define TONE_TRACKER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Tracker-Bank für bekannte Zielfrequenzen: Statt einer vollen FFT wird nur der DFT-Wert bei jeder
+ * Zielfrequenz berechnet (O(1) je Sample und Ziel), wahlweise
+ *   TONE_TRACKER_GOERTZEL: Goertzel über nicht überlappende, Hann-gewichtete Blöcke von len Samples
+ *                          (neues Ergebnis alle len Samples),
+ *   TONE_TRACKER_SLIDING:  gleitende DFT über die letzten len Samples
+ *                          (neues Ergebnis nach jedem Sample, gelesen am Ende jedes Blocks).
+ *
+ * Beide liefern Y = sum_m w[m] * x[n-m] * e^(j w m) (Gleichanteil entfernt; Goertzel mit Hann-Fenster,
+ * die gleitende DFT mit Rechteckfenster und daher stärkerem Übersprechen benachbarter Töne): Die Phase ist
+ * die Phase des Tons beim jüngsten Sample. Aus dem Phasenfortschritt zwischen zwei Ergebnissen
+ * folgt die tatsächliche Frequenz (eindeutig innerhalb von +-sample_rate / (2 * Abstand)).
+ */
+
+#define TONE_TRACKER_MAX_TONES 8
+
+typedef enum {
+    TONE_TRACKER_GOERTZEL = 0,
+    TONE_TRACKER_SLIDING  = 1,
+} tone_tracker_mode_t;
+
+typedef struct {
+    float freq_hz;          // Zielfrequenz
+    float amplitude;        // Amplitude des Tons (ADC-Einheiten)
+    float phase;            // Phase beim jüngsten Sample in rad (-pi..pi)
+    float measured_hz;      // aus dem Phasenfortschritt geschätzte Frequenz (0 = noch unbekannt)
+    uint32_t updates;       // Anzahl der Ergebnisse seit dem Start
+} tone_result_t;
+
+typedef struct {
+    float omega;            // 2 pi f / fs
+    float coeff;            // Goertzel: 2 cos w
+    float rot_re, rot_im;   // Sliding: r * e^(j w)
+    float tail_re, tail_im; // Sliding: r^len * e^(j w len)
+    float s1, s2;           // Goertzel-Zustand
+    float y_re, y_im;       // Sliding-Zustand
+    uint64_t last_sample;   // Samplezähler beim letzten Ergebnis
+    tone_result_t result;
+} tone_bin_t;
+
+typedef struct {
+    tone_tracker_mode_t mode;
+    float sample_rate;
+    int len;                // Block- bzw. Fensterlänge in Samples
+    int num_tones;
+    float norm;             // Amplitude = norm * |Y|
+    tone_bin_t tones[TONE_TRACKER_MAX_TONES];
+    float *x;               // Eingangsblock ohne Gleichanteil
+    float *window;          // Goertzel: Hann-Fenster (len Werte)
+    uint32_t max_in;
+    float *history;         // Sliding: die letzten len Samples (Ring)
+    uint32_t pos;           // Goertzel: Samples im laufenden Block, Sliding: Ringposition
+    uint64_t samples;       // insgesamt verarbeitete Samples
+    float dc;               // gleitender Mittelwert der Eingangssamples
+    bool dc_valid;
+} tone_tracker_t;
+
+// Legt die Bank für num_tones Zielfrequenzen an. max_in = maximale Blocklänge je Aufruf von
+// tone_tracker_process (längere Blöcke werden aufgeteilt).
+esp_err_t tone_tracker_init(tone_tracker_t *tracker, tone_tracker_mode_t mode, float sample_rate, int len,
+                            const float *freqs_hz, int num_tones, uint32_t max_in);
+
+// Gibt die Puffer wieder frei.
+void tone_tracker_deinit(tone_tracker_t *tracker);
+
+// Verarbeitet n neue Samples und aktualisiert die Ergebnisse.
+void tone_tracker_process(tone_tracker_t *tracker, const int16_t *in, uint32_t n);
+
+// Kopiert die aktuellen Ergebnisse (höchstens max) nach out, liefert die Anzahl.
+int tone_tracker_get(const tone_tracker_t *tracker, tone_result_t *out, int max);
+
+// Vergleicht Goertzel, Sliding DFT und eine volle FFT mit fft_size Punkten (50 % Überlappung) auf
+// einem Testsignal: Zyklen pro Sekunde Signal, Ergebnisse pro Sekunde und Amplituden-/Frequenzfehler (Log).
+void tone_tracker_benchmark(float sample_rate, int len, const float *freqs_hz, int num_tones, int fft_size);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // TONE_TRACKER_H
@@ -0,0 +1,94 @@
+#ifndef WINDOW_H
+#define WINDOW_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Fensterfunktionen für die FFT (Tabellen aus esp-dsp, modules/windows). Jede Tabelle wird je Größe
+ * einmal berechnet und mit ihren Kenngrößen zwischengespeichert:
+ *   coherent_gain: Mittelwert des Fensters (Amplitude eines Tons in Bin-Mitte relativ zum Rechteck),
+ *   enbw:          äquivalente Rauschbandbreite in Bins (N * Σw² / (Σw)²); zugleich das Verhältnis der
+ *                  Leistungssumme eines Tons über alle Bins zur Leistung seines Maximums,
+ *   band_gain:     Summe über width benachbarte Bins eines Tons in Bin-Mitte relativ zum Maximum, für
+ *                  Beträge und Leistungen (breite Fenster verteilen einen Ton auf mehr Bins),
+ *   jacobsen_q:    Korrekturfaktor des Jacobsen-Schätzers (peak_interp.h) für dieses Fenster.
+ * Die Tabelle ist auf coherent_gain 1 normiert (mal scale), ein Ton der Amplitude A ergibt damit bei
+ * jedem Fenster dieselbe Spitze; window_band_norm rechnet Bandsummen auf das Hann-Fenster um.
+ */
+
+typedef enum {
+    WINDOW_HANN = 0,
+    WINDOW_BLACKMAN,
+    WINDOW_BLACKMAN_HARRIS,
+    WINDOW_BLACKMAN_NUTTALL,
+    WINDOW_NUTTALL,
+    WINDOW_FLAT_TOP,
+    WINDOW_COUNT
+} window_type_t;
+
+// Größte Bandbreite in Bins, für die band_gain einzeln vorliegt (Hauptkeule des Flat-Top: 9 Bins);
+// breitere Bänder enthalten die ganze Keule
+#define WINDOW_GAIN_WIDTHS 13
+
+// Plätze im Tabellen-Cache (window_cache_get)
+#define WINDOW_CACHE_SLOTS 4
+
+typedef struct {
+    window_type_t type;
+    int size;                  // Länge der Tabelle (0 = freier Platz im Cache)
+    float *table;              // size Werte: w[i] * scale / coherent_gain
+    float coherent_gain;       // Kenngrößen des ungenormten Fensters, siehe oben
+    float enbw;
+    float jacobsen_q;
+    float band_gain[2][WINDOW_GAIN_WIDTHS + 1];   // [0: Betrag, 1: Leistung][Breite in Bins]
+} window_table_t;
+
+typedef struct {
+    window_table_t tables[WINDOW_CACHE_SLOTS];
+    uint32_t last_used[WINDOW_CACHE_SLOTS];
+    uint32_t clock;
+    float scale;               // zusätzlicher Faktor auf alle Tabellen
+    uint32_t hits;
+    uint32_t misses;
+} window_cache_t;
+
+// Berechnet Tabelle und Kenngrößen für type und size (Tabelle auf dem Heap).
+esp_err_t window_table_init(window_table_t *win, window_type_t type, int size, float scale);
+
+// Gibt die Tabelle frei.
+void window_table_deinit(window_table_t *win);
+
+// band_gain des Hann-Fensters für width Bins (Bezug aller Bandsummen).
+float window_hann_gain(int width, bool power);
+
+// Faktor, der eine Summe über width Bins (Betrag bzw. power: Leistung) auf das Hann-Fenster umrechnet,
+// für das Schwellen wie MIN_TOTAL_AMPLITUDE eingestellt sind.
+float window_band_norm(const window_table_t *win, int width, bool power);
+
+// Leerer Cache; scale wird auf alle Tabellen angewendet (z. B. 0,5, wenn die FFT das Ergebnis verdoppelt).
+void window_cache_init(window_cache_t *cache, float scale);
+
+// Liefert die Tabelle für type/size aus dem Cache und berechnet sie bei Bedarf. keep wird nicht
+// verdrängt (die gerade benutzte Tabelle). Die Zeiger bleiben bis zur Verdrängung gültig.
+esp_err_t window_cache_get(window_cache_t *cache, window_type_t type, int size,
+                           const window_table_t *keep, const window_table_t **out);
+
+// Gibt alle Tabellen des Caches frei.
+void window_cache_deinit(window_cache_t *cache);
+
+// Name des Fensters ("hann", "blackman", "blackman-harris", "blackman-nuttall", "nuttall", "flattop")
+// bzw. Fenster zum Namen (-1 = unbekannt)
+const char *window_name(window_type_t type);
+int window_from_name(const char *name);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // WINDOW_H
@@ -0,0 +1,111 @@
+#ifndef ZOOM_FFT_H
+#define ZOOM_FFT_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+#include "dsps_fir.h"
+#include "dsps_cplx_gen.h"
+#include "fft_plan.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Zoom-FFT für ein Frequenzband [low_hz, high_hz]: Die Samples werden mit einem komplexen Oszillator
+ * (dsps_cplx_gen) auf die Bandmitte ins Basisband gemischt, I und Q mit dsps_fird_f32 tiefpassgefiltert
+ * und um factor dezimiert. Eine komplexe FFT über fft_size Basisband-Werte liefert dann Bins von
+ * sample_rate / (factor * fft_size) Hz – dieselbe Auflösung wie eine FFT über factor * fft_size
+ * Samples, aber nur für das Band und zu einem Bruchteil der Rechenzeit.
+ *
+ * Die Eingangsstufe (Mischen + Dezimieren) läuft kontinuierlich über alle Samples (zoom_fft_push),
+ * die FFT jeweils nach fft_size / 2 neuen Basisband-Werten (50 % Überlappung).
+ */
+
+// Nutzbarer Anteil der Basisband-Bandbreite (Rest = Übergangsbereich des Filters, gilt für
+// mindestens 20 Taps je Faktor)
+#define ZOOM_FFT_USABLE_BW 0.8f
+
+typedef struct {
+    float sample_rate;      // Abtastrate der Eingangssamples
+    float low_hz;           // untere Bandgrenze
+    float high_hz;          // obere Bandgrenze
+    float center_hz;        // Mischfrequenz (Bandmitte)
+    int factor;             // Zoom- bzw. Dezimierungsfaktor
+    float bin_width;        // Auflösung der Zoom-FFT in Hz
+
+    cplx_sig_t lo;          // Mischoszillator e^(-j 2 pi center_hz t)
+    fir_f32_t fir_i;        // Tiefpass + Dezimierung für I
+    fir_f32_t fir_q;        // Tiefpass + Dezimierung für Q
+    float *coeffs;          // Filterkoeffizienten (taps_per_factor * max_factor Werte)
+    float *delay_i;         // Verzögerungsleitungen
+    float *delay_q;
+    float *lo_buf;          // Oszillatorwerte eines Blocks (interleaved cos/sin)
+    float *in;              // DC-freie Eingangssamples eines Blocks
+    float *mix_i;           // gemischte Samples inkl. Rest des letzten Blocks
+    float *mix_q;
+    float *dec_i;           // dezimierte Samples eines Blocks
+    float *dec_q;
+    float dc;               // gleitender Mittelwert der Eingangssamples
+    bool dc_valid;
+    uint32_t in_len;        // gemischte Samples, die noch keinen Dezimierungsschritt ergeben
+    uint32_t max_in;        // maximale Blocklänge der Eingangsstufe
+    int max_factor;
+    int taps_per_factor;
+
+    float *baseband;        // Ring mit den letzten fft_size Basisband-Werten (interleaved I/Q)
+    uint32_t bb_write;      // nächste Schreibposition = ältester Wert
+    uint32_t bb_filled;     // gültige Werte im Ring (bis fft_size)
+    uint32_t bb_new;        // neue Werte seit der letzten Transformation
+    uint32_t bb_count;      // insgesamt erzeugte Basisband-Werte
+    uint32_t frame_pos;     // Position (in Basisband-Werten) des ersten Werts der letzten Transformation
+    fft_plan_t plan;        // komplexe FFT (FFT_PLAN_IQ)
+} zoom_fft_t;
+
+// Legt Oszillator, Filter, Puffer und FFT-Plan an (Band danach mit zoom_fft_configure setzen).
+// Die Filterlänge ist taps_per_factor * factor (taps_per_factor ein Vielfaches von 4).
+esp_err_t zoom_fft_init(zoom_fft_t *zoom, int fft_size, float sample_rate, int max_factor,
+                        int taps_per_factor, uint32_t max_in);
+
+// Gibt alle Puffer wieder frei.
+void zoom_fft_deinit(zoom_fft_t *zoom);
+
+// Prüft das Band und bestimmt den Zoomfaktor: factor 0 = größter Faktor, bei dem das Band noch
+// in ZOOM_FFT_USABLE_BW der Basisband-Bandbreite passt; ein zu großer Faktor ist ein Fehler.
+esp_err_t zoom_fft_select_factor(float sample_rate, float low_hz, float high_hz, int factor,
+                                 int max_factor, int *out_factor);
+
+// Stellt Band und Faktor ein (Filter neu entwerfen, Zustand zurücksetzen).
+esp_err_t zoom_fft_configure(zoom_fft_t *zoom, float low_hz, float high_hz, int factor);
+
+// Mischt und dezimiert n Samples (beliebig lang) in den Basisband-Ring.
+void zoom_fft_push(zoom_fft_t *zoom, const int16_t *in, uint32_t n);
+
+// Ring voll und mindestens fft_size / 2 neue Werte seit der letzten Transformation.
+static inline bool zoom_fft_ready(const zoom_fft_t *zoom)
+{
+    return zoom->bb_filled == (uint32_t)zoom->plan.fft_size &&
+           zoom->bb_new >= (uint32_t)zoom->plan.fft_size / 2;
+}
+
+// Fenster + FFT über die letzten fft_size Basisband-Werte. Liefert fft_size Bins (interleaved re/im)
+// in aufsteigender Frequenz: Bin j liegt bei zoom_fft_bin_hz(zoom, j). Die Skalierung entspricht
+// dem Real-Pfad von fft_plan (Sinus der Amplitude A → Spitze A * fft_size / 2).
+float *zoom_fft_execute(zoom_fft_t *zoom);
+
+static inline float zoom_fft_bin_hz(const zoom_fft_t *zoom, float bin)
+{
+    return zoom->center_hz + (bin - zoom->plan.fft_size / 2) * zoom->bin_width;
+}
+
+// Vergleicht Zoom-FFT und normale FFT (fft_size plain_size sowie gleiche Auflösung) auf Testtönen im
+// Band: mittlerer/maximaler Frequenzfehler des stärksten Bins und Zyklen pro Sekunde Signal (Log).
+void zoom_fft_benchmark(float sample_rate, int fft_size, float low_hz, float high_hz, int factor,
+                        int taps_per_factor, int plain_size);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // ZOOM_FFT_H
@@ -0,0 +1,104 @@
+#include <string.h>
+#include "adc_decode.h"
+
+#define TYPE1_DATA_MASK     0x0FFF
+#define TYPE1_CHANNEL_SHIFT 12
+
+void adc_decode_map_init(adc_decode_map_t *map, const uint8_t *channels, int num_channels)
+{
+    memset(map->slot, -1, sizeof(map->slot));
+    map->num_slots = 0;
+    for (int i = 0; i < num_channels && i < ADC_DECODE_MAX_CHANNELS; i++) {
+        if (channels[i] < ADC_DECODE_MAX_CHANNELS && map->slot[channels[i]] < 0) {
+            map->slot[channels[i]] = map->num_slots++;
+        }
+    }
+}
+
+/*
+ * Ein-Kanal-Fall: Zwei Einträge pro 32-Bit-Zugriff. Der Messwert wird immer geschrieben,
+ * der Ausgabezeiger rückt aber nur bei passendem Kanal vor (keine Sprünge in der Schleife).
+ * Dafür muss im Ausgabepuffer Platz für zwei weitere Werte sein; der Rest läuft einzeln.
+ */
+uint32_t adc_decode_type1_s16(const uint8_t *raw, uint32_t bytes, uint8_t channel,
+                              int16_t *out, uint32_t max_out, uint32_t *invalid)
+{
+    const uint32_t *words = (const uint32_t *)raw;
+    uint32_t entries = bytes / 2;
+    uint32_t pairs = entries / 2;
+    uint32_t n = 0;
+    uint32_t i = 0;
+
+    for (; i < pairs && n + 2 <= max_out; i++) {
+        uint32_t w = words[i];
+        uint32_t lo = w & 0xFFFF;
+        uint32_t hi = w >> 16;
+        out[n] = (int16_t)(lo & TYPE1_DATA_MASK);
+        n += (lo >> TYPE1_CHANNEL_SHIFT) == channel;
+        out[n] = (int16_t)(hi & TYPE1_DATA_MASK);
+        n += (hi >> TYPE1_CHANNEL_SHIFT) == channel;
+    }
+
+    const uint16_t *entry = (const uint16_t *)raw;
+    uint32_t e = i * 2;
+    for (; e < entries && n < max_out; e++) {
+        if ((entry[e] >> TYPE1_CHANNEL_SHIFT) == channel) {
+            out[n++] = (int16_t)(entry[e] & TYPE1_DATA_MASK);
+        }
+    }
+
+    *invalid += e - n;
+    return n;
+}
+
+uint32_t adc_decode_type1_f32(const uint8_t *raw, uint32_t bytes, uint8_t channel,
+                              float *out, uint32_t max_out, uint32_t *invalid)
+{
+    const uint32_t *words = (const uint32_t *)raw;
+    uint32_t entries = bytes / 2;
+    uint32_t pairs = entries / 2;
+    uint32_t n = 0;
+    uint32_t i = 0;
+
+    for (; i < pairs && n + 2 <= max_out; i++) {
+        uint32_t w = words[i];
+        uint32_t lo = w & 0xFFFF;
+        uint32_t hi = w >> 16;
+        out[n] = (float)(lo & TYPE1_DATA_MASK);
+        n += (lo >> TYPE1_CHANNEL_SHIFT) == channel;
+        out[n] = (float)(hi & TYPE1_DATA_MASK);
+        n += (hi >> TYPE1_CHANNEL_SHIFT) == channel;
+    }
+
+    const uint16_t *entry = (const uint16_t *)raw;
+    uint32_t e = i * 2;
+    for (; e < entries && n < max_out; e++) {
+        if ((entry[e] >> TYPE1_CHANNEL_SHIFT) == channel) {
+            out[n++] = (float)(entry[e] & TYPE1_DATA_MASK);
+        }
+    }
+
+    *invalid += e - n;
+    return n;
+}
+
+void adc_decode_type1_multi_s16(const uint8_t *raw, uint32_t bytes, const adc_decode_map_t *map,
+                                int16_t *const *outs, uint32_t *counts, uint32_t max_out,
+                                uint32_t *invalid)
+{
+    const uint16_t *entry = (const uint16_t *)raw;
+    uint32_t entries = bytes / 2;
+    uint32_t bad = 0;
+
+    for (uint32_t e = 0; e < entries; e++) {
+        uint32_t v = entry[e];
+        int slot = map->slot[v >> TYPE1_CHANNEL_SHIFT];
+        if (slot < 0 || counts[slot] >= max_out) {
+            bad++;
+            continue;
+        }
+        outs[slot][counts[slot]++] = (int16_t)(v & TYPE1_DATA_MASK);
+    }
+
+    *invalid += bad;
+}
@@ -7,223 +7,1754 @@
 #include "driver/adc.h"
 #include "esp_adc/adc_continuous.h"
 #include "esp_log.h"
+#include "esp_attr.h"
+#include "esp_heap_caps.h"
 #include "esp_dsp.h"
 #include "config.h"
 #include "freertos/semphr.h"
 #include "fastdetect.h"  // Für store_frequency()
+#include "fft_plan.h"
+#include "arena.h"
+#include "window.h"
+#include "sample_ring.h"
+#include "spsc_ring.h"
+#include "seqlock.h"
+#include "adc_decode.h"
+#include "decimator.h"
+#include "band_search.h"
+#include "frame_load.h"
+#include "frame_gate.h"
+#include "zoom_fft.h"
+#include "tone_tracker.h"
+#include "freq_kalman.h"
+#include "peak_interp.h"
+#include "spectrum_avg.h"
+#include "adc_fft.h"
 
 static const char *TAG = "ADC_FFT";
 
+// Das LF-Band muss nach der Dezimierung unterhalb der Nyquist-Frequenz liegen
+_Static_assert((int)LF_HIGH_FREQ * 2 * DECIMATION_FACTOR < SAMPLE_RATE,
+               "LF_HIGH_FREQ must stay below ANALYSIS_SAMPLE_RATE / 2");
+
 // Pufferspeicher – 16-Byte-Ausrichtung (Optimierung)
-__attribute__((aligned(16))) int16_t adc_buffer[FFT_SIZE];
-__attribute__((aligned(16))) float fft_input[FFT_SIZE * 2];
-__attribute__((aligned(16))) float window[FFT_SIZE];
-__attribute__((aligned(16))) float detrended_data[FFT_SIZE];
+// Ein DMA-Block: ein Hop pro Kanal im TYPE1-Format
+__attribute__((aligned(16))) uint8_t adc_dma_buffer[STFT_HOP_SIZE * ADC_NUM_CHANNELS * SOC_ADC_DIGI_RESULT_BYTES];
+
+// FFT-Pläne (Twiddle-, Bitumkehr- und Fenstertabelle) je Größe, beim ersten Gebrauch aufgebaut. fft_plan ist
+// der aktive Plan; seine Arbeitspuffer liegen in ARENA_FFT und werden beim Größenwechsel neu aufgeteilt.
+static fft_plan_cache_t fft_plans;
+static fft_plan_t *fft_plan;
+
+// Fenster der normalen FFT (je Typ und Größe einmal berechnet) und Faktoren je Bandbreite in Bins, die
+// die Bandsummen auf das Hann-Fenster umrechnen, für das MIN_TOTAL_AMPLITUDE eingestellt ist
+static window_cache_t fft_windows;
+static const window_table_t *fft_window;
+static float fft_band_norm[WINDOW_GAIN_WIDTHS + 1];
+_Static_assert(FFT_WINDOW >= 0 && FFT_WINDOW < WINDOW_COUNT, "invalid FFT_WINDOW");
+
+// Laufzeit-Größe und Fenster der normalen FFT: Anforderung über adc_fft_set_fft_size() bzw.
+// adc_fft_set_window(), übernommen im DSP-Task
+_Static_assert(FFT_MIN_SIZE >= 256 && FFT_MIN_SIZE <= FFT_SIZE && FFT_SIZE <= FFT_MAX_SIZE &&
+               FFT_MAX_SIZE <= FFT_PLAN_MAX_SIZE, "invalid FFT_MIN_SIZE / FFT_MAX_SIZE");
+_Static_assert(FFT_MAX_SIZE % FFT_SIZE == 0, "FFT_MAX_SIZE must be a multiple of FFT_SIZE");
+static portMUX_TYPE fft_setup_lock = portMUX_INITIALIZER_UNLOCKED;
+static int fft_size_request = FFT_SIZE;
+static window_type_t fft_window_request = FFT_WINDOW;
+static adc_fft_size_info_t fft_size_active;
 
 // ADC-Handle
 adc_continuous_handle_t adc_handle = NULL;
 
-// Globale Variablen: Hauptfrequenz (LF-Bereich) und Magnitude
-float main_frequency = 0.0;
-float max_magnitude = 0.0;
+// Globale Variablen: Hauptfrequenz (LF-Bereich) und Magnitude je Kanal
+float main_frequency[ADC_NUM_CHANNELS];
+float max_magnitude[ADC_NUM_CHANNELS];
+
+// Fensterbreiten der Bandsuche
+static const float band_widths_hz[] = BAND_WIDTHS_HZ;
+#define NUM_BAND_WIDTHS ((int)(sizeof(band_widths_hz) / sizeof(band_widths_hz[0])))
+_Static_assert(NUM_BAND_WIDTHS <= BAND_SEARCH_MAX_WIDTHS, "too many BAND_WIDTHS_HZ");
+_Static_assert(BAND_SEARCH_TOP_K >= 1 && BAND_SEARCH_TOP_K <= BAND_SEARCH_MAX_TOP_K, "invalid BAND_SEARCH_TOP_K");
+
+// Größtes Spektrum, das analyze_spectrum() auswertet
+#if ENABLE_ZOOM_FFT && ZOOM_FFT_SIZE > FFT_MAX_SIZE / 2
+#define MAX_SPECTRUM_BINS ZOOM_FFT_SIZE
+#else
+#define MAX_SPECTRUM_BINS (FFT_MAX_SIZE / 2)
+#endif
+
+// Zwischenpuffer für band_magnitudes() (Maße POWER und MAGNITUDE_FAST)
+static float band_scratch[MAX_SPECTRUM_BINS];
+
+// Spektrum für analyze_spectrum(): Bin k liegt bei bin0_hz + k * bin_width
+typedef struct {
+    float *data;            // interleaved re/im
+    int bins;               // Anzahl der Bins
+    float bin0_hz;          // Frequenz von Bin 0
+    float bin_width;        // Abstand der Bins in Hz
+    float low_hz;           // Suchbereich der Bandsuche
+    float high_hz;
+    float *magnitudes;      // Arbeitspuffer für die Maße je Bin (bins Werte)
+    const int16_t *samples; // Samples des Frames (fft_size Werte, für YIN) oder NULL
+    int fft_size;           // Größe der FFT (für den Phase-Vocoder)
+    const float *band_norm; // Faktoren auf die Bandsummen je Breite (Fenster -> Hann) oder NULL
+    float jacobsen_q;       // Korrektur des Jacobsen-Schätzers für das Fenster
+    int fft_bin0;           // vorzeichenbehafteter FFT-Frequenzindex von Bin 0
+    uint32_t frame_pos;     // Position des ersten Frame-Samples in Samples der FFT-Eingangsrate
+    float pos_rate;         // Samples je Sekunde dieser Position
+} spectrum_view_t;
+
+// Detektor-Zustand je Kanal
+typedef struct {
+    float prev_frequency;   // letzter Wert für das Rate Limiting
+    freq_kalman_t kalman;   // Kalman-Filter (FREQ_SMOOTH_KALMAN)
+    uint32_t kalman_pos;    // Mitte des zuletzt gefilterten Frames (Einheit wie frame_pos)
+    adc_band_t bands[NUM_BAND_WIDTHS * BAND_SEARCH_TOP_K];   // Ergebnis der letzten Bandsuche
+    seqlock_t bands_lock;   // schützt bands (Leser: adc_fft_get_bands)
+    peak_track_t peak;      // Peak-Bins des letzten Frames (PEAK_EST_PHASE_VOCODER)
+    bool voiced;            // letzter Frame mit Ton (nicht leise), für gehaltene Frames
+} channel_state_t;
+static channel_state_t channel_state[ADC_NUM_CHANNELS];
+
+// Energie-Gate und Stationarität je Kanal (normale FFT, siehe frame_gate.h). fft_silence_energy gilt
+// für die aktive FFT-Größe; die Zyklen dienen der Abschätzung der eingesparten Rechenzeit.
+static frame_gate_t frame_gates[ADC_NUM_CHANNELS];
+static float fft_silence_energy = 0.0f;
+static uint64_t gate_check_cycles = 0;     // Energieberechnung und Entscheidung
+static uint64_t gate_analysis_cycles = 0;  // volle Auswertungen (FFT bis store_frequency)
+
+// Zähler für adc_fft_get_gate_stats() über alle Kanäle, vom DSP-Task je Frame veröffentlicht
+typedef struct {
+    uint32_t frames;
+    uint32_t silent;
+    uint32_t held;
+    uint32_t analyzed;
+    uint32_t changes;
+    uint32_t latency_sum;
+    uint32_t latency_max;
+    int interval;              // Kanal 0
+    int hop;                   // Abstand der Frames der aktiven Größe
+    uint64_t check_cycles;
+    uint64_t analysis_cycles;
+} gate_counters_t;
+static seqlock_t gate_stats_lock;
+static gate_counters_t gate_stats;
+
+// Leseversuche, bevor ein Leser einer Momentaufnahme dem DSP-Task die CPU überlässt
+#define PUBLISH_READ_TRIES 8
+
+// Kanäle im DMA-Pattern (Reihenfolge = Kanalindex 0..ADC_NUM_CHANNELS-1)
+static const uint8_t adc_channels[ADC_NUM_CHANNELS] = ADC_CHANNEL_LIST;
+static adc_decode_map_t adc_channel_map;
 
-// Ringpuffer für gesammelte ADC-Daten
-int16_t collected_data[NUM_BUFFERS][FFT_SIZE];
+// Ringpuffer für gesammelte ADC-Daten je Kanal (lückenlos). Die Zeilen ab NUM_BUFFERS sind der
+// Spiegelbereich des sample_ring, damit jeder Frame bis FFT_MAX_SIZE zusammenhängend im Speicher liegt.
+__attribute__((aligned(16))) int16_t collected_data[ADC_NUM_CHANNELS][NUM_BUFFERS + RING_MIRROR_ROWS][FFT_SIZE];
 int current_buffer_index = 0;
+static sample_ring_t sample_ring[ADC_NUM_CHANNELS];
+static uint64_t channel_samples[ADC_NUM_CHANNELS];   // je Kanal insgesamt geschriebene Samples
+
+#if DECIMATION_FACTOR > 1
+// Dezimierende Eingangsstufe je Kanal; die dekodierten Samples eines DMA-Blocks landen zunächst hier
+static decimator_t decimators[ADC_NUM_CHANNELS];
+static int16_t adc_samples[ADC_NUM_CHANNELS][STFT_HOP_SIZE];
+#endif
+
+// Frame k umfasst die Samples [k * STFT_HOP_SIZE, k * STFT_HOP_SIZE + FFT_SIZE) jedes Kanals.
+// Da die Ringgröße ein Vielfaches des Hops ist, liegt der Frame in allen Kanälen an derselben Position.
+#define RING_SAMPLES (NUM_BUFFERS * FFT_SIZE)
+#define RING_HOPS (RING_SAMPLES / STFT_HOP_SIZE)
+_Static_assert(RING_SAMPLES % STFT_HOP_SIZE == 0, "ring size must be a multiple of STFT_HOP_SIZE");
+
+#if ENABLE_ZOOM_FFT || ENABLE_TONE_TRACKER
+// Ringposition hinter dem zuletzt an die Streaming-Stufen (Zoom-FFT, Tracker) übergebenen Sample
+// (für alle Kanäle gleich, nur im DSP-Task benutzt)
+static uint32_t stream_end = 0;
+#endif
+
+#if ENABLE_ZOOM_FFT
+// Zoom-FFT je Kanal (nur im DSP-Task benutzt)
+static zoom_fft_t zooms[ADC_NUM_CHANNELS];
+#endif
+
+#if ENABLE_TONE_TRACKER
+// Tracker-Bank je Kanal (nur im DSP-Task benutzt)
+static const float tone_freqs[] = TONE_TRACKER_FREQS;
+#define NUM_TONES ((int)(sizeof(tone_freqs) / sizeof(tone_freqs[0])))
+_Static_assert(NUM_TONES <= TONE_TRACKER_MAX_TONES, "too many TONE_TRACKER_FREQS");
+static tone_tracker_t trackers[ADC_NUM_CHANNELS];
+// Ergebnisse je Kanal für adc_fft_get_tones(), vom DSP-Task nach jedem Block veröffentlicht
+static seqlock_t tone_locks[ADC_NUM_CHANNELS];
+static tone_result_t tone_results[ADC_NUM_CHANNELS][NUM_TONES];
+#endif
+
+// YIN: größte Periode in Samples (tiefste Frequenz LF_LOW_FREQ); das Vergleichsfenster umfasst den Rest
+// des Frames und muss mindestens YIN_MAX_LAG lang sein (kleinere FFT-Größen: Rückfall auf DETECTOR_BAND)
+#define YIN_MAX_LAG ((int)(ANALYSIS_SAMPLE_RATE / LF_LOW_FREQ) + 2)
+_Static_assert(FFT_SIZE >= 2 * YIN_MAX_LAG, "FFT_SIZE too small for YIN at LF_LOW_FREQ");
+#define YIN_ENABLED (!ENABLE_ZOOM_FFT && (FREQ_DETECTOR == DETECTOR_YIN || ENABLE_DETECTOR_BENCHMARK))
+
+// Arbeitspuffer für YIN (nur angelegt, wenn YIN laufen kann)
+static float *yin_x;   // DC-freie Samples eines Frames (fft_size Werte, in ARENA_FFT)
+static float *yin_d;   // normierte Differenzfunktion d'(tau) (YIN_MAX_LAG + 1 Werte)
+
+#if ENABLE_SPECTRUM_AVG
+// Spektrum-Akkumulator je Kanal: geschrieben im DSP-Task, gelesen vom HTTP-Server. Der Lock wird je
+// Teilbereich von SPECTRUM_SLICE Bins gehalten, ein Leser kann daher Bereiche verschiedener Frames sehen.
+#define SPECTRUM_SLICE 64
+_Static_assert(SPECTRUM_AVG_BINS >= 1 && SPECTRUM_AVG_BINS <= FFT_SIZE / 2, "invalid SPECTRUM_AVG_BINS");
+// Bei kleineren Laufzeit-Größen werden nur die Bins bis fft_size / 2 gemittelt
+static spectrum_avg_t spectrum_avgs[ADC_NUM_CHANNELS];
+static portMUX_TYPE spectrum_lock = portMUX_INITIALIZER_UNLOCKED;
+static uint32_t spectrum_reset_request;   // Bit je Kanal, ausgeführt im DSP-Task
+#endif
+
+#if ENABLE_SPECTROGRAM
+// Spektrogramm je Kanal: geschrieben im DSP-Task, gelesen ohne Lock (Zeilennummern, siehe spectrogram.h)
+// Bins je Zeile folgen der FFT-Größe (bis LF_HIGH_FREQ); der Ring bietet Platz für FFT_MAX_SIZE
+_Static_assert(SPECTROGRAM_BINS_FOR(FFT_MIN_SIZE) >= 1 && SPECTROGRAM_BINS_FOR(FFT_MIN_SIZE) <= FFT_MIN_SIZE / 2,
+               "invalid SPECTROGRAM_BINS");
+static spectrogram_t spectrograms[ADC_NUM_CHANNELS];
+static bool spectrogram_enabled = false;   // false: Ring nicht angelegt (kein Speicher), /spectrogram aus
+#endif
+
+#if ENABLE_SPECTRUM_AVG || ENABLE_SPECTROGRAM
+// Bins, deren Leistung je Frame für Akkumulator und Spektrogramm berechnet wird
+#define RECORD_BINS_AVG (ENABLE_SPECTRUM_AVG ? SPECTRUM_AVG_BINS : 0)
+#define RECORD_BINS_SG (ENABLE_SPECTROGRAM ? SPECTROGRAM_BINS : 0)
+#define RECORD_BINS (RECORD_BINS_AVG > RECORD_BINS_SG ? RECORD_BINS_AVG : RECORD_BINS_SG)
+#endif
+
+// Zoom-Einstellung: Anforderung über adc_fft_set_zoom(), übernommen im DSP-Task
+static portMUX_TYPE zoom_lock = portMUX_INITIALIZER_UNLOCKED;
+static adc_zoom_config_t zoom_request;
+static bool zoom_request_pending = false;
+static adc_zoom_config_t zoom_active;
+
+// Frame-Queue zwischen ADC-Reader (Produzent) und DSP-Task (Konsument): enthält nur die
+// Frame-Nummern, die Samples selbst werden nicht kopiert.
+static uint32_t frame_queue_storage[FRAME_QUEUE_LEN];
+static spsc_ring_t frame_queue;
+static TaskHandle_t dsp_task_handle = NULL;
+
+// Ein Frame darf im sample_ring nicht überschrieben werden, solange er in der Queue steht
+// oder gerade analysiert wird (Queue + aktueller Frame + ein DMA-Block Vorlauf).
+_Static_assert(RING_SAMPLES >= FFT_MAX_SIZE + (FRAME_QUEUE_LEN + 2) * STFT_HOP_SIZE,
+               "sample ring too small for FRAME_QUEUE_LEN");
+
+// Zähler für den Datenstrom (werden aus den ADC-Tasks bzw. der DMA-ISR geschrieben)
+static volatile uint32_t s_samples_received = 0;
+static volatile uint32_t s_frames_analyzed = 0;
+static volatile uint32_t s_frames_dropped = 0;
+static volatile uint32_t s_invalid_samples = 0;
+static volatile uint32_t s_dma_overruns = 0;
+static volatile uint32_t s_dropped_samples = 0;
 
 // Semaphore für den ADC-Zugriff in save_adc_data
 static SemaphoreHandle_t adc_semaphore = NULL;
 
+/**
+ * DMA-Pool übergelaufen: Der Treiber verwirft einen kompletten Conversion-Frame.
+ * Läuft im ISR-Kontext, daher nur Zähler erhöhen.
+ */
+static bool IRAM_ATTR adc_pool_overflow_cb(adc_continuous_handle_t handle,
+                                           const adc_continuous_evt_data_t *edata, void *user_data)
+{
+    s_dma_overruns++;
+    s_dropped_samples += STFT_HOP_SIZE * ADC_NUM_CHANNELS;
+    return false;
+}
+
+// float-Puffer aus ARENA_FFT (Basis 16-Byte-ausgerichtet; Größen auf 16 Byte aufgerundet, damit es alle bleiben)
+static float *arena_floats(int count) {
+    return (float *)arena_alloc(ARENA_FFT, ((count + 3) & ~3) * sizeof(float));
+}
+
+/**
+ * Schwelle des Energie-Gates für die FFT-Größe n: Energie (Σ (x - mean)²) eines Sinus, dessen auf Hann
+ * umgerechnete Bandsumme im Fenster der ersten Bandbreite die Schwelle von analyze_spectrum() gerade
+ * erreicht, mal ENERGY_GATE_MARGIN². Ein Sinus der Amplitude A hat im Spitzenbin den Betrag A * n / 2
+ * und die Energie A² * n / 2; bei gleicher Energie konzentriert kein anderes Signal wesentlich mehr
+ * Bandsumme im Fenster.
+ */
+static float silence_energy(int n) {
+    if (!ENABLE_ENERGY_GATE) {
+        return 0.0f;
+    }
+    int width = (int)roundf(band_widths_hz[0] * n / ANALYSIS_SAMPLE_RATE);
+    if (width < 1) {
+        width = 1;
+    }
+    float amplitude = (BAND_METRIC == BAND_METRIC_POWER)
+                      ? 2.0f * MIN_TOTAL_AMPLITUDE / (n * sqrtf(width * window_hann_gain(width, true)))
+                      : 2.0f * MIN_TOTAL_AMPLITUDE / (n * window_hann_gain(width, false));
+    amplitude *= ENERGY_GATE_MARGIN;
+    return amplitude * amplitude * n / 2.0f;
+}
+
+/**
+ * Macht plan zum aktiven Plan der normalen FFT: Eingang, Magnituden und YIN-Samples werden für
+ * dessen Größe neu aus ARENA_FFT aufgeteilt. Nur im DSP-Task bzw. vor dessen Start.
+ */
+static esp_err_t activate_fft_plan(fft_plan_t *plan) {
+    int n = plan->fft_size;
+    arena_reset(ARENA_FFT);
+    float *input = arena_floats(fft_plan_input_floats(n, plan->mode));
+    float *magnitudes = arena_floats(fft_plan_magnitude_floats(n, plan->mode));
+    float *samples = YIN_ENABLED ? arena_floats(n) : NULL;
+    if (!input || !magnitudes || (YIN_ENABLED && !samples)) {
+        return ESP_ERR_NO_MEM;
+    }
+    plan->fft_input = input;
+    plan->magnitudes = magnitudes;
+    yin_x = samples;
+    fft_plan = plan;
+
+    // Phasen und Bins der Peak-Schätzung sowie die Referenz der Stationarität gehören zur alten Größe
+    for (int ch = 0; ch < ADC_NUM_CHANNELS; ch++) {
+        peak_track_reset(&channel_state[ch].peak);
+        frame_gate_reset(&frame_gates[ch]);
+    }
+    fft_silence_energy = silence_energy(n);
+
+    int scale = (n > FFT_SIZE) ? n / FFT_SIZE : 1;
+    portENTER_CRITICAL(&fft_setup_lock);
+    fft_size_active.fft_size = n;
+    fft_size_active.bin_hz = ANALYSIS_SAMPLE_RATE / n;
+    fft_size_active.hop = STFT_HOP_SIZE * scale;
+    fft_size_active.cached_plans = fft_plan_cache_count(&fft_plans);
+    fft_size_active.plan_hits = fft_plans.hits;
+    fft_size_active.plan_misses = fft_plans.misses;
+    portEXIT_CRITICAL(&fft_setup_lock);
+    return ESP_OK;
+}
+
+/**
+ * Macht window zum Fenster der normalen FFT. Tonamplituden bleiben gleich (Tabelle auf coherent_gain 1
+ * normiert); die Bandsummen werden mit fft_band_norm auf das Hann-Fenster umgerechnet. Der Faktor hängt
+ * von der Bandbreite ab: ein schmales Band erfasst bei breiten Fenstern nur einen Teil der Hauptkeule.
+ */
+static void set_fft_window(const window_table_t *window) {
+    fft_window = window;
+    for (int width = 0; width <= WINDOW_GAIN_WIDTHS; width++) {
+        fft_band_norm[width] = window_band_norm(window, width, BAND_METRIC == BAND_METRIC_POWER);
+    }
+    portENTER_CRITICAL(&fft_setup_lock);
+    fft_size_active.window = window_name(window->type);
+    fft_size_active.coherent_gain = window->coherent_gain;
+    fft_size_active.enbw = window->enbw;
+    portEXIT_CRITICAL(&fft_setup_lock);
+}
+
 /**
  * Konfiguriert den ADC im Continuous-Modus.
  */
 void configure_adc_continuous() {
     adc_continuous_handle_cfg_t continuous_cfg = {
-        .max_store_buf_size = FFT_SIZE * sizeof(int16_t),
-        .conv_frame_size = FFT_SIZE,
+        .max_store_buf_size = ADC_DMA_POOL_SAMPLES * sizeof(int16_t),
+        .conv_frame_size = sizeof(adc_dma_buffer),
     };
     ESP_ERROR_CHECK(adc_continuous_new_handle(&continuous_cfg, &adc_handle));
 
+    // Jeder Kanal wird mit SAMPLE_RATE abgetastet, der ADC arbeitet das Pattern reihum ab
     adc_continuous_config_t adc_config = {
-        .sample_freq_hz = SAMPLE_RATE,
+        .sample_freq_hz = SAMPLE_RATE * ADC_NUM_CHANNELS,
         .conv_mode = ADC_CONV_SINGLE_UNIT_1,
         .format = ADC_DIGI_OUTPUT_FORMAT_TYPE1,
-        .pattern_num = 1,
+        .pattern_num = ADC_NUM_CHANNELS,
     };
 
-    adc_digi_pattern_config_t adc_pattern[1] = {
-        {
-            .atten = ADC_ATTEN,
-            .channel = ADC_CHANNEL,
-            .unit = ADC_UNIT_1,
-            .bit_width = ADC_BITWIDTH_12,
-        }
-    };
+    adc_digi_pattern_config_t adc_pattern[ADC_NUM_CHANNELS];
+    for (int ch = 0; ch < ADC_NUM_CHANNELS; ch++) {
+        adc_pattern[ch].atten = ADC_ATTEN;
+        adc_pattern[ch].channel = adc_channels[ch];
+        adc_pattern[ch].unit = ADC_UNIT_1;
+        adc_pattern[ch].bit_width = ADC_BITWIDTH_12;
+    }
 
     adc_config.adc_pattern = adc_pattern;
     ESP_ERROR_CHECK(adc_continuous_config(adc_handle, &adc_config));
-    ESP_LOGI(TAG, "ADC continuous mode configured");
+
+    adc_continuous_evt_cbs_t cbs = {
+        .on_pool_ovf = adc_pool_overflow_cb,
+    };
+    ESP_ERROR_CHECK(adc_continuous_register_event_callbacks(adc_handle, &cbs, NULL));
+    ESP_LOGI(TAG, "ADC continuous mode configured (%d channel(s), hop %d of %d samples)",
+             ADC_NUM_CHANNELS, STFT_HOP_SIZE, FFT_SIZE);
+
+    adc_decode_map_init(&adc_channel_map, adc_channels, ADC_NUM_CHANNELS);
+    for (int ch = 0; ch < ADC_NUM_CHANNELS; ch++) {
+        sample_ring_init(&sample_ring[ch], &collected_data[ch][0][0], RING_SAMPLES, FFT_MAX_SIZE);
+        channel_state[ch].prev_frequency = 1.0f;
+        if (FREQ_SMOOTHER == FREQ_SMOOTH_KALMAN) {
+            ESP_ERROR_CHECK(freq_kalman_init(&channel_state[ch].kalman, KALMAN_ACCEL_HZ_S2, KALMAN_MEAS_NOISE_HZ,
+                                             KALMAN_REF_LEVEL, KALMAN_GATE, KALMAN_MAX_OUTLIERS));
+        }
+        frame_gate_init(&frame_gates[ch], STATIONARY_MAX_INTERVAL, STATIONARY_FREQ_TOL_HZ, STATIONARY_LEVEL_TOL);
+        #if DECIMATION_FACTOR > 1
+            ESP_ERROR_CHECK(decimator_init(&decimators[ch], DECIMATION_FACTOR, DECIMATION_FIR_TAPS, STFT_HOP_SIZE));
+        #endif
+    }
+
+    // FFT-Plan und Fenster für die Startgröße aufbauen, perform_fft() führt danach nur noch die
+    // Transformation aus. Im Komplex-Modus verdoppelt dsps_cplx2reC_fc32 das Ergebnis, das Fenster
+    // trägt daher nur die halbe Verstärkung.
+    fft_plan_t *plan;
+    const window_table_t *window;
+    window_cache_init(&fft_windows, FFT_REAL_INPUT ? 1.0f : 0.5f);
+    ESP_ERROR_CHECK(window_cache_get(&fft_windows, FFT_WINDOW, FFT_SIZE, NULL, &window));
+    ESP_ERROR_CHECK(fft_plan_cache_get(&fft_plans, FFT_SIZE, FFT_REAL_INPUT ? FFT_PLAN_REAL : FFT_PLAN_COMPLEX,
+                                       NULL, &plan));
+    if (YIN_ENABLED) {
+        yin_d = (float *)heap_caps_aligned_alloc(16, (YIN_MAX_LAG + 1) * sizeof(float), MALLOC_CAP_8BIT);
+        ESP_ERROR_CHECK(yin_d ? ESP_OK : ESP_ERR_NO_MEM);
+    }
+    ESP_ERROR_CHECK(activate_fft_plan(plan));
+    set_fft_window(window);
+
+    #if ENABLE_SPECTRUM_AVG
+        for (int ch = 0; ch < ADC_NUM_CHANNELS; ch++) {
+            ESP_ERROR_CHECK(spectrum_avg_init(&spectrum_avgs[ch], SPECTRUM_AVG_BINS, SPECTRUM_AVG_FRAMES,
+                                              SPECTRUM_AVG_ALPHA));
+        }
+    #endif
+    #if ENABLE_SPECTROGRAM
+        // ohne Speicher für den Ring läuft die Analyse ohne Spektrogramm weiter
+        spectrogram_enabled = true;
+        for (int ch = 0; ch < ADC_NUM_CHANNELS && spectrogram_enabled; ch++) {
+            spectrogram_enabled = spectrogram_init(&spectrograms[ch], SPECTROGRAM_BINS, SPECTROGRAM_ROWS,
+                                                   SPECTROGRAM_DIVIDER, 4.0f / ((float)FFT_SIZE * FFT_SIZE)) == ESP_OK;
+            if (spectrogram_enabled) {
+                spectrogram_reset(&spectrograms[ch], SPECTROGRAM_BINS_FOR(FFT_SIZE), 4.0f / ((float)FFT_SIZE * FFT_SIZE));
+            }
+        }
+        if (!spectrogram_enabled) {
+            ESP_LOGE(TAG, "Spectrogram disabled (out of memory)");
+            for (int ch = 0; ch < ADC_NUM_CHANNELS; ch++) {
+                spectrogram_deinit(&spectrograms[ch]);
+            }
+        }
+    #endif
+
+    #if ENABLE_ZOOM_FFT
+        for (int ch = 0; ch < ADC_NUM_CHANNELS; ch++) {
+            ESP_ERROR_CHECK(zoom_fft_init(&zooms[ch], ZOOM_FFT_SIZE, ANALYSIS_SAMPLE_RATE, ZOOM_MAX_FACTOR,
+                                          ZOOM_FIR_TAPS_PER_FACTOR, STFT_HOP_SIZE));
+            ESP_ERROR_CHECK(zoom_fft_configure(&zooms[ch], ZOOM_LOW_FREQ, ZOOM_HIGH_FREQ, ZOOM_FACTOR));
+        }
+        zoom_active.low_hz = zooms[0].low_hz;
+        zoom_active.high_hz = zooms[0].high_hz;
+        zoom_active.factor = zooms[0].factor;
+        zoom_active.bin_hz = zooms[0].bin_width;
+    #endif
+
+    #if ENABLE_TONE_TRACKER
+        for (int ch = 0; ch < ADC_NUM_CHANNELS; ch++) {
+            ESP_ERROR_CHECK(tone_tracker_init(&trackers[ch], TONE_TRACKER_MODE, ANALYSIS_SAMPLE_RATE,
+                                              TONE_TRACKER_LEN, tone_freqs, NUM_TONES, STFT_HOP_SIZE));
+        }
+    #endif
+
+    #if ENABLE_FRAME_LOAD_BENCHMARK
+        frame_load_benchmark(FFT_SIZE, 100);
+    #endif
+    #if ENABLE_ZOOM_FFT_BENCHMARK
+        zoom_fft_benchmark(ANALYSIS_SAMPLE_RATE, ZOOM_FFT_SIZE, ZOOM_LOW_FREQ, ZOOM_HIGH_FREQ, ZOOM_FACTOR,
+                           ZOOM_FIR_TAPS_PER_FACTOR, FFT_SIZE);
+    #endif
+    #if ENABLE_PEAK_INTERP_BENCHMARK
+        peak_interp_benchmark(ANALYSIS_SAMPLE_RATE, LF_LOW_FREQ, LF_HIGH_FREQ, 256, FFT_SIZE);
+    #endif
+    #if ENABLE_SPECTROGRAM_BENCHMARK
+        spectrogram_benchmark(SPECTROGRAM_BINS_FOR(FFT_SIZE));
+    #endif
+    #if ENABLE_FREQ_KALMAN_BENCHMARK
+        freq_kalman_benchmark(ANALYSIS_SAMPLE_RATE / STFT_HOP_SIZE, KALMAN_ACCEL_HZ_S2, KALMAN_MEAS_NOISE_HZ,
+                              RATE_LIMIT_MAX_JUMP_HZ);
+    #endif
+    #if ENABLE_TONE_TRACKER_BENCHMARK
+    {
+        const float freqs[] = TONE_TRACKER_FREQS;
+        tone_tracker_benchmark(ANALYSIS_SAMPLE_RATE, TONE_TRACKER_LEN, freqs, sizeof(freqs) / sizeof(freqs[0]), FFT_SIZE);
+    }
+    #endif
 }
 
 /**
- * Führt die FFT aus und sucht im LF-Bereich (zwischen LF_LOW_FREQ und LF_HIGH_FREQ) nach
- * einem zusammenhängenden Frequenzsegment, dessen integrierte Amplitude über ein gleitendes Fenster
- * (definiert durch WINDOW_BANDWIDTH_HZ) maximal ist.
- *
- * Wird die integrierte Amplitude als zu niedrig befunden (unter MIN_TOTAL_AMPLITUDE),
- * wird die Hauptfrequenz auf **1** gesetzt – so signalisiert der Tuner, dass es leise ist.
- *
- * Der neue Frequenzwert wird zudem mittels Rate Limiting (maximal RATE_LIMIT_MAX_JUMP_HZ Sprung)
- * begrenzt.
+ * Entfernt den Mittelwert (DC) der Samples, wendet das aktive Fenster an und schreibt das Ergebnis
+ * mit Schrittweite stride nach dst (Real-Modus: 1, Komplex-Modus: 2 für Real- bzw. Imaginärteil).
  */
-void perform_fft() {
+static inline void load_frame(const int16_t *samples, float *dst, int stride) {
+    frame_load_s16(samples, fft_window->table, dst, fft_plan->fft_size, stride);
+}
 
-    #if ENABLE_ADC_FFT_LOGS
-        ESP_LOGI(TAG, "Performing FFT...");
-    #endif
+/**
+ * Schwelle für die integrierte Amplitude eines Fensters mit seg_bins Bins. MIN_TOTAL_AMPLITUDE gilt
+ * für die Magnituden-Maße; beim Leistungsmaß wird die Schwelle so umgerechnet, dass ein flaches
+ * Spektrum mit derselben Amplitudensumme genau an der Schwelle liegt.
+ */
+static inline float min_segment_sum(int seg_bins) {
+    if (BAND_METRIC == BAND_METRIC_POWER) {
+        return MIN_TOTAL_AMPLITUDE * MIN_TOTAL_AMPLITUDE / seg_bins;
+    }
+    return MIN_TOTAL_AMPLITUDE;
+}
+
+#if ENABLE_BAND_SEARCH_BENCHMARK
+/**
+ * Vergleicht die Bandsuche auf den laufenden Spektren mit der bisherigen O(n * Breite)-Suche
+ * (nur erste Fensterbreite, bestes Fenster) und loggt alle 256 Frames die mittleren Zyklen.
+ */
+static void benchmark_band_search(const float *magnitudes, int num_bins, band_window_t best,
+                                  uint32_t search_cycles) {
+    static uint32_t frames, mismatches;
+    static uint64_t fast_cycles, naive_cycles;
 
-    // Berechne den Mittelwert (DC) und entferne diesen
-    float mean = 0.0f;
-    for (int i = 0; i < FFT_SIZE; i++) {
-        mean += adc_buffer[i];
+    uint32_t start = dsp_get_cpu_cycle_count();
+    band_window_t ref = band_search_naive(magnitudes, num_bins, best.width);
+    naive_cycles += dsp_get_cpu_cycle_count() - start;
+    fast_cycles += search_cycles;
+    if (ref.start != best.start && ref.sum > best.sum * 1.0001f) {
+        mismatches++;
     }
-    mean /= FFT_SIZE;
 
-    for (int i = 0; i < FFT_SIZE; i++) {
-        detrended_data[i] = adc_buffer[i] - mean;
+    if (++frames == 256) {
+        ESP_LOGI(TAG, "Band search: %u cycles (%d widths, top %d) vs. %u cycles naive, %u mismatches",
+                 (unsigned int)(fast_cycles / frames), NUM_BAND_WIDTHS, BAND_SEARCH_TOP_K,
+                 (unsigned int)(naive_cycles / frames), (unsigned int)mismatches);
+        frames = mismatches = 0;
+        fast_cycles = naive_cycles = 0;
     }
+}
+#endif
 
-    // FFT initialisieren und Hann-Fenster anwenden
-    dsps_fft2r_init_fc32(NULL, CONFIG_DSP_MAX_FFT_SIZE);
-    dsps_wind_hann_f32(window, FFT_SIZE);
-    for (int i = 0; i < FFT_SIZE; i++) {
-        fft_input[i * 2]     = detrended_data[i] * window[i]; // Realteil
-        fft_input[i * 2 + 1] = 0.0f;                           // Imaginärteil
+/**
+ * Frequenz der Spitze bei Bin k (Index im Spektrum), verfeinert mit PEAK_ESTIMATOR. track ist der
+ * Zustand des Phase-Vocoders (NULL: Rückfall auf den Jacobsen-Schätzer).
+ */
+static float refine_peak(const spectrum_view_t *view, int k, peak_track_t *track) {
+    if (PEAK_ESTIMATOR == PEAK_EST_NONE || k < 1 || k > view->bins - 2) {
+        if (track) {
+            peak_track_reset(track);
+        }
+        return view->bin0_hz + k * view->bin_width;
     }
 
-    // FFT durchführen
-    dsps_fft2r_fc32(fft_input, FFT_SIZE);
-    dsps_bit_rev_fc32(fft_input, FFT_SIZE);
-    dsps_cplx2reC_fc32(fft_input, FFT_SIZE);
+    float delta;
+    if (PEAK_ESTIMATOR != PEAK_EST_PHASE_VOCODER || !track ||
+        !peak_interp_vocoder(track, view->data, k, view->fft_bin0 + k, view->fft_size, view->frame_pos, &delta)) {
+        delta = peak_interp_offset(PEAK_ESTIMATOR, view->data, k, view->jacobsen_q);
+    }
+    return view->bin0_hz + (k + delta) * view->bin_width;
+}
+
+// Stärkster Wert in mag[from..to]
+static inline int strongest_bin(const float *mag, int from, int to) {
+    int best = from;
+    for (int i = from + 1; i <= to; i++) {
+        if (mag[i] > mag[best]) {
+            best = i;
+        }
+    }
+    return best;
+}
+
+// Eingaben eines Grundfrequenz-Detektors für einen Frame
+typedef struct {
+    const spectrum_view_t *view;
+    const float *magnitudes;    // Maß (BAND_METRIC) je Bin ab Bin first
+    int first;                  // erster Bin des Suchbereichs im Spektrum
+    int num_bins;               // Bins im Suchbereich
+    int mag_bins;               // Bins mit Maß ab first (>= num_bins, für HPS bis zur höchsten Harmonischen)
+    band_window_t best;         // stärkstes Fenster der Bandsuche
+    peak_track_t *track;        // Zustand des Phase-Vocoders (NULL für nicht aktive Detektoren)
+} detector_input_t;
+
+// Liefert die Grundfrequenz in Hz; false = kein Ergebnis (Rückfall auf DETECTOR_BAND)
+typedef bool (*detector_fn_t)(const detector_input_t *in, float *frequency);
+
+typedef struct {
+    const char *name;
+    detector_fn_t detect;
+    uint32_t frames;
+    uint32_t last_cycles;
+    uint32_t octave_jumps;
+    uint32_t failures;
+    uint64_t cycles;
+    float last_frequency[ADC_NUM_CHANNELS];   // letztes Ergebnis je Kanal (für octave_jumps)
+} detector_t;
+
+/**
+ * DETECTOR_BAND: stärkster Bin im besten Fenster der Bandsuche (PEAK_EST_NONE: Fenstermitte wie bisher).
+ */
+static bool detect_band(const detector_input_t *in, float *frequency) {
+    const spectrum_view_t *view = in->view;
+    if (PEAK_ESTIMATOR == PEAK_EST_NONE) {
+        *frequency = view->bin0_hz + (in->first + in->best.start + in->best.width / 2.0f) * view->bin_width;
+        return true;
+    }
+    int k = in->first + strongest_bin(in->magnitudes, in->best.start, in->best.start + in->best.width - 1);
+    *frequency = refine_peak(view, k, in->track);
+    return true;
+}
+
+// Index (relativ zu first) der h-ten Harmonischen von Bin k; gilt auch für Spektren mit bin0_hz != 0
+static inline float harmonic_bin(const spectrum_view_t *view, int first, int k, int h) {
+    return h * k + (h - 1) * view->bin0_hz / view->bin_width - first;
+}
+
+// Anteil der Harmonischen, der als Rauschboden in das Produkt eingeht (fehlende Obertöne)
+#define HPS_FLOOR 0.01f
 
-    // High-Pass Filter: Setze alle Bins unter 20 Hz auf Null
-    const float bin_width = SAMPLE_RATE / (float)FFT_SIZE;
-    int cutoff_bin = (int)(20.0f / bin_width);
-    for (int i = 0; i < cutoff_bin; i++) {
-        fft_input[i * 2] = 0.0f;
-        fft_input[i * 2 + 1] = 0.0f;
+/**
+ * DETECTOR_HPS: Produkt der (auf den stärksten Bin normierten) Magnituden bei k, 2k, ..., HPS_HARMONICS * k
+ * für jeden Kandidaten im Suchbereich. Da die Harmonischen eines Tons zwischen den Bins um bis zu h / 2
+ * Bins von h * k abweichen, zählt jeweils der stärkste Bin im Bereich h * (k +- 1/2). Kandidaten, deren
+ * Grundton schwächer als HPS_MIN_FUNDAMENTAL ist, scheiden aus (sonst gewinnt bei reinen Tönen die
+ * Unteroktave, deren zweite Harmonische der Ton selbst ist).
+ */
+static bool detect_hps(const detector_input_t *in, float *frequency) {
+    const float *mag = in->magnitudes;
+    int top = strongest_bin(mag, 0, in->num_bins - 1);
+    if (!(mag[top] > 0.0f)) {
+        return false;
+    }
+    float scale = 1.0f / mag[top];
+
+    int best = -1;
+    float best_product = 0.0f;
+    for (int i = 0; i < in->num_bins; i++) {
+        if (mag[i] * scale < HPS_MIN_FUNDAMENTAL) {
+            continue;
+        }
+        float product = mag[i] * scale;
+        int h = 2;
+        for (; h <= HPS_HARMONICS; h++) {
+            float center = harmonic_bin(in->view, in->first, in->first + i, h);
+            int lo = (int)ceilf(center - h * 0.5f);
+            int hi = (int)floorf(center + h * 0.5f);
+            if (hi >= in->mag_bins) {
+                break;
+            }
+            product *= mag[strongest_bin(mag, lo, hi)] * scale + HPS_FLOOR;
+        }
+        if (h <= HPS_HARMONICS) {
+            break;   // höhere Kandidaten haben ebenfalls nicht mehr alle Harmonischen im Spektrum
+        }
+        if (product > best_product) {
+            best_product = product;
+            best = i;
+        }
+    }
+    if (best < 0) {
+        return false;
     }
 
-    // Definiere den LF-Bereich anhand von LF_LOW_FREQ und LF_HIGH_FREQ
-    int lf_low_index = (int)ceil(LF_LOW_FREQ / bin_width);
-    int lf_high_index = (int)floor(LF_HIGH_FREQ / bin_width);
+    // Spitze des Grundtons in k-1..k+1 und zwischen den Bins verfeinern
+    int lo = (best > 0) ? best - 1 : 0;
+    int hi = (best < in->num_bins - 1) ? best + 1 : best;
+    *frequency = refine_peak(in->view, in->first + strongest_bin(mag, lo, hi), in->track);
+    return true;
+}
+
+/**
+ * DETECTOR_YIN: normierte Differenzfunktion d'(tau) über die Samples des Frames (de Cheveigné/Kawahara).
+ * d(tau) = e(0) + e(tau) - 2 r(tau) mit laufenden Energien e und der Kreuzkorrelation r über
+ * dsps_dotprod_f32. Die erste Senke unter YIN_THRESHOLD zwischen den Perioden der Suchbereichsgrenzen
+ * ist die Periode; eine Parabel durch d' liefert Bruchteile eines Samples.
+ */
+static bool detect_yin(const detector_input_t *in, float *frequency) {
+    const spectrum_view_t *view = in->view;
+    int n = view->fft_size;
+    int window = n - YIN_MAX_LAG;
+    if (!view->samples || !yin_x || window < YIN_MAX_LAG) {
+        return false;   // Zoom-FFT: keine Samples in Analyse-Rate; Frame zu kurz
+    }
+    int tau_min = (int)(ANALYSIS_SAMPLE_RATE / view->high_hz);
+    int tau_max = (int)ceilf(ANALYSIS_SAMPLE_RATE / view->low_hz) + 1;
+    if (tau_min < 2) {
+        tau_min = 2;
+    }
+    if (tau_max > YIN_MAX_LAG) {
+        tau_max = YIN_MAX_LAG;
+    }
+
+    int32_t sum = 0;
+    for (int i = 0; i < n; i++) {
+        sum += view->samples[i];
+    }
+    float mean = (float)sum / n;
+    for (int i = 0; i < n; i++) {
+        yin_x[i] = view->samples[i] - mean;
+    }
+
+    float e0, e_tau, running = 0.0f;
+    dsps_dotprod_f32(yin_x, yin_x, &e0, window);
+    e_tau = e0;
+    yin_d[0] = 1.0f;
+    for (int tau = 1; tau <= tau_max; tau++) {
+        float r;
+        e_tau += yin_x[tau + window - 1] * yin_x[tau + window - 1] - yin_x[tau - 1] * yin_x[tau - 1];
+        dsps_dotprod_f32(yin_x, yin_x + tau, &r, window);
+        float diff = e0 + e_tau - 2.0f * r;
+        running += diff;
+        yin_d[tau] = (running > 0.0f) ? diff * tau / running : 1.0f;
+    }
+
+    // Erste Senke unter der Schwelle, dann bis zu ihrem Minimum
+    int tau = tau_min;
+    while (tau < tau_max && yin_d[tau] >= YIN_THRESHOLD) {
+        tau++;
+    }
+    if (tau >= tau_max) {
+        return false;
+    }
+    while (tau + 1 < tau_max && yin_d[tau + 1] < yin_d[tau]) {
+        tau++;
+    }
+
+    float den = yin_d[tau - 1] - 2.0f * yin_d[tau] + yin_d[tau + 1];
+    float shift = (den > 0.0f) ? 0.5f * (yin_d[tau - 1] - yin_d[tau + 1]) / den : 0.0f;
+    *frequency = ANALYSIS_SAMPLE_RATE / (tau + shift);
+    return true;
+}
+
+static detector_t detectors[DETECTOR_COUNT] = {
+    [DETECTOR_BAND] = { .name = "band", .detect = detect_band },
+    [DETECTOR_HPS]  = { .name = "hps",  .detect = detect_hps },
+    [DETECTOR_YIN]  = { .name = "yin",  .detect = detect_yin },
+};
+
+// Statistik der Detektoren für adc_fft_get_detector_stats(), vom DSP-Task je Frame veröffentlicht
+static seqlock_t detector_stats_lock;
+static adc_detector_stats_t detector_stats[DETECTOR_COUNT];
+
+// Führt einen Detektor aus und führt seine Statistik (Zyklen, Oktavsprünge, Fehlschläge).
+static bool run_detector(int id, int channel, const detector_input_t *in, float *frequency) {
+    detector_t *det = &detectors[id];
+    uint32_t start = dsp_get_cpu_cycle_count();
+    bool ok = det->detect(in, frequency);
+    det->last_cycles = dsp_get_cpu_cycle_count() - start;
+    det->cycles += det->last_cycles;
+    det->frames++;
+    if (!ok) {
+        det->failures++;
+        return false;
+    }
+    float last = det->last_frequency[channel];
+    if (last > 0.0f && (*frequency > last * 1.8f || *frequency < last * 0.56f)) {
+        det->octave_jumps++;
+    }
+    det->last_frequency[channel] = *frequency;
+    return true;
+}
+
+// Veröffentlicht die Zähler aller Detektoren als eine Momentaufnahme (nur im DSP-Task).
+static void publish_detector_stats(void) {
+    seqlock_write_begin(&detector_stats_lock);
+    for (int d = 0; d < DETECTOR_COUNT; d++) {
+        const detector_t *det = &detectors[d];
+        adc_detector_stats_t *out = &detector_stats[d];
+        out->frames = det->frames;
+        out->avg_cycles = det->frames ? (uint32_t)(det->cycles / det->frames) : 0;
+        out->last_cycles = det->last_cycles;
+        out->octave_jumps = det->octave_jumps;
+        out->failures = det->failures;
+    }
+    seqlock_write_end(&detector_stats_lock);
+}
+
+#if ENABLE_DETECTOR_BENCHMARK
+// Loggt alle 256 Frames die mittleren Zyklen und die Oktavsprünge aller Detektoren.
+static void benchmark_detectors(void) {
+    static uint32_t frames;
+    if (++frames % 256 != 0) {
+        return;
+    }
+    for (int d = 0; d < DETECTOR_COUNT; d++) {
+        const detector_t *det = &detectors[d];
+        ESP_LOGI(TAG, "Detector %-4s%s: %u cycles avg, %u octave jumps, %u failures in %u frames",
+                 det->name, (d == FREQ_DETECTOR) ? " (active)" : "",
+                 (unsigned int)(det->frames ? det->cycles / det->frames : 0), (unsigned int)det->octave_jumps,
+                 (unsigned int)det->failures, (unsigned int)det->frames);
+    }
+}
+#endif
+
+/**
+ * Kalman-Glättung der Frequenz eines Frames. Der Zeitabstand ergibt sich aus den Frame-Mitten, die
+ * Konfidenz level ist die Bandsumme relativ zur Pegelschwelle (beim Leistungsmaß als Amplitudenverhältnis).
+ */
+static float smooth_kalman(channel_state_t *state, const spectrum_view_t *view, float frequency, float level) {
+    uint32_t pos = view->frame_pos + view->fft_size / 2;
+    float dt = (int32_t)(pos - state->kalman_pos) / view->pos_rate;
+    state->kalman_pos = pos;
+    if (BAND_METRIC == BAND_METRIC_POWER) {
+        level = sqrtf(level);
+    }
+    return freq_kalman_update(&state->kalman, frequency, level, dt);
+}
+
+/**
+ * Sucht im Spektrum eines Kanals im Suchbereich (normale FFT: LF_LOW_FREQ bis LF_HIGH_FREQ, Zoom-FFT:
+ * das eingestellte Zoom-Band) nach einem zusammenhängenden Frequenzsegment, dessen integrierte
+ * Amplitude über ein gleitendes Fenster (definiert durch WINDOW_BANDWIDTH_HZ) maximal ist. Das Fenster
+ * dient als Pegelschwelle; die Hauptfrequenz bestimmt der Detektor FREQ_DETECTOR (DETECTOR_BAND: die mit
+ * PEAK_ESTIMATOR zwischen den Bins geschätzte Spitze in diesem Fenster).
+ *
+ * Wird die integrierte Amplitude als zu niedrig befunden (unter MIN_TOTAL_AMPLITUDE),
+ * wird die Hauptfrequenz auf **1** gesetzt – so signalisiert der Tuner, dass es leise ist.
+ *
+ * Der neue Frequenzwert wird anschließend geglättet (FREQ_SMOOTHER): mit dem Kalman-Filter des Kanals
+ * oder mittels Rate Limiting (maximal RATE_LIMIT_MAX_JUMP_HZ Sprung) begrenzt.
+ */
+static void analyze_spectrum(int channel, const spectrum_view_t *view) {
+    channel_state_t *state = &channel_state[channel];
+
+    // High-Pass Filter: Bins unter 20 Hz werden nicht ausgewertet
+    const float bin_width = view->bin_width;
+    int cutoff_bin = (int)((20.0f - view->bin0_hz) / bin_width);
+
+    // Definiere den Suchbereich anhand der Bandgrenzen
+    int lf_low_index = (int)ceilf((view->low_hz - view->bin0_hz) / bin_width);
+    int lf_high_index = (int)floorf((view->high_hz - view->bin0_hz) / bin_width);
     if (lf_low_index < cutoff_bin) {
         lf_low_index = cutoff_bin;
     }
-    if (lf_high_index > FFT_SIZE / 2 - 1) {
-        lf_high_index = FFT_SIZE / 2 - 1;
+    if (lf_low_index < 0) {
+        lf_low_index = 0;
+    }
+    if (lf_high_index > view->bins - 1) {
+        lf_high_index = view->bins - 1;
     }
 
-    // Berechne die Magnituden (Amplitude) für die relevanten Bins im LF-Bereich
+    // Berechne die Magnituden (bzw. das gewählte Maß, BAND_METRIC) für die Bins im LF-Bereich,
+    // für HPS zusätzlich bis zur höchsten Harmonischen des Suchbereichs
     int num_bins = lf_high_index - lf_low_index + 1;
-    float *magnitudes = malloc(num_bins * sizeof(float));
-    if (magnitudes == NULL) {
-        ESP_LOGE(TAG, "Memory allocation for magnitudes failed!");
-        return;
+    int mag_bins = num_bins;
+    if (FREQ_DETECTOR == DETECTOR_HPS || ENABLE_DETECTOR_BENCHMARK) {
+        mag_bins = (int)ceilf(harmonic_bin(view, lf_low_index, lf_high_index, HPS_HARMONICS) + HPS_HARMONICS * 0.5f) + 1;
+        if (mag_bins > view->bins - lf_low_index) {
+            mag_bins = view->bins - lf_low_index;
+        }
     }
-    for (int i = 0; i < num_bins; i++) {
-        int bin_index = lf_low_index + i;
-        magnitudes[i] = sqrt(fft_input[bin_index * 2] * fft_input[bin_index * 2] +
-                             fft_input[bin_index * 2 + 1] * fft_input[bin_index * 2 + 1]);
+    float *magnitudes = view->magnitudes;
+    band_magnitudes(view->data + lf_low_index * 2, mag_bins, BAND_METRIC, magnitudes, band_scratch);
+
+    // Fensterbreiten in Bins (die erste entspricht WINDOW_BANDWIDTH_HZ)
+    int widths[NUM_BAND_WIDTHS];
+    for (int j = 0; j < NUM_BAND_WIDTHS; j++) {
+        widths[j] = (int)roundf(band_widths_hz[j] / bin_width);
     }
 
-    // Fensterbreite in Hz, definiert durch WINDOW_BANDWIDTH_HZ
-    int seg_bins = (int)round(WINDOW_BANDWIDTH_HZ / bin_width);
-    if (seg_bins < 1) seg_bins = 1;
-    if (seg_bins > num_bins) seg_bins = num_bins;
+    // Suche nach den Fenstern (im LF-Bereich) mit der höchsten integrierten Amplitude
+    // (laufende Summen, alle Breiten in einem Aufruf)
+    band_window_t windows[NUM_BAND_WIDTHS * BAND_SEARCH_TOP_K];
+    #if ENABLE_BAND_SEARCH_BENCHMARK
+        uint32_t search_cycles = dsp_get_cpu_cycle_count();
+    #endif
+    band_search(magnitudes, num_bins, widths, NUM_BAND_WIDTHS, BAND_SEARCH_TOP_K, windows);
+    #if ENABLE_BAND_SEARCH_BENCHMARK
+        search_cycles = dsp_get_cpu_cycle_count() - search_cycles;
+        benchmark_band_search(magnitudes, num_bins, windows[0], search_cycles);
+    #endif
 
-    // Suche nach dem Fenster (im LF-Bereich) mit der höchsten integrierten Amplitude
-    float max_segment_sum = 0.0f;
-    int best_segment_start = 0;
-    for (int start = 0; start <= num_bins - seg_bins; start++) {
-        float segment_sum = 0.0f;
-        for (int j = 0; j < seg_bins; j++) {
-            segment_sum += magnitudes[start + j];
-        }
-        if (segment_sum > max_segment_sum) {
-            max_segment_sum = segment_sum;
-            best_segment_start = start;
+    // Summen auf das Hann-Fenster umrechnen (Schwellen und Ausgabe unabhängig vom Fenster)
+    if (view->band_norm) {
+        for (int i = 0; i < NUM_BAND_WIDTHS * BAND_SEARCH_TOP_K; i++) {
+            int width = (windows[i].width < WINDOW_GAIN_WIDTHS) ? windows[i].width : WINDOW_GAIN_WIDTHS;
+            windows[i].sum *= view->band_norm[width];
         }
     }
 
+    seqlock_write_begin(&state->bands_lock);
+    for (int i = 0; i < NUM_BAND_WIDTHS * BAND_SEARCH_TOP_K; i++) {
+        state->bands[i].center_hz = view->bin0_hz +
+                                    (lf_low_index + windows[i].start + windows[i].width / 2.0f) * bin_width;
+        state->bands[i].width_hz = windows[i].width * bin_width;
+        state->bands[i].sum = windows[i].sum;
+    }
+    seqlock_write_end(&state->bands_lock);
+
+    float max_segment_sum = windows[0].sum;
+    int seg_bins = windows[0].width;
+
     // Wird die integrierte Amplitude als zu niedrig befunden, setze Hauptfrequenz auf 1.
-    if (max_segment_sum < MIN_TOTAL_AMPLITUDE) {
-        main_frequency = 1.0f;
-        max_magnitude = max_segment_sum;
+    if (max_segment_sum < min_segment_sum(seg_bins)) {
+        main_frequency[channel] = 1.0f;
+        max_magnitude[channel] = max_segment_sum;
+        state->voiced = false;
+        peak_track_reset(&state->peak);
+        freq_kalman_reset(&state->kalman);
         #if ENABLE_ADC_FFT_LOGS
-            ESP_LOGI(TAG, "Amplitude too low: %.2f. Main frequency set to 1.", max_segment_sum);
+            ESP_LOGI(TAG, "CH%d amplitude too low: %.2f. Main frequency set to 1.", channel, max_segment_sum);
         #endif
-        free(magnitudes);
-        store_frequency(main_frequency);
+        store_frequency(channel, main_frequency[channel], max_magnitude[channel], false);
         return;
     }
 
-    // Berechne den Bin-Mittelpunkt des besten Fensters
-    float center_bin = lf_low_index + best_segment_start + (seg_bins / 2.0f);
-    float new_frequency = center_bin * bin_width;  // in Hz
+    // Grundfrequenz über den gewählten Detektor (ohne Ergebnis: Spitze im besten Fenster)
+    detector_input_t input = {
+        .view = view,
+        .magnitudes = magnitudes,
+        .first = lf_low_index,
+        .num_bins = num_bins,
+        .mag_bins = mag_bins,
+        .best = windows[0],
+        .track = &state->peak,
+    };
+    float new_frequency;  // in Hz
+    if (!run_detector(FREQ_DETECTOR, channel, &input, &new_frequency)) {
+        detect_band(&input, &new_frequency);
+    }
+    #if ENABLE_DETECTOR_BENCHMARK
+        input.track = NULL;
+        for (int d = 0; d < DETECTOR_COUNT; d++) {
+            float frequency;
+            if (d != FREQ_DETECTOR) {
+                run_detector(d, channel, &input, &frequency);
+            }
+        }
+        benchmark_detectors();
+    #endif
+    publish_detector_stats();
 
-    // Rate Limiting: Erlaube maximal RATE_LIMIT_MAX_JUMP_HZ Frequenzsprung pro Zyklus
-    static float prev_frequency = 1.0f;
-    if (fabs(new_frequency - prev_frequency) > RATE_LIMIT_MAX_JUMP_HZ) {
-        if (new_frequency > prev_frequency)
-            new_frequency = prev_frequency + RATE_LIMIT_MAX_JUMP_HZ;
-        else
-            new_frequency = prev_frequency - RATE_LIMIT_MAX_JUMP_HZ;
+    if (FREQ_SMOOTHER == FREQ_SMOOTH_KALMAN) {
+        new_frequency = smooth_kalman(state, view, new_frequency, max_segment_sum / min_segment_sum(seg_bins));
+    } else {
+        // Rate Limiting: Erlaube maximal RATE_LIMIT_MAX_JUMP_HZ Frequenzsprung pro Zyklus
+        float prev_frequency = state->prev_frequency;
+        if (fabsf(new_frequency - prev_frequency) > RATE_LIMIT_MAX_JUMP_HZ) {
+            if (new_frequency > prev_frequency)
+                new_frequency = prev_frequency + RATE_LIMIT_MAX_JUMP_HZ;
+            else
+                new_frequency = prev_frequency - RATE_LIMIT_MAX_JUMP_HZ;
+        }
+        state->prev_frequency = new_frequency;
     }
-    prev_frequency = new_frequency;
 
     // Setze globale Variablen: Die Hauptfrequenz wird als neuer, limitierter Wert ausgegeben
-    main_frequency = new_frequency - OFFSET;
-    max_magnitude = max_segment_sum;
+    main_frequency[channel] = new_frequency - OFFSET;
+    max_magnitude[channel] = max_segment_sum;
+    state->voiced = true;
 
     #if ENABLE_ADC_FFT_LOGS
-        ESP_LOGI(TAG, "LF Main Frequency (window center, limited): %.2f Hz, Integrated Magnitude: %.2f",
-                 main_frequency, max_magnitude);
+        ESP_LOGI(TAG, "CH%d LF Main Frequency (%s/%s, limited): %.2f Hz, Integrated Magnitude: %.2f",
+                 channel, detectors[FREQ_DETECTOR].name, peak_estimator_name(PEAK_ESTIMATOR),
+                 main_frequency[channel], max_magnitude[channel]);
     #endif
 
-    free(magnitudes);
-
     // Speichere die Frequenzmessung – auch die Fastdetect-Chunks erhalten so diesen Wert.
-    store_frequency(main_frequency);
+    store_frequency(channel, main_frequency[channel], max_magnitude[channel], true);
 }
 
-void collect_adc_continuous_data() {
+// Fortlaufende Position des aktuellen Frames der normalen FFT in Samples (für den Phase-Vocoder)
+static uint32_t fft_frame_pos = 0;
+
+// Spektrum der normalen FFT (Bins 0..fft_size/2-1 ab spectrum) mit dem LF-Bereich als Suchbereich
+static inline spectrum_view_t fft_view(float *spectrum, const int16_t *samples) {
+    int n = fft_plan->fft_size;
+    spectrum_view_t view = {
+        .data = spectrum,
+        .bins = n / 2,
+        .bin0_hz = 0.0f,
+        .bin_width = ANALYSIS_SAMPLE_RATE / n,
+        .low_hz = LF_LOW_FREQ,
+        .high_hz = LF_HIGH_FREQ,
+        .magnitudes = fft_plan->magnitudes,
+        .samples = samples,
+        .fft_size = n,
+        .band_norm = fft_band_norm,
+        .jacobsen_q = fft_window->jacobsen_q,
+        .fft_bin0 = 0,
+        .frame_pos = fft_frame_pos,
+        .pos_rate = ANALYSIS_SAMPLE_RATE,
+    };
+    return view;
+}
+
+#if ENABLE_SPECTRUM_AVG || ENABLE_SPECTROGRAM
+/**
+ * Nimmt das Leistungsspektrum eines Frames der normalen FFT in den Akkumulator und das Spektrogramm des
+ * Kanals auf (view->magnitudes dient als Zwischenpuffer und wird danach von analyze_spectrum() überschrieben).
+ */
+static void record_spectrum(int channel, const spectrum_view_t *view) {
+    float *power = view->magnitudes;
+    band_magnitudes(view->data, (RECORD_BINS < view->bins) ? RECORD_BINS : view->bins, BAND_METRIC_POWER,
+                    power, band_scratch);
+
+    #if ENABLE_SPECTRUM_AVG
+        spectrum_avg_t *avg = &spectrum_avgs[channel];
+        portENTER_CRITICAL(&spectrum_lock);
+        if (spectrum_reset_request & (1u << channel)) {
+            spectrum_reset_request &= ~(1u << channel);
+            spectrum_avg_reset(avg);
+        }
+        portEXIT_CRITICAL(&spectrum_lock);
+
+        int bins = (SPECTRUM_AVG_BINS < view->bins) ? SPECTRUM_AVG_BINS : view->bins;
+        for (int first = 0; first < bins; first += SPECTRUM_SLICE) {
+            int n = (bins - first < SPECTRUM_SLICE) ? bins - first : SPECTRUM_SLICE;
+            portENTER_CRITICAL(&spectrum_lock);
+            spectrum_avg_update(avg, power + first, first, n);
+            portEXIT_CRITICAL(&spectrum_lock);
+        }
+        portENTER_CRITICAL(&spectrum_lock);
+        spectrum_avg_commit(avg);
+        portEXIT_CRITICAL(&spectrum_lock);
+    #endif
+
+    #if ENABLE_SPECTROGRAM
+        // gehaltene Frames (frame_gate.h) seit der letzten Auswertung zählen mit diesem Spektrum
+        if (spectrogram_enabled) {
+            spectrogram_push_frames(&spectrograms[channel], power, 1 + frame_gates[channel].held);
+        }
+    #endif
+}
+#endif
+
+/**
+ * Führt die FFT über die Samples eines Kanals (aktive FFT-Größe) aus und wertet das Spektrum aus
+ * (Hauptfrequenz im LF-Bereich, Rate Limiting, store_frequency()).
+ */
+void perform_fft(int channel, const int16_t *samples) {
+
+    #if ENABLE_ADC_FFT_LOGS
+        ESP_LOGI(TAG, "Performing FFT (CH%d)...", channel);
+        uint32_t start_cycles = dsp_get_cpu_cycle_count();
+    #endif
+
+    float *fft_input = fft_plan->fft_input;
+
+    // DC entfernen und das gewählte Fenster (fft_window->table aus window_cache_get) anwenden
+    if (fft_plan->mode == FFT_PLAN_REAL) {
+        // Real-FFT: die reellen Samples werden direkt als N/2 komplexe Werte interpretiert
+        load_frame(samples, fft_input, 1);
+    } else {
+        load_frame(samples, fft_input, 2);                       // Realteil
+        for (int i = 0; i < fft_plan->fft_size; i++) {
+            fft_input[i * 2 + 1] = 0.0f;                          // Imaginärteil
+        }
+    }
+
+    // FFT durchführen
+    fft_plan_execute(fft_plan);
+    spectrum_view_t view = fft_view(fft_input, samples);
+    #if ENABLE_SPECTRUM_AVG || ENABLE_SPECTROGRAM
+        record_spectrum(channel, &view);
+    #endif
+    analyze_spectrum(channel, &view);
+
+    #if ENABLE_ADC_FFT_LOGS
+        ESP_LOGI(TAG, "perform_fft: %u cycles", (unsigned int)(dsp_get_cpu_cycle_count() - start_cycles));
+    #endif
+}
+
+#if !ENABLE_ZOOM_FFT
+/**
+ * Übernimmt eine über adc_fft_set_fft_size() bzw. adc_fft_set_window() angeforderte Einstellung:
+ * Fenster und Plan aus den Caches (bei Bedarf berechnen), bei neuer Größe die Arbeitspuffer neu
+ * aufteilen sowie gemitteltes Spektrum und Spektrogramm neu beginnen. Schlägt das fehl, bleibt die
+ * bisherige Einstellung aktiv.
+ */
+static void apply_fft_request(void) {
+    portENTER_CRITICAL(&fft_setup_lock);
+    int size = fft_size_request;
+    window_type_t type = fft_window_request;
+    portEXIT_CRITICAL(&fft_setup_lock);
+    fft_plan_t *previous = fft_plan;
+    if (size == previous->fft_size && type == fft_window->type) {
+        return;
+    }
+
+    const window_table_t *window;
+    esp_err_t ret = window_cache_get(&fft_windows, type, size, fft_window, &window);
+    if (ret == ESP_OK && size == previous->fft_size) {
+        set_fft_window(window);
+        ESP_LOGI(TAG, "FFT window %s (ENBW %.2f bins)", window_name(type), window->enbw);
+        return;
+    }
+    fft_plan_t *plan;
+    if (ret == ESP_OK) {
+        ret = fft_plan_cache_get(&fft_plans, size, previous->mode, previous, &plan);
+    }
+    if (ret == ESP_OK) {
+        ret = activate_fft_plan(plan);
+        if (ret != ESP_OK) {
+            activate_fft_plan(previous);   // passt, da die Puffer vorher schon in der Arena lagen
+        }
+    }
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "FFT size %d / window %s rejected (%s), keeping %d / %s", size, window_name(type),
+                 esp_err_to_name(ret), previous->fft_size, window_name(fft_window->type));
+        portENTER_CRITICAL(&fft_setup_lock);
+        if (fft_size_request == size && fft_window_request == type) {
+            fft_size_request = previous->fft_size;
+            fft_window_request = fft_window->type;
+        }
+        portEXIT_CRITICAL(&fft_setup_lock);
+        return;
+    }
+    set_fft_window(window);
+
+    #if ENABLE_SPECTRUM_AVG
+        portENTER_CRITICAL(&spectrum_lock);
+        spectrum_reset_request = (1u << ADC_NUM_CHANNELS) - 1;
+        portEXIT_CRITICAL(&spectrum_lock);
+    #endif
+    #if ENABLE_SPECTROGRAM
+        for (int ch = 0; ch < ADC_NUM_CHANNELS && spectrogram_enabled; ch++) {
+            spectrogram_reset(&spectrograms[ch], SPECTROGRAM_BINS_FOR(size), 4.0f / ((float)size * size));
+        }
+    #endif
+    ESP_LOGI(TAG, "FFT size %d -> %d (%.2f Hz bins, %s window)", previous->fft_size, size,
+             ANALYSIS_SAMPLE_RATE / size, window_name(type));
+}
+
+/**
+ * Energie-Gate und Stationarität (frame_gate.h) für den Frame eines Kanals; *energy ist die Energie des
+ * Blocks für frame_gate_update(). Ohne beide Verfahren wird jeder Frame ausgewertet.
+ */
+static frame_gate_action_t gate_frame(int channel, const int16_t *samples, float *energy) {
+    *energy = 0.0f;
+    if (!ENABLE_ENERGY_GATE && STATIONARY_MAX_INTERVAL <= 1) {
+        return FRAME_GATE_ANALYZE;
+    }
+    uint32_t start_cycles = dsp_get_cpu_cycle_count();
+    *energy = frame_gate_energy_s16(samples, fft_plan->fft_size);
+    frame_gate_action_t action = frame_gate_check(&frame_gates[channel], *energy, fft_silence_energy);
+    gate_check_cycles += dsp_get_cpu_cycle_count() - start_cycles;
+    return action;
+}
+
+/**
+ * Ergebnis eines Frames ohne FFT: leise Frames wie unter MIN_TOTAL_AMPLITUDE (Hauptfrequenz 1,
+ * Integrierte Amplitude 0, keine Bänder; im Spektrogramm Stille), gehaltene mit dem letzten Ergebnis.
+ */
+static void skip_frame(int channel, frame_gate_action_t action) {
+    channel_state_t *state = &channel_state[channel];
+    if (action == FRAME_GATE_SILENT) {
+        main_frequency[channel] = 1.0f;
+        max_magnitude[channel] = 0.0f;
+        state->voiced = false;
+        seqlock_write_begin(&state->bands_lock);
+        memset(state->bands, 0, sizeof(state->bands));
+        seqlock_write_end(&state->bands_lock);
+        peak_track_reset(&state->peak);
+        freq_kalman_reset(&state->kalman);
+        #if ENABLE_SPECTROGRAM
+            if (spectrogram_enabled) {
+                spectrogram_push_frames(&spectrograms[channel], NULL, 1);
+            }
+        #endif
+    }
+    store_frequency(channel, main_frequency[channel], max_magnitude[channel], state->voiced);
+}
+
+// Übergibt das Ergebnis einer vollen Auswertung an die Stationarität des Kanals.
+static inline void gate_analyzed(int channel, float energy) {
+    frame_gate_update(&frame_gates[channel], energy, !channel_state[channel].voiced,
+                      main_frequency[channel], max_magnitude[channel]);
+}
+
+// Veröffentlicht die Zähler von Energie-Gate und Stationarität als eine Momentaufnahme (nur im DSP-Task).
+static void publish_gate_stats(void) {
+    gate_counters_t counters = {
+        .interval = frame_gates[0].interval,
+        .hop = fft_size_active.hop,
+        .check_cycles = gate_check_cycles,
+        .analysis_cycles = gate_analysis_cycles,
+    };
+    for (int ch = 0; ch < ADC_NUM_CHANNELS; ch++) {
+        const frame_gate_t *gate = &frame_gates[ch];
+        counters.frames += gate->frames;
+        counters.silent += gate->silent;
+        counters.held += gate->holds;
+        counters.analyzed += gate->analyzed;
+        counters.changes += gate->changes;
+        counters.latency_sum += gate->latency_sum;
+        if (gate->latency_max > counters.latency_max) {
+            counters.latency_max = gate->latency_max;
+        }
+    }
+    seqlock_write_begin(&gate_stats_lock);
+    gate_stats = counters;
+    seqlock_write_end(&gate_stats_lock);
+}
+
+/**
+ * Führt die FFT für einen Frame aller Kanäle aus. Im Komplex-Modus werden je zwei Kanäle als
+ * Real- und Imaginärteil in eine FFT gepackt; dsps_cplx2reC_fc32 trennt die Spektren wieder
+ * (Kanal A in Bins 0..N/2-1, Kanal B ab fft_input + N, gleiche Skalierung).
+ *
+ * Die Frame-Queue liefert Frames über FFT_SIZE Samples im Abstand STFT_HOP_SIZE. Bei einer anderen
+ * Größe N endet der Frame an derselben Stelle und reicht N Samples zurück (der Spiegelbereich des
+ * Rings hält ihn zusammenhängend); ab N > FFT_SIZE wird nur jeder N / FFT_SIZE-te Frame
+ * ausgewertet, damit die Überlappung gleich bleibt. Vor der FFT entscheidet gate_frame() je Kanal, ob
+ * der Frame überhaupt ausgewertet werden muss.
+ */
+static void perform_fft_frame(uint32_t start) {
+    static uint32_t last_start = 0;
+    static uint32_t stream_pos = FFT_SIZE;   // fortlaufende Position des Frame-Endes
+    static uint32_t next_pos = 0;            // frühestes Frame-Ende für die nächste Auswertung
+    int ch = 0;
+
+    // Ringpositionen zu einer fortlaufenden Position auflösen (Abstand zum letzten Frame < Ringgröße)
+    stream_pos += (start + RING_SAMPLES - last_start) % RING_SAMPLES;
+    last_start = start;
+
+    int size = fft_plan->fft_size;
+    apply_fft_request();
+    if (fft_plan->fft_size != size) {
+        size = fft_plan->fft_size;
+        next_pos = stream_pos;
+    }
+    if ((int32_t)(stream_pos - next_pos) < 0 || stream_pos < (uint32_t)size) {
+        return;   // noch nicht genug neue bzw. überhaupt genug Samples für diese Größe
+    }
+    next_pos = stream_pos + STFT_HOP_SIZE * ((size > FFT_SIZE) ? size / FFT_SIZE : 1);
+    fft_frame_pos = stream_pos - size;
+    start = (start + FFT_SIZE + RING_SAMPLES - size) % RING_SAMPLES;
+
+    if (fft_plan->mode == FFT_PLAN_COMPLEX) {
+        float *fft_input = fft_plan->fft_input;
+        for (; ch + 1 < ADC_NUM_CHANNELS; ch += 2) {
+            const int16_t *samples_a = sample_ring_frame(&sample_ring[ch], start);
+            const int16_t *samples_b = sample_ring_frame(&sample_ring[ch + 1], start);
+            float energy_a, energy_b;
+            frame_gate_action_t action_a = gate_frame(ch, samples_a, &energy_a);
+            frame_gate_action_t action_b = gate_frame(ch + 1, samples_b, &energy_b);
+            if (action_a != FRAME_GATE_ANALYZE) {
+                skip_frame(ch, action_a);
+            }
+            if (action_b != FRAME_GATE_ANALYZE) {
+                skip_frame(ch + 1, action_b);
+            }
+            if (action_a != FRAME_GATE_ANALYZE && action_b != FRAME_GATE_ANALYZE) {
+                continue;   // beide Kanäle ohne FFT
+            }
+
+            // Die FFT trägt immer beide Kanäle, ausgewertet werden nur die nötigen
+            uint32_t start_cycles = dsp_get_cpu_cycle_count();
+            load_frame(samples_a, fft_input, 2);
+            load_frame(samples_b, fft_input + 1, 2);
+            fft_plan_execute(fft_plan);
+            spectrum_view_t view_a = fft_view(fft_input, samples_a);
+            spectrum_view_t view_b = fft_view(fft_input + size, samples_b);
+            if (action_a == FRAME_GATE_ANALYZE) {
+                #if ENABLE_SPECTRUM_AVG || ENABLE_SPECTROGRAM
+                    record_spectrum(ch, &view_a);
+                #endif
+                analyze_spectrum(ch, &view_a);
+                gate_analyzed(ch, energy_a);
+            }
+            if (action_b == FRAME_GATE_ANALYZE) {
+                #if ENABLE_SPECTRUM_AVG || ENABLE_SPECTROGRAM
+                    record_spectrum(ch + 1, &view_b);
+                #endif
+                analyze_spectrum(ch + 1, &view_b);
+                gate_analyzed(ch + 1, energy_b);
+            }
+            uint32_t cycles = dsp_get_cpu_cycle_count() - start_cycles;
+            gate_analysis_cycles += cycles;
+            #if ENABLE_ADC_FFT_LOGS
+                ESP_LOGI(TAG, "perform_fft (CH%d+CH%d): %u cycles", ch, ch + 1, (unsigned int)cycles);
+            #endif
+        }
+    }
+
+    // Real-Modus bzw. ungerader Restkanal: ein Kanal pro FFT
+    for (; ch < ADC_NUM_CHANNELS; ch++) {
+        const int16_t *samples = sample_ring_frame(&sample_ring[ch], start);
+        float energy;
+        frame_gate_action_t action = gate_frame(ch, samples, &energy);
+        if (action != FRAME_GATE_ANALYZE) {
+            skip_frame(ch, action);
+            continue;
+        }
+        uint32_t start_cycles = dsp_get_cpu_cycle_count();
+        perform_fft(ch, samples);
+        gate_analyzed(ch, energy);
+        gate_analysis_cycles += dsp_get_cpu_cycle_count() - start_cycles;
+    }
+    publish_gate_stats();
+}
+
+#else
+/**
+ * Übernimmt eine über adc_fft_set_zoom() angeforderte Einstellung für alle Kanäle.
+ */
+static void apply_zoom_request(void) {
+    portENTER_CRITICAL(&zoom_lock);
+    bool pending = zoom_request_pending;
+    adc_zoom_config_t request = zoom_request;
+    zoom_request_pending = false;
+    portEXIT_CRITICAL(&zoom_lock);
+    if (!pending) {
+        return;
+    }
+
+    for (int ch = 0; ch < ADC_NUM_CHANNELS; ch++) {
+        if (zoom_fft_configure(&zooms[ch], request.low_hz, request.high_hz, request.factor) != ESP_OK) {
+            ESP_LOGE(TAG, "Zoom setting rejected (CH%d)", ch);
+            return;
+        }
+    }
+    for (int ch = 0; ch < ADC_NUM_CHANNELS; ch++) {
+        peak_track_reset(&channel_state[ch].peak);
+    }
+    portENTER_CRITICAL(&zoom_lock);
+    zoom_active = request;
+    portEXIT_CRITICAL(&zoom_lock);
+}
+
+/**
+ * Zoom-FFT für einen Frame: Die fresh neuen Samples am Frame-Ende durchlaufen je Kanal die
+ * Misch- und Dezimierstufe; sobald genügend neue Basisband-Werte vorliegen, folgen Zoom-FFT und
+ * Auswertung (bei Faktor 15 und ZOOM_FFT_SIZE 1024 etwa alle 7700 Samples).
+ */
+static void perform_zoom_frame(uint32_t start, uint32_t fresh) {
+    apply_zoom_request();
+
+    for (int ch = 0; ch < ADC_NUM_CHANNELS; ch++) {
+        zoom_fft_t *zoom = &zooms[ch];
+        zoom_fft_push(zoom, sample_ring_frame(&sample_ring[ch], start) + FFT_SIZE - fresh, fresh);
+        if (!zoom_fft_ready(zoom)) {
+            continue;
+        }
+        #if ENABLE_ADC_FFT_LOGS
+            uint32_t start_cycles = dsp_get_cpu_cycle_count();
+        #endif
+        spectrum_view_t view = {
+            .data = zoom_fft_execute(zoom),
+            .bins = zoom->plan.fft_size,
+            .bin0_hz = zoom_fft_bin_hz(zoom, 0),
+            .bin_width = zoom->bin_width,
+            .low_hz = zoom->low_hz,
+            .high_hz = zoom->high_hz,
+            .magnitudes = zoom->plan.magnitudes,
+            .fft_size = zoom->plan.fft_size,
+            .band_norm = NULL,
+            .jacobsen_q = PEAK_JACOBSEN_Q_HANN,
+            .fft_bin0 = -zoom->plan.fft_size / 2,
+            .frame_pos = zoom->frame_pos,
+            .pos_rate = zoom->sample_rate / zoom->factor,
+        };
+        analyze_spectrum(ch, &view);
+        #if ENABLE_ADC_FFT_LOGS
+            ESP_LOGI(TAG, "zoom fft (CH%d): %u cycles", ch, (unsigned int)(dsp_get_cpu_cycle_count() - start_cycles));
+        #endif
+    }
+}
+#endif
+
+#if ENABLE_ZOOM_FFT || ENABLE_TONE_TRACKER
+/**
+ * Anzahl der seit dem letzten Frame neuen Samples am Ende des Frames ab start. Nach verworfenen
+ * Frames wird höchstens der aktuelle Frame nachgeholt, ältere Samples können bereits überschrieben sein.
+ */
+static uint32_t frame_fresh_samples(uint32_t start) {
+    uint32_t end = (start + FFT_SIZE) % RING_SAMPLES;
+    uint32_t fresh = (end + RING_SAMPLES - stream_end) % RING_SAMPLES;
+    if (fresh == 0 || fresh > FFT_SIZE) {
+        fresh = FFT_SIZE;
+    }
+    stream_end = end;
+    return fresh;
+}
+#endif
+
+/**
+ * ADC-Reader (Produzent): Liest die DMA-Daten lückenlos in die Ringpuffer der Kanäle und stellt
+ * nach jeweils STFT_HOP_SIZE neuen Samples (in allen Kanälen) die Frame-Nummer über die letzten
+ * FFT_SIZE Samples in die Frame-Queue (überlappende STFT). Der Task blockiert nur in
+ * adc_continuous_read().
+ */
+static void adc_reader_task(void *arg) {
     ESP_ERROR_CHECK(adc_continuous_start(adc_handle));
-    ESP_LOGI(TAG, "ADC started in continuous mode");
+    ESP_LOGI(TAG, "ADC started in continuous mode (core %d)", (int)xPortGetCoreID());
 
-    size_t bytes_read = 0;
+    uint32_t next_frame = 0;   // Nummer des nächsten fälligen Frames
     while (1) {
-        ESP_ERROR_CHECK(adc_continuous_read(adc_handle,
-                                            (uint8_t *)adc_buffer,
-                                            sizeof(adc_buffer),
-                                            (uint32_t *)&bytes_read,
-                                            portMAX_DELAY));
-        if (bytes_read > 0) {
-            #if ENABLE_ADC_FFT_LOGS
-                ESP_LOGI(TAG, "Collected %d bytes of ADC data", bytes_read);
+        uint32_t bytes_read = 0;
+        esp_err_t ret = adc_continuous_read(adc_handle,
+                                            adc_dma_buffer,
+                                            sizeof(adc_dma_buffer),
+                                            &bytes_read,
+                                            portMAX_DELAY);
+        if (ret != ESP_OK || bytes_read == 0) {
+            continue;
+        }
+
+        #if ENABLE_ADC_FFT_LOGS
+            uint32_t decode_start = dsp_get_cpu_cycle_count();
+        #endif
+
+        // TYPE1-Einträge (Kanal + 12-Bit-Wert) entpacken und direkt in die Ringpuffer schreiben
+        // (bzw. bei aktiver Dezimierung zunächst in adc_samples)
+        uint32_t invalid = 0;
+        uint32_t counts[ADC_NUM_CHANNELS] = {0};
+        int16_t *outs[ADC_NUM_CHANNELS];
+        for (int ch = 0; ch < ADC_NUM_CHANNELS; ch++) {
+            #if DECIMATION_FACTOR > 1
+                outs[ch] = adc_samples[ch];
+            #else
+                outs[ch] = sample_ring_write_ptr(&sample_ring[ch]);
             #endif
+        }
+        #if ADC_NUM_CHANNELS == 1
+            counts[0] = adc_decode_type1_s16(adc_dma_buffer, bytes_read, adc_channels[0],
+                                             outs[0], STFT_HOP_SIZE, &invalid);
+        #else
+            adc_decode_type1_multi_s16(adc_dma_buffer, bytes_read, &adc_channel_map,
+                                       outs, counts, STFT_HOP_SIZE, &invalid);
+        #endif
 
-            // Speichere die ADC-Daten im Ringpuffer
-            memcpy(collected_data[current_buffer_index], adc_buffer, sizeof(adc_buffer));
-            current_buffer_index = (current_buffer_index + 1) % NUM_BUFFERS;
+        #if DECIMATION_FACTOR > 1
+            // Anti-Aliasing-Filter + Dezimierung direkt in die Ringpuffer
+            for (int ch = 0; ch < ADC_NUM_CHANNELS; ch++) {
+                counts[ch] = decimator_process(&decimators[ch], adc_samples[ch], counts[ch],
+                                               sample_ring_write_ptr(&sample_ring[ch]));
+            }
+        #endif
 
-            // FFT ausführen und Hauptfrequenz bestimmen
-            perform_fft();
+        // Der Frame-Fortschritt richtet sich nach dem langsamsten Kanal
+        uint64_t available = UINT64_MAX;
+        uint32_t n = 0;
+        for (int ch = 0; ch < ADC_NUM_CHANNELS; ch++) {
+            sample_ring_commit(&sample_ring[ch], counts[ch]);
+            channel_samples[ch] += counts[ch];
+            if (channel_samples[ch] < available) {
+                available = channel_samples[ch];
+            }
+            n += counts[ch];
+        }
+        current_buffer_index = sample_ring[0].write_idx / FFT_SIZE;
+        if (invalid) {
+            s_invalid_samples += invalid;
+        }
+
+        #if ENABLE_ADC_FFT_LOGS
+            ESP_LOGI(TAG, "Decoded %u of %u bytes in %u cycles", (unsigned int)n,
+                     (unsigned int)bytes_read, (unsigned int)(dsp_get_cpu_cycle_count() - decode_start));
+        #endif
+
+        s_samples_received += n;
+
+        // Alle fälligen Frames an den DSP-Task übergeben (bei kleinen DMA-Blöcken auch mehrere)
+        bool queued = false;
+        while ((uint64_t)next_frame * STFT_HOP_SIZE + FFT_SIZE <= available) {
+            uint32_t start = (next_frame % RING_HOPS) * STFT_HOP_SIZE;
+            next_frame++;
+            if (spsc_ring_push(&frame_queue, start)) {
+                queued = true;
+            } else {
+                s_frames_dropped++;   // DSP-Task kommt nicht hinterher
+            }
+        }
+        if (queued) {
+            xTaskNotifyGive(dsp_task_handle);
         }
-        vTaskDelay(pdMS_TO_TICKS(ADC_TASK_DELAY_MS));
     }
 }
 
+/**
+ * DSP-Task (Konsument): Wartet auf neue Frames und führt für jeden Frame die FFT aller Kanäle
+ * samt Bandsuche und store_frequency() aus. Mit Tracker-Bank laufen die Tracker über die neuen
+ * Samples jedes Frames, die normale FFT nur noch jeden TONE_TRACKER_FFT_INTERVAL-ten Frame.
+ */
+static void dsp_task(void *arg) {
+    ESP_LOGI(TAG, "DSP task started (core %d)", (int)xPortGetCoreID());
+    #if ENABLE_TONE_TRACKER && !ENABLE_ZOOM_FFT
+        uint32_t scan_counter = 0;
+    #endif
+    while (1) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        uint32_t start;
+        while (spsc_ring_pop(&frame_queue, &start)) {
+            #if ENABLE_ZOOM_FFT || ENABLE_TONE_TRACKER
+                uint32_t fresh = frame_fresh_samples(start);
+            #endif
+            #if ENABLE_TONE_TRACKER
+                for (int ch = 0; ch < ADC_NUM_CHANNELS; ch++) {
+                    tone_tracker_process(&trackers[ch], sample_ring_frame(&sample_ring[ch], start) + FFT_SIZE - fresh,
+                                         fresh);
+                    seqlock_write_begin(&tone_locks[ch]);
+                    tone_tracker_get(&trackers[ch], tone_results[ch], NUM_TONES);
+                    seqlock_write_end(&tone_locks[ch]);
+                }
+            #endif
+            #if ENABLE_ZOOM_FFT
+                perform_zoom_frame(start, fresh);
+            #elif ENABLE_TONE_TRACKER
+                if (scan_counter++ % TONE_TRACKER_FFT_INTERVAL == 0) {
+                    perform_fft_frame(start);
+                }
+            #else
+                perform_fft_frame(start);
+            #endif
+            s_frames_analyzed++;
+        }
+    }
+}
+
+/**
+ * Startet ADC-Reader und DSP-Task auf getrennten Kernen.
+ */
+void start_adc_fft_tasks() {
+    spsc_ring_init(&frame_queue, frame_queue_storage, FRAME_QUEUE_LEN);
+    xTaskCreatePinnedToCore(dsp_task, "DSP_Task", 4096, NULL, 5, &dsp_task_handle, DSP_TASK_CORE);
+    xTaskCreatePinnedToCore(adc_reader_task, "ADC_Task", 3072, NULL, 6, NULL, ADC_READER_CORE);
+}
+
+/**
+ * Kopiert eine vom DSP-Task veröffentlichte Momentaufnahme (size Bytes ab src) nach dst. Kollidiert
+ * das Lesen wiederholt mit dem Schreiber, überlässt der Leser ihm kurz die CPU.
+ */
+static void read_published(seqlock_t *lock, void *dst, const void *src, size_t size) {
+    while (!seqlock_read(lock, dst, src, size, PUBLISH_READ_TRIES)) {
+        vTaskDelay(1);
+    }
+}
+
+int adc_fft_get_bands(int channel, adc_band_t *out, int max_bands) {
+    if (channel < 0 || channel >= ADC_NUM_CHANNELS) {
+        return 0;
+    }
+    channel_state_t *state = &channel_state[channel];
+    adc_band_t bands[NUM_BAND_WIDTHS * BAND_SEARCH_TOP_K];
+    read_published(&state->bands_lock, bands, state->bands, sizeof(bands));
+    int n = NUM_BAND_WIDTHS * BAND_SEARCH_TOP_K;
+    if (n > max_bands) {
+        n = max_bands;
+    }
+    memcpy(out, bands, n * sizeof(adc_band_t));
+    return n;
+}
+
+int adc_fft_get_detector_stats(adc_detector_stats_t *out, int max) {
+    adc_detector_stats_t snapshot[DETECTOR_COUNT];
+    read_published(&detector_stats_lock, snapshot, detector_stats, sizeof(snapshot));
+    int n = (DETECTOR_COUNT < max) ? DETECTOR_COUNT : max;
+    for (int d = 0; d < n; d++) {
+        out[d] = snapshot[d];
+        out[d].name = detectors[d].name;
+        out[d].active = (d == FREQ_DETECTOR);
+    }
+    return n;
+}
+
+esp_err_t adc_fft_get_spectrum_info(int channel, adc_spectrum_info_t *info) {
+    #if ENABLE_SPECTRUM_AVG
+        if (channel < 0 || channel >= ADC_NUM_CHANNELS) {
+            return ESP_ERR_INVALID_ARG;
+        }
+        portENTER_CRITICAL(&fft_setup_lock);
+        int size = fft_size_active.fft_size;
+        float enbw = fft_size_active.enbw;
+        portEXIT_CRITICAL(&fft_setup_lock);
+        info->bins = (SPECTRUM_AVG_BINS < size / 2) ? SPECTRUM_AVG_BINS : size / 2;
+        info->bin_hz = ANALYSIS_SAMPLE_RATE / size;
+        info->scale = 4.0f / ((float)size * size);
+        info->enbw = enbw;
+        portENTER_CRITICAL(&spectrum_lock);
+        info->frames = spectrum_avgs[channel].frames;
+        info->blocks = spectrum_avgs[channel].blocks;
+        portEXIT_CRITICAL(&spectrum_lock);
+        return ESP_OK;
+    #else
+        return ESP_ERR_NOT_SUPPORTED;
+    #endif
+}
+
+esp_err_t adc_fft_read_spectrum(int channel, spectrum_avg_mode_t mode, int first, int n, float *out) {
+    #if ENABLE_SPECTRUM_AVG
+        if (channel < 0 || channel >= ADC_NUM_CHANNELS || (unsigned)mode >= SPECTRUM_AVG_COUNT ||
+            first < 0 || n < 0 || first + n > SPECTRUM_AVG_BINS) {
+            return ESP_ERR_INVALID_ARG;
+        }
+        // in Teilbereichen, damit der Lock nur kurz gehalten wird
+        while (n > 0) {
+            int slice = (n < SPECTRUM_SLICE) ? n : SPECTRUM_SLICE;
+            portENTER_CRITICAL(&spectrum_lock);
+            spectrum_avg_read(&spectrum_avgs[channel], mode, first, slice, out);
+            portEXIT_CRITICAL(&spectrum_lock);
+            first += slice;
+            out += slice;
+            n -= slice;
+        }
+        return ESP_OK;
+    #else
+        return ESP_ERR_NOT_SUPPORTED;
+    #endif
+}
+
+esp_err_t adc_fft_reset_spectrum(int channel) {
+    #if ENABLE_SPECTRUM_AVG
+        if (channel < -1 || channel >= ADC_NUM_CHANNELS) {
+            return ESP_ERR_INVALID_ARG;
+        }
+        portENTER_CRITICAL(&spectrum_lock);
+        spectrum_reset_request |= (channel < 0) ? (1u << ADC_NUM_CHANNELS) - 1 : (1u << channel);
+        portEXIT_CRITICAL(&spectrum_lock);
+        return ESP_OK;
+    #else
+        return ESP_ERR_NOT_SUPPORTED;
+    #endif
+}
+
+esp_err_t adc_fft_get_spectrogram_info(int channel, adc_spectrogram_info_t *info) {
+    #if ENABLE_SPECTROGRAM
+        if (channel < 0 || channel >= ADC_NUM_CHANNELS) {
+            return ESP_ERR_INVALID_ARG;
+        }
+        if (!spectrogram_enabled) {
+            return ESP_ERR_INVALID_STATE;
+        }
+        const spectrogram_t *sg = &spectrograms[channel];
+        adc_fft_size_info_t size;
+        adc_fft_get_fft_size(&size);
+        info->bins = spectrogram_bins(sg);
+        info->rows = sg->rows;
+        info->row_size = sg->row_size;
+        info->bin_hz = size.bin_hz;
+        info->row_seconds = (float)size.hop * SPECTROGRAM_DIVIDER / ANALYSIS_SAMPLE_RATE;
+        info->oldest = spectrogram_oldest(sg);
+        info->head = spectrogram_head(sg);
+        return ESP_OK;
+    #else
+        return ESP_ERR_NOT_SUPPORTED;
+    #endif
+}
+
+int adc_fft_read_spectrogram(int channel, uint32_t from, int count, uint8_t *out, uint32_t *first) {
+    #if ENABLE_SPECTROGRAM
+        if (channel < 0 || channel >= ADC_NUM_CHANNELS || count < 0 || !spectrogram_enabled) {
+            return 0;
+        }
+        return spectrogram_read(&spectrograms[channel], from, count, out, first);
+    #else
+        return 0;
+    #endif
+}
+
+int adc_fft_get_tones(int channel, tone_result_t *out, int max_tones) {
+    #if ENABLE_TONE_TRACKER
+        if (channel < 0 || channel >= ADC_NUM_CHANNELS) {
+            return 0;
+        }
+        tone_result_t results[NUM_TONES];
+        read_published(&tone_locks[channel], results, tone_results[channel], sizeof(results));
+        int n = (NUM_TONES < max_tones) ? NUM_TONES : max_tones;
+        memcpy(out, results, n * sizeof(tone_result_t));
+        return n;
+    #else
+        return 0;
+    #endif
+}
+
+esp_err_t adc_fft_set_fft_size(int fft_size) {
+    #if !ENABLE_ZOOM_FFT
+        if (fft_size < FFT_MIN_SIZE || fft_size > FFT_MAX_SIZE || (fft_size & (fft_size - 1)) != 0) {
+            return ESP_ERR_INVALID_ARG;
+        }
+        portENTER_CRITICAL(&fft_setup_lock);
+        fft_size_request = fft_size;
+        portEXIT_CRITICAL(&fft_setup_lock);
+        return ESP_OK;
+    #else
+        return ESP_ERR_NOT_SUPPORTED;
+    #endif
+}
+
+esp_err_t adc_fft_set_window(window_type_t type) {
+    #if !ENABLE_ZOOM_FFT
+        if ((unsigned)type >= WINDOW_COUNT) {
+            return ESP_ERR_INVALID_ARG;
+        }
+        portENTER_CRITICAL(&fft_setup_lock);
+        fft_window_request = type;
+        portEXIT_CRITICAL(&fft_setup_lock);
+        return ESP_OK;
+    #else
+        return ESP_ERR_NOT_SUPPORTED;
+    #endif
+}
+
+void adc_fft_get_fft_size(adc_fft_size_info_t *info) {
+    portENTER_CRITICAL(&fft_setup_lock);
+    *info = fft_size_active;
+    info->requested = fft_size_request;
+    portEXIT_CRITICAL(&fft_setup_lock);
+}
+
+esp_err_t adc_fft_set_zoom(float low_hz, float high_hz, int factor) {
+    #if ENABLE_ZOOM_FFT
+        esp_err_t ret = zoom_fft_select_factor(ANALYSIS_SAMPLE_RATE, low_hz, high_hz, factor,
+                                               ZOOM_MAX_FACTOR, &factor);
+        if (ret != ESP_OK) {
+            return ret;
+        }
+        portENTER_CRITICAL(&zoom_lock);
+        zoom_request.low_hz = low_hz;
+        zoom_request.high_hz = high_hz;
+        zoom_request.factor = factor;
+        zoom_request.bin_hz = ANALYSIS_SAMPLE_RATE / factor / ZOOM_FFT_SIZE;
+        zoom_request_pending = true;
+        portEXIT_CRITICAL(&zoom_lock);
+        return ESP_OK;
+    #else
+        return ESP_ERR_NOT_SUPPORTED;
+    #endif
+}
+
+void adc_fft_get_zoom(adc_zoom_config_t *config) {
+    portENTER_CRITICAL(&zoom_lock);
+    *config = zoom_active;
+    portEXIT_CRITICAL(&zoom_lock);
+}
+
+void adc_fft_get_stats(adc_stream_stats_t *stats) {
+    stats->samples_received = s_samples_received;
+    stats->frames_analyzed = s_frames_analyzed;
+    stats->frames_dropped = s_frames_dropped;
+    stats->dma_overruns = s_dma_overruns;
+    stats->dropped_samples = s_dropped_samples;
+    stats->invalid_samples = s_invalid_samples;
+}
+
+void adc_fft_get_gate_stats(adc_gate_stats_t *stats) {
+    gate_counters_t counters;
+    read_published(&gate_stats_lock, &counters, &gate_stats, sizeof(counters));
+    memset(stats, 0, sizeof(*stats));
+    stats->frames = counters.frames;
+    stats->silent = counters.silent;
+    stats->held = counters.held;
+    stats->analyzed = counters.analyzed;
+    stats->changes = counters.changes;
+    stats->interval = counters.interval;
+    if (stats->analyzed) {
+        stats->avg_analysis_cycles = (uint32_t)(counters.analysis_cycles / stats->analyzed);
+    }
+    if (stats->frames) {
+        stats->avg_gate_cycles = (uint32_t)(counters.check_cycles / stats->frames);
+        float full = (float)stats->avg_analysis_cycles * stats->frames;
+        float saved = (float)stats->avg_analysis_cycles * (stats->silent + stats->held) - (float)counters.check_cycles;
+        stats->cpu_saved = (full > 0.0f) ? saved / full : 0.0f;
+    }
+
+    // gehaltene Frames in Millisekunden (Abstand der Frames der aktiven Größe)
+    float frame_ms = counters.hop * 1000.0f / ANALYSIS_SAMPLE_RATE;
+    if (stats->changes) {
+        stats->avg_latency_ms = frame_ms * counters.latency_sum / stats->changes;
+    }
+    stats->max_latency_ms = frame_ms * counters.latency_max;
+}
+
+/**
+ * Wartet, bis die Ringpuffer (NUM_BUFFERS * FFT_SIZE Samples je Kanal) einmal komplett neu beschrieben wurden.
+ * Der ADC wird dabei nicht direkt gelesen, damit dem Analyse-Datenstrom keine Samples verloren gehen.
+ */
 void save_adc_data() {
     ESP_LOGI("ADC_FFT", "Saving ADC buffers...");
 
@@ -237,14 +1768,9 @@ void save_adc_data() {
     }
 
     if (xSemaphoreTake(adc_semaphore, pdMS_TO_TICKS(1000)) == pdTRUE) {
-        for (int i = 0; i < NUM_BUFFERS; i++) {
-            size_t bytes_read = 0;
-            ESP_ERROR_CHECK(adc_continuous_read(adc_handle,
-                                                (uint8_t *)collected_data[i],
-                                                sizeof(collected_data[i]),
-                                                (uint32_t *)&bytes_read,
-                                                portMAX_DELAY));
-            ESP_LOGI("ADC_FFT", "Buffer %d/%d saved", i + 1, NUM_BUFFERS);
+        uint32_t start = s_samples_received;
+        while ((uint32_t)(s_samples_received - start) < NUM_BUFFERS * FFT_SIZE * ADC_NUM_CHANNELS) {
+            vTaskDelay(pdMS_TO_TICKS(20));
         }
         xSemaphoreGive(adc_semaphore);
         ESP_LOGI("ADC_FFT", "All buffers saved.");
@@ -0,0 +1,58 @@
+#include "esp_log.h"
+#include "config.h"
+#include "arena.h"
+
+static const char *TAG = "ARENA";
+
+#define ARENA_ALIGN 8
+
+typedef struct {
+    const char *name;
+    uint8_t *base;
+    uint32_t size;
+    uint32_t used;
+    uint32_t peak;
+    uint32_t failures;
+} arena_t;
+
+static uint8_t s_http_mem[ARENA_HTTP_BUDGET] __attribute__((aligned(ARENA_ALIGN)));
+static uint8_t s_ws_mem[ARENA_WS_BUDGET] __attribute__((aligned(ARENA_ALIGN)));
+static uint8_t s_fft_mem[ARENA_FFT_BUDGET] __attribute__((aligned(16)));
+
+static arena_t s_arenas[ARENA_COUNT] = {
+    [ARENA_HTTP] = { "http", s_http_mem, sizeof(s_http_mem), 0, 0, 0 },
+    [ARENA_WS]   = { "ws",   s_ws_mem,   sizeof(s_ws_mem),   0, 0, 0 },
+    [ARENA_FFT]  = { "fft",  s_fft_mem,  sizeof(s_fft_mem),  0, 0, 0 },
+};
+
+void *arena_alloc(arena_id_t id, size_t size)
+{
+    arena_t *a = &s_arenas[id];
+    uint32_t offset = (a->used + ARENA_ALIGN - 1) & ~(uint32_t)(ARENA_ALIGN - 1);
+    if (size > a->size || offset > a->size - size) {
+        a->failures++;
+        ESP_LOGW(TAG, "Arena '%s' exhausted (%u of %u bytes used, %u requested)", a->name,
+                 (unsigned int)a->used, (unsigned int)a->size, (unsigned int)size);
+        return NULL;
+    }
+    a->used = offset + size;
+    if (a->used > a->peak) {
+        a->peak = a->used;
+    }
+    return a->base + offset;
+}
+
+void arena_reset(arena_id_t id)
+{
+    s_arenas[id].used = 0;
+}
+
+void arena_get_stats(arena_id_t id, arena_stats_t *stats)
+{
+    const arena_t *a = &s_arenas[id];
+    stats->name = a->name;
+    stats->size = a->size;
+    stats->used = a->used;
+    stats->peak = a->peak;
+    stats->failures = a->failures;
+}
@@ -0,0 +1,125 @@
+#include <stdbool.h>
+#include <math.h>
+#include "esp_dsp.h"
+#include "band_search.h"
+
+// Koeffizienten für Alpha-Max-plus-Beta-Min mit minimalem Maximalfehler
+#define AMBM_ALPHA 0.96043387f
+#define AMBM_BETA  0.39782473f
+
+void band_magnitudes(const float *spectrum, int n, band_metric_t metric, float *out, float *scratch)
+{
+    switch (metric) {
+    case BAND_METRIC_MAGNITUDE:
+        for (int i = 0; i < n; i++) {
+            float re = spectrum[i * 2];
+            float im = spectrum[i * 2 + 1];
+            out[i] = sqrtf(re * re + im * im);
+        }
+        break;
+    case BAND_METRIC_AMBM:
+        for (int i = 0; i < n; i++) {
+            float re = fabsf(spectrum[i * 2]);
+            float im = fabsf(spectrum[i * 2 + 1]);
+            float hi = (re > im) ? re : im;
+            float lo = (re > im) ? im : re;
+            out[i] = AMBM_ALPHA * hi + AMBM_BETA * lo;
+        }
+        break;
+    case BAND_METRIC_POWER:
+    case BAND_METRIC_MAGNITUDE_FAST:
+    default:
+        // re² und im² über die Schrittweite 2 direkt aus dem interleaved Spektrum
+        dsps_mul_f32(spectrum, spectrum, out, n, 2, 2, 1);
+        dsps_mul_f32(spectrum + 1, spectrum + 1, scratch, n, 2, 2, 1);
+        dsps_add_f32(out, scratch, out, n, 1, 1, 1);
+        if (metric == BAND_METRIC_MAGNITUDE_FAST) {
+            dsps_sqrt_f32(out, out, n);
+        }
+        break;
+    }
+}
+
+/*
+ * Ein Durchlauf der laufenden Summe: stärkstes Fenster der Breite w, das keines der bereits gewählten
+ * Fenster taken[0..num_taken-1] (aufsteigend nach start) überlappt. Gesperrt sind die Starts im
+ * Abstand < w zu einem gewählten Fenster; der Zeiger auf das nächste gewählte Fenster läuft mit, der
+ * Regelfall kostet also eine Addition und zwei Vergleiche. Liefert sum = 0, wenn kein Fenster mit
+ * sum > 0 übrig ist.
+ */
+static band_window_t best_free_window(const float *mag, int n, int w, const int *taken, int num_taken)
+{
+    band_window_t best = { .start = 0, .width = w, .sum = 0.0f };
+    float sum = 0.0f;
+    for (int i = 0; i < w - 1; i++) {
+        sum += mag[i];
+    }
+    int next = 0;
+    for (int start = 0; start <= n - w; start++) {
+        sum += mag[start + w - 1];
+        while (next < num_taken && taken[next] + w <= start) {
+            next++;
+        }
+        bool blocked = next < num_taken && start > taken[next] - w;
+        if (!blocked && sum > best.sum) {
+            best.start = start;
+            best.sum = sum;
+        }
+        sum -= mag[start];
+    }
+    return best;
+}
+
+void band_search(const float *mag, int n, const int *widths, int num_widths, int top_k,
+                 band_window_t *results)
+{
+    if (num_widths > BAND_SEARCH_MAX_WIDTHS) num_widths = BAND_SEARCH_MAX_WIDTHS;
+    if (top_k > BAND_SEARCH_MAX_TOP_K) top_k = BAND_SEARCH_MAX_TOP_K;
+    if (top_k < 1) return;
+
+    for (int j = 0; j < num_widths; j++) {
+        band_window_t *top = &results[j * top_k];
+        int w = widths[j];
+        if (w > n) w = n;
+        if (w < 1) w = 1;
+        for (int i = 0; i < top_k; i++) {
+            top[i] = (band_window_t){ .start = 0, .width = w, .sum = 0.0f };
+        }
+        if (n < w) {
+            continue;   // leeres Spektrum
+        }
+
+        // Gierige Auswahl: je Durchlauf das stärkste Fenster, das kein bereits gewähltes überlappt.
+        // Die Summen fallen damit von selbst absteigend an; top_k Durchläufe bleiben O(n) je Breite.
+        int taken[BAND_SEARCH_MAX_TOP_K];
+        for (int k = 0; k < top_k; k++) {
+            band_window_t found = best_free_window(mag, n, w, taken, k);
+            if (found.sum <= 0.0f) {
+                break;
+            }
+            top[k] = found;
+            int pos = k;
+            while (pos > 0 && taken[pos - 1] > found.start) {
+                taken[pos] = taken[pos - 1];
+                pos--;
+            }
+            taken[pos] = found.start;
+        }
+    }
+}
+
+band_window_t band_search_naive(const float *mag, int n, int width)
+{
+    band_window_t best = { .start = 0, .width = width, .sum = 0.0f };
+    for (int start = 0; start <= n - width; start++) {
+        float segment_sum = 0.0f;
+        for (int j = 0; j < width; j++) {
+            segment_sum += mag[start + j];
+        }
+        if (segment_sum > best.sum) {
+            best.sum = segment_sum;
+            best.start = start;
+        }
+    }
+    return best;
+}
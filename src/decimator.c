@@ -0,0 +1,98 @@
+#include <string.h>
+#include <math.h>
+#include "esp_log.h"
+#include "esp_heap_caps.h"
+#include "esp_dsp.h"
+#include "decimator.h"
+
+static const char *TAG = "DECIMATOR";
+
+static float *alloc_floats(int count)
+{
+    return (float *)heap_caps_aligned_alloc(16, count * sizeof(float), MALLOC_CAP_8BIT);
+}
+
+/*
+ * Tiefpass als gefensterter Sinc mit Hann-Fenster und Gleichanteilverstärkung 1.
+ */
+void decimator_design_lowpass(float *coeffs, int taps, float fc)
+{
+    float center = (taps - 1) / 2.0f;
+
+    dsps_wind_hann_f32(coeffs, taps);
+    float sum = 0.0f;
+    for (int i = 0; i < taps; i++) {
+        float x = i - center;
+        float sinc = (fabsf(x) < 1e-6f) ? 2.0f * fc : sinf(2.0f * M_PI * fc * x) / (M_PI * x);
+        coeffs[i] *= sinc;
+        sum += coeffs[i];
+    }
+    for (int i = 0; i < taps; i++) {
+        coeffs[i] /= sum;
+    }
+}
+
+esp_err_t decimator_init(decimator_t *dec, int factor, int taps, uint32_t max_in)
+{
+    memset(dec, 0, sizeof(*dec));
+    if (factor < 2 || taps < 4 || (taps % 4) != 0) {
+        ESP_LOGE(TAG, "Invalid decimator (factor %d, %d taps)", factor, taps);
+        return ESP_ERR_INVALID_ARG;
+    }
+    dec->factor = factor;
+    dec->max_in = max_in;
+    dec->coeffs = alloc_floats(taps);
+    dec->delay  = alloc_floats(taps);
+    dec->in     = alloc_floats(max_in + factor);
+    dec->out    = alloc_floats(max_in / factor + 1);
+    if (!dec->coeffs || !dec->delay || !dec->in || !dec->out) {
+        decimator_deinit(dec);
+        return ESP_ERR_NO_MEM;
+    }
+
+    // Grenzfrequenz = halbe Ausgangsabtastrate
+    decimator_design_lowpass(dec->coeffs, taps, 0.5f / factor);
+    esp_err_t ret = dsps_fird_init_f32(&dec->fir, dec->coeffs, dec->delay, taps, factor);
+    if (ret != ESP_OK) {
+        decimator_deinit(dec);
+        return ret;
+    }
+
+    ESP_LOGI(TAG, "Decimator ready (factor %d, %d taps)", factor, taps);
+    return ESP_OK;
+}
+
+void decimator_deinit(decimator_t *dec)
+{
+    heap_caps_free(dec->coeffs);
+    heap_caps_free(dec->delay);
+    heap_caps_free(dec->in);
+    heap_caps_free(dec->out);
+    memset(dec, 0, sizeof(*dec));
+}
+
+uint32_t decimator_process(decimator_t *dec, const int16_t *in, uint32_t n, int16_t *out)
+{
+    if (n > dec->max_in) {
+        n = dec->max_in;
+    }
+
+    // Neue Samples hinter den Rest des letzten Blocks hängen
+    float *buf = dec->in + dec->in_len;
+    for (uint32_t i = 0; i < n; i++) {
+        buf[i] = in[i];
+    }
+    uint32_t total = dec->in_len + n;
+    uint32_t out_len = total / dec->factor;
+    uint32_t used = out_len * dec->factor;
+
+    dsps_fird_f32(&dec->fir, dec->in, dec->out, out_len);
+    for (uint32_t i = 0; i < out_len; i++) {
+        out[i] = (int16_t)lrintf(dec->out[i]);
+    }
+
+    // Unvollständigen Dezimierungsschritt für den nächsten Aufruf aufheben (< factor Samples)
+    dec->in_len = total - used;
+    memmove(dec->in, dec->in + used, dec->in_len * sizeof(float));
+    return out_len;
+}
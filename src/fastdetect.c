@@ -2,91 +2,209 @@
 #include <string.h>
 #include <math.h>
 #include <sys/param.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
 #include "esp_log.h"
+#include "esp_timer.h"
+#include "esp_heap_caps.h"
 #include "config.h"
+#include "seqlock.h"
+#include "history.h"
 #include "fastdetect.h"
 
 static const char *TAG = "FASTDETECT";
 
 #define FREQ_STORAGE_SIZE 64
 
-static float s_freqStorage[FREQ_STORAGE_SIZE];
-static int s_freqWritePos = 0;
-static int s_freqCount = 0;
+/* Leseversuche, bevor ein Leser dem Schreiber die CPU überlässt */
+#define SEQLOCK_READ_TRIES 8
 
-/* Speichert eine Frequenzmessung im ringförmigen Puffer. */
-void store_frequency(float freq)
+/*
+ * Ergebnisse werden je Kanal über einen Seqlock veröffentlicht (ein Schreiber, beliebig viele Leser):
+ * die Messwerte vom DSP-Task (store_frequency), die Chunks von der Fastdetect-Task. Leser erhalten
+ * immer eine vollständige Momentaufnahme, der Schreiber wartet nie auf sie.
+ */
+
+_Static_assert(FASTDETECT_NUM_MEASUREMENTS >= 1 && FASTDETECT_NUM_MEASUREMENTS <= FREQ_STORAGE_SIZE / 2,
+               "invalid FASTDETECT_NUM_MEASUREMENTS");
+_Static_assert(FASTDETECT_JSON_CHUNKS >= 1 && FASTDETECT_JSON_CHUNKS <= NUM_CHUNKS, "invalid FASTDETECT_JSON_CHUNKS");
+
+/* Messwerte je Kanal; Frame n liegt an Position n % FREQ_STORAGE_SIZE */
+typedef struct {
+    float values[FREQ_STORAGE_SIZE];
+    float magnitudes[FREQ_STORAGE_SIZE];
+    int64_t time_us[FREQ_STORAGE_SIZE];   // Zeitpunkt der Messung (esp_timer_get_time)
+    uint32_t frames;                      // Nummer des nächsten Frames (= gespeicherte Messungen)
+} freq_store_t;
+static freq_store_t s_freqs[ADC_NUM_CHANNELS];
+static seqlock_t s_freq_locks[ADC_NUM_CHANNELS];
+
+/*
+ * Ringpuffer für die Trendanalyse (Chunks) je Kanal: Ein neuer Chunk überschreibt nur den ältesten
+ * Eintrag an head, die Kosten je Chunk hängen damit nicht von NUM_CHUNKS ab.
+ */
+typedef struct {
+    fastdetect_chunk_t entries[NUM_CHUNKS];
+    uint32_t head;    // Index des nächsten Eintrags (neuester Chunk bei head - 1)
+    uint32_t count;   // belegte Einträge (höchstens NUM_CHUNKS)
+} chunk_ring_t;
+static chunk_ring_t s_chunks[ADC_NUM_CHANNELS];
+static seqlock_t s_chunk_locks[ADC_NUM_CHANNELS];
+
+/* Chunk-Bildung: Task, nächster Frame je Kanal und wegen Rückstand übersprungene Frames */
+static TaskHandle_t s_task;
+static uint32_t s_next_frame[ADC_NUM_CHANNELS];
+static uint32_t s_skipped_frames[ADC_NUM_CHANNELS];
+
+#if ENABLE_HISTORY
+/* Verlauf je Kanal; store_frequency() schreibt erst, wenn init_fastdetect_task() ihn angelegt hat */
+static const uint32_t s_history_periods[] = HISTORY_PERIODS_S;
+static const int s_history_lengths[] = HISTORY_LENGTHS;
+#define HISTORY_TIERS ((int)(sizeof(s_history_periods) / sizeof(s_history_periods[0])))
+_Static_assert(HISTORY_TIERS == sizeof(s_history_lengths) / sizeof(s_history_lengths[0]),
+               "HISTORY_PERIODS_S and HISTORY_LENGTHS differ in length");
+static history_t s_history[ADC_NUM_CHANNELS];
+static bool s_history_ready;
+#endif
+
+/* Kopiert size Bytes ab src als konsistente Momentaufnahme nach dst. */
+static void read_snapshot(seqlock_t *lock, void *dst, const void *src, size_t size)
 {
-    s_freqStorage[s_freqWritePos] = freq;
-    s_freqWritePos = (s_freqWritePos + 1) % FREQ_STORAGE_SIZE;
-    if (s_freqCount < FREQ_STORAGE_SIZE)
+    while (!seqlock_read(lock, dst, src, size, SEQLOCK_READ_TRIES))
     {
-        s_freqCount++;
+        vTaskDelay(1);   // Schreiber auf demselben Kern unterbrochen: ihn zuerst fertig schreiben lassen
     }
 }
 
-/* Gibt die i-te zuletzt gespeicherte Frequenz zurück. */
-static float get_recent_freq(int i)
+/*
+ * Speichert eine Frequenzmessung eines Kanals im ringförmigen Puffer (ein Aufruf je Frame). Ist damit
+ * ein Chunk aus FASTDETECT_NUM_MEASUREMENTS Frames vollständig, wird die Fastdetect-Task geweckt.
+ */
+void store_frequency(int channel, float freq, float magnitude, bool voiced)
 {
-    if (i < 0 || i >= s_freqCount)
+    if (channel < 0 || channel >= ADC_NUM_CHANNELS)
     {
-        return 0.0f;
+        return;
     }
-    int idx = s_freqWritePos - 1 - i;
-    if (idx < 0)
+    freq_store_t *store = &s_freqs[channel];
+    uint32_t frame = store->frames;
+    int64_t now = esp_timer_get_time();
+    seqlock_write_begin(&s_freq_locks[channel]);
+    store->values[frame % FREQ_STORAGE_SIZE] = freq;
+    store->magnitudes[frame % FREQ_STORAGE_SIZE] = magnitude;
+    store->time_us[frame % FREQ_STORAGE_SIZE] = now;
+    store->frames = frame + 1;
+    seqlock_write_end(&s_freq_locks[channel]);
+
+    #if ENABLE_HISTORY
+        if (__atomic_load_n(&s_history_ready, __ATOMIC_ACQUIRE))
+        {
+            history_add(&s_history[channel], now, freq, magnitude, voiced);
+        }
+    #endif
+
+    if ((frame + 1) % FASTDETECT_NUM_MEASUREMENTS == 0 && s_task)
     {
-        idx += FREQ_STORAGE_SIZE;
+        xTaskNotifyGive(s_task);
     }
-    return s_freqStorage[idx];
 }
 
-/* Ringpuffer für die Trendanalyse (Chunks). */
-static float s_chunkFreq[NUM_CHUNKS];
-static char s_chunkTrend[NUM_CHUNKS][8]; // "rise", "fall" oder "same"
-
 /* Vergleicht den neuen Wert mit dem alten und gibt den Trend zurück. */
-static const char* get_trend_str(float newVal, float oldVal)
+static fastdetect_trend_t get_trend(float newVal, float oldVal)
 {
     float diff = newVal - oldVal;
     if (fabsf(diff) < 0.001f)
     {
-        return "same";
+        return FASTDETECT_TREND_SAME;
+    }
+    return (diff > 0) ? FASTDETECT_TREND_RISE : FASTDETECT_TREND_FALL;
+}
+
+static const char *trend_str(uint8_t trend)
+{
+    static const char *const names[] = { "same", "rise", "fall" };
+    return (trend < sizeof(names) / sizeof(names[0])) ? names[trend] : "same";
+}
+
+/*
+ * Kopiert die neuesten (höchstens max) Chunks eines Kanals, neuester zuerst. Kopiert werden nur
+ * diese Einträge, nicht der ganze Ring; bei einer Kollision mit der Fastdetect-Task wird wiederholt.
+ */
+int fastdetect_read_chunks(int channel, fastdetect_chunk_t *dst, int max)
+{
+    if (channel < 0 || channel >= ADC_NUM_CHANNELS || max <= 0)
+    {
+        return 0;
+    }
+    const chunk_ring_t *ring = &s_chunks[channel];
+    seqlock_t *lock = &s_chunk_locks[channel];
+    for (int tries = 0; ; tries++)
+    {
+        if (tries == SEQLOCK_READ_TRIES)
+        {
+            vTaskDelay(1);   // Schreiber auf demselben Kern unterbrochen: ihn zuerst fertig schreiben lassen
+            tries = 0;
+        }
+        uint32_t start = seqlock_read_begin(lock);
+        uint32_t head = ring->head;
+        uint32_t count = ring->count;
+        int n = (count < (uint32_t)max) ? (int)count : max;
+        if (head >= NUM_CHUNKS || n > NUM_CHUNKS)
+        {
+            continue;   // kann nur eine zerrissene Momentaufnahme sein
+        }
+        for (int i = 0; i < n; i++)
+        {
+            dst[i] = ring->entries[(head + NUM_CHUNKS - 1 - i) % NUM_CHUNKS];
+        }
+        if (!seqlock_read_retry(lock, start))
+        {
+            return n;
+        }
     }
-    return (diff > 0) ? "rise" : "fall";
 }
 
 /**
- * Baut einen JSON-String, der die gespeicherten Chunks enthält.
- * Ausgabeformat: {"chunks":[{"freq":<Wert>,"trend":"<Wert>"}, ...]}
+ * Baut einen JSON-String mit den neuesten FASTDETECT_JSON_CHUNKS Chunks eines Kanals (neuester zuerst).
+ * Ausgabeformat: {"channel":<Kanal>,"skipped":<übersprungene Frames>,
+ *                 "chunks":[{"freq":<Wert>,"trend":"<Wert>","frame":<letzter Frame>,"t":<ms>,"mag":<Wert>}, ...]}
  */
-void build_chunk_json(char *outbuf, size_t outsize)
+void build_chunk_json(int channel, char *outbuf, size_t outsize)
 {
-    int written = snprintf(outbuf, outsize, "{\"chunks\":[");
+    if (channel < 0 || channel >= ADC_NUM_CHANNELS)
+    {
+        channel = 0;
+    }
+    int written = snprintf(outbuf, outsize, "{\"channel\":%d,\"skipped\":%u,\"chunks\":[", channel,
+                           (unsigned int)s_skipped_frames[channel]);
     if (written < 0 || written >= outsize)
     {
         ESP_LOGE(TAG, "JSON buffer zu klein am Anfang.");
         return;
     }
+    fastdetect_chunk_t chunks[FASTDETECT_JSON_CHUNKS];
+    int n = fastdetect_read_chunks(channel, chunks, FASTDETECT_JSON_CHUNKS);
+
     size_t offset = written;
-    for (int i = 0; i < NUM_CHUNKS; i++)
-    {
-        float freq = s_chunkFreq[i];
-        const char *trend = s_chunkTrend[i];
-        char entry[64];
-        int entry_len = snprintf(entry, sizeof(entry),
-                                 "{\"freq\":%.2f,\"trend\":\"%s\"}%s",
-                                 freq, trend, (i < NUM_CHUNKS - 1) ? "," : "");
-        if (entry_len < 0 || (offset + entry_len) >= outsize - 2)
+    for (int i = 0; i < n; i++)
+    {
+        // 2 Bytes bleiben für "]}" frei
+        int entry_len = snprintf(outbuf + offset, outsize - offset - 2,
+                                 "%s{\"freq\":%.2f,\"trend\":\"%s\",\"frame\":%u,\"t\":%u,\"mag\":%.1f}",
+                                 (i > 0) ? "," : "", chunks[i].freq, trend_str(chunks[i].trend),
+                                 (unsigned int)chunks[i].frame, (unsigned int)chunks[i].time_ms,
+                                 chunks[i].magnitude);
+        if (entry_len < 0 || offset + entry_len >= outsize - 2)
         {
+            outbuf[offset] = '\0';   // angefangenen Eintrag verwerfen
             ESP_LOGE(TAG, "JSON buffer zu klein beim Hinzufügen der Chunks.");
             break;
         }
-        strcat(outbuf, entry);
         offset += entry_len;
     }
     if ((offset + 2) < outsize)
     {
-        strcat(outbuf, "]}");
+        memcpy(outbuf + offset, "]}", 3);
     }
     else
     {
@@ -95,77 +213,151 @@ void build_chunk_json(char *outbuf, size_t outsize)
 }
 
 /**
- * Fastdetect Task:
- * - Alle 100 ms werden die neuesten 3 Frequenzmessungen verarbeitet.
- * - Wenn FASTDETECT_ENABLE_PARABOLIC_INTERP aktiviert ist, wird eine parabolische Interpolation durchgeführt,
- *   ansonsten wird der Mittelwert der 3 Messungen genommen.
- * - Der Chunk-Ring wird verschoben, und der neue Chunk wird an Index 0 abgelegt.
+ * Legt einen Chunk aus den Frames first..first+FASTDETECT_NUM_MEASUREMENTS-1 eines Kanals an:
+ * - Wenn FASTDETECT_ENABLE_PARABOLIC_INTERP aktiviert ist und der Chunk 3 Frames umfasst, wird eine
+ *   parabolische Interpolation durchgeführt, ansonsten wird der Mittelwert der Messungen genommen.
+ * - Der neue Chunk wird mit Nummer und Zeitpunkt seines letzten Frames an head geschrieben und
+ *   überschreibt dort den ältesten Eintrag; danach rückt head weiter, es wird nichts verschoben.
  */
-static void fast_detect_task(void *arg)
+static void add_chunk(int channel, const freq_store_t *store, uint32_t first)
 {
     int i;
-    /* Initialisiere den Chunk-Ring */
-    for (i = 0; i < NUM_CHUNKS; i++)
+    // measurements[0] ist der neueste Frame des Chunks
+    float measurements[FASTDETECT_NUM_MEASUREMENTS];
+    float magnitude = 0.0f;
+    uint32_t last = first + FASTDETECT_NUM_MEASUREMENTS - 1;
+    for (i = 0; i < FASTDETECT_NUM_MEASUREMENTS; i++)
     {
-        s_chunkFreq[i] = 0.0f;
-        strcpy(s_chunkTrend[i], "same");
+        measurements[i] = store->values[(last - i) % FREQ_STORAGE_SIZE];
+        magnitude += store->magnitudes[(last - i) % FREQ_STORAGE_SIZE];
     }
+
+    float refined = 0.0f;
+    #if FASTDETECT_ENABLE_PARABOLIC_INTERP && FASTDETECT_NUM_MEASUREMENTS == 3
+        // Parabolische Interpolation:
+        // Annahme: measurements[2] = f(-1), measurements[1] = f(0), measurements[0] = f(1)
+        float f_left  = measurements[2];
+        float f_mid   = measurements[1];
+        float f_right = measurements[0];
+        float denom = f_left - 2.0f * f_mid + f_right;
+        float d = 0.0f;
+        if (fabs(denom) > 1e-6)
+        {
+            d = 0.5f * (f_left - f_right) / denom;
+        }
+        refined = f_mid + d;
+    #else
+        // Fallback: Mittelwertbildung
+        float sum = 0.0f;
+        for (i = 0; i < FASTDETECT_NUM_MEASUREMENTS; i++)
+        {
+            sum += measurements[i];
+        }
+        refined = sum / FASTDETECT_NUM_MEASUREMENTS;
+    #endif
+
+    /* Neuen Chunk an head ablegen (überschreibt den ältesten), Trend gegenüber dem vorigen Chunk */
+    chunk_ring_t *chunks = &s_chunks[channel];
+    uint32_t head = chunks->head;
+    float oldVal = (chunks->count > 0) ? chunks->entries[(head + NUM_CHUNKS - 1) % NUM_CHUNKS].freq : 0.0f;
+    fastdetect_chunk_t chunk = {
+        .freq = refined,
+        .magnitude = magnitude / FASTDETECT_NUM_MEASUREMENTS,
+        .frame = last,
+        .time_ms = (uint32_t)(store->time_us[last % FREQ_STORAGE_SIZE] / 1000),
+        .trend = get_trend(refined, oldVal),
+    };
+    seqlock_write_begin(&s_chunk_locks[channel]);
+    chunks->entries[head] = chunk;
+    chunks->head = (head + 1 < NUM_CHUNKS) ? head + 1 : 0;
+    if (chunks->count < NUM_CHUNKS)
+    {
+        chunks->count++;
+    }
+    seqlock_write_end(&s_chunk_locks[channel]);
+    #if ENABLE_FASTDETECT_LOGS
+        ESP_LOGI(TAG, "CH%d: Chunk=%.2f (frame %u) => %s vs %.2f", channel, refined, (unsigned int)last,
+                 trend_str(chunk.trend), oldVal);
+    #endif
+}
+
+/**
+ * Bildet alle vollständigen Chunks eines Kanals seit dem letzten Aufruf. Liegt die Task so weit
+ * zurück, dass Frames bereits überschrieben wurden, geht es mit dem ältesten vollständigen Chunk weiter.
+ */
+static void update_chunks(int channel)
+{
+    freq_store_t store;
+    read_snapshot(&s_freq_locks[channel], &store, &s_freqs[channel], sizeof(store));
+
+    uint32_t next = s_next_frame[channel];
+    if (store.frames - next > FREQ_STORAGE_SIZE)
+    {
+        uint32_t oldest = store.frames - FREQ_STORAGE_SIZE;
+        oldest += (FASTDETECT_NUM_MEASUREMENTS - oldest % FASTDETECT_NUM_MEASUREMENTS) % FASTDETECT_NUM_MEASUREMENTS;
+        s_skipped_frames[channel] += oldest - next;
+        ESP_LOGW(TAG, "CH%d: %u frames skipped (fastdetect task behind)", channel, (unsigned int)(oldest - next));
+        next = oldest;
+    }
+    while (store.frames - next >= FASTDETECT_NUM_MEASUREMENTS)
+    {
+        add_chunk(channel, &store, next);
+        next += FASTDETECT_NUM_MEASUREMENTS;
+    }
+    s_next_frame[channel] = next;
+}
+
+/**
+ * Fastdetect Task: Wartet auf die Benachrichtigung aus store_frequency() und bildet dann die neuen
+ * Chunks aller Kanäle (ohne Leerlauf-Wecken, höchstens einen Frame nach dem letzten Frame des Chunks).
+ */
+static void fast_detect_task(void *arg)
+{
     while (1)
     {
-        vTaskDelay(pdMS_TO_TICKS(100));
-        
-        float measurements[FASTDETECT_NUM_MEASUREMENTS];
-        int count = 0;
-        for (i = 0; i < FASTDETECT_NUM_MEASUREMENTS; i++)
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        for (int ch = 0; ch < ADC_NUM_CHANNELS; ch++)
         {
-            float f = get_recent_freq(i);
-            measurements[i] = f;
-            if (f != 0.0f)
-            {
-                count++;
-            }
+            update_chunks(ch);
         }
-        if (count < FASTDETECT_NUM_MEASUREMENTS)
+    }
+}
+
+/* Liefert Stufenanzahl, Intervalllänge, Länge und aktuelle Intervallnummer einer Verlaufsstufe. */
+esp_err_t fastdetect_get_history_info(int channel, int tier, fastdetect_history_info_t *info)
+{
+    #if ENABLE_HISTORY
+        if (channel < 0 || channel >= ADC_NUM_CHANNELS || tier < 0 || tier >= HISTORY_TIERS)
         {
-            ESP_LOGI(TAG, "Nicht genügend Frequenzdaten, Chunk-Aktualisierung übersprungen...");
-            continue;
+            return ESP_ERR_INVALID_ARG;
         }
-        
-        float refined = 0.0f;
-        #if FASTDETECT_ENABLE_PARABOLIC_INTERP
-            // Parabolische Interpolation:
-            // Annahme: measurements[2] = f(-1), measurements[1] = f(0), measurements[0] = f(1)
-            float f_left  = measurements[2];
-            float f_mid   = measurements[1];
-            float f_right = measurements[0];
-            float denom = f_left - 2.0f * f_mid + f_right;
-            float d = 0.0f;
-            if (fabs(denom) > 1e-6)
-            {
-                d = 0.5f * (f_left - f_right) / denom;
-            }
-            refined = f_mid + d;
-        #else
-            // Fallback: Mittelwertbildung
-            float sum = 0.0f;
-            for (i = 0; i < FASTDETECT_NUM_MEASUREMENTS; i++)
-            {
-                sum += measurements[i];
-            }
-            refined = sum / FASTDETECT_NUM_MEASUREMENTS;
-        #endif
+        if (!__atomic_load_n(&s_history_ready, __ATOMIC_ACQUIRE))
+        {
+            return ESP_ERR_INVALID_STATE;
+        }
+        info->tiers = HISTORY_TIERS;
+        info->period_s = s_history_periods[tier];
+        info->length = s_history_lengths[tier];
+        info->head = history_head(&s_history[channel], tier);
+        return ESP_OK;
+    #else
+        return ESP_ERR_INVALID_STATE;
+    #endif
+}
 
-        /* Verschiebe den Chunk-Ring: Ältere Chunks rutschen weiter */
-        for (i = NUM_CHUNKS - 1; i > 0; i--)
+/* Kopiert count Intervalle ab Nummer from; ohne Verlauf werden sie als ungültig markiert. */
+void fastdetect_read_history(int channel, int tier, uint32_t from, int count, history_bucket_t *out)
+{
+    #if ENABLE_HISTORY
+        if (channel >= 0 && channel < ADC_NUM_CHANNELS && __atomic_load_n(&s_history_ready, __ATOMIC_ACQUIRE))
         {
-            s_chunkFreq[i] = s_chunkFreq[i - 1];
-            strcpy(s_chunkTrend[i], s_chunkTrend[i - 1]);
+            history_read(&s_history[channel], tier, from, count, out);
+            return;
         }
-        float oldVal = s_chunkFreq[1];
-        s_chunkFreq[0] = refined;
-        const char* trend = get_trend_str(refined, oldVal);
-        strcpy(s_chunkTrend[0], trend);
-        ESP_LOGI(TAG, "Chunk=%.2f => %s vs %.2f", refined, trend, oldVal);
+    #endif
+    for (int i = 0; i < count; i++)
+    {
+        out[i].seq = HISTORY_SEQ_INVALID;
     }
 }
 
@@ -174,5 +366,35 @@ static void fast_detect_task(void *arg)
  */
 void init_fastdetect_task(void)
 {
-    xTaskCreate(fast_detect_task, "fast_detect_task", 4096, NULL, 5, NULL);
+    #if ENABLE_HISTORY
+        /* Verlauf anlegen, bevor store_frequency() (DSP-Task läuft bereits) hineinschreibt */
+        bool history_ok = true;
+        for (int ch = 0; ch < ADC_NUM_CHANNELS && history_ok; ch++)
+        {
+            history_ok = history_init(&s_history[ch], s_history_periods, s_history_lengths, HISTORY_TIERS) == ESP_OK;
+        }
+        if (history_ok)
+        {
+            __atomic_store_n(&s_history_ready, true, __ATOMIC_RELEASE);
+            ESP_LOGI(TAG, "History: %u bytes internal heap free", (unsigned int)heap_caps_get_free_size(MALLOC_CAP_INTERNAL));
+        }
+        else
+        {
+            ESP_LOGE(TAG, "History disabled (out of memory)");
+            for (int ch = 0; ch < ADC_NUM_CHANNELS; ch++)
+            {
+                history_deinit(&s_history[ch]);
+            }
+        }
+    #endif
+
+    /* Chunk-Ringe beginnen leer (der Webserver kann bereits lesen; Seqlocks starten genullt) */
+    for (int ch = 0; ch < ADC_NUM_CHANNELS; ch++)
+    {
+        seqlock_write_begin(&s_chunk_locks[ch]);
+        s_chunks[ch].head = 0;
+        s_chunks[ch].count = 0;
+        seqlock_write_end(&s_chunk_locks[ch]);
+    }
+    xTaskCreate(fast_detect_task, "fast_detect_task", 4096, NULL, 5, &s_task);
 }
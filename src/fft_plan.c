@@ -0,0 +1,282 @@
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include "esp_log.h"
+#include "esp_heap_caps.h"
+#include "esp_dsp.h"
+#include "fft_plan.h"
+
+static const char *TAG = "FFT_PLAN";
+
+// FFT-Kernel mit den Tabellen des Plans (statt der globalen esp-dsp Tabellen).
+// Auswahl der Implementierung analog zu dsps_fft2r.h / dsps_fft4r.h.
+#if CONFIG_DSP_OPTIMIZED && (dsps_fft2r_fc32_aes3_enabled == 1)
+#define fft_plan_fft2r(data, N, w) dsps_fft2r_fc32_aes3_(data, N, w)
+#elif CONFIG_DSP_OPTIMIZED && (dsps_fft2r_fc32_ae32_enabled == 1)
+#define fft_plan_fft2r(data, N, w) dsps_fft2r_fc32_ae32_(data, N, w)
+#else
+#define fft_plan_fft2r(data, N, w) dsps_fft2r_fc32_ansi_(data, N, w)
+#endif
+
+#if CONFIG_DSP_OPTIMIZED && (dsps_fft4r_fc32_ae32_enabled == 1)
+#define fft_plan_fft4r(data, N, w, size) dsps_fft4r_fc32_ae32_(data, N, w, size)
+#else
+#define fft_plan_fft4r(data, N, w, size) dsps_fft4r_fc32_ansi_(data, N, w, size)
+#endif
+
+#if CONFIG_DSP_OPTIMIZED && (dsps_cplx2real_fc32_ae32_enabled == 1)
+#define fft_plan_cplx2real(data, N, w, size) dsps_cplx2real_fc32_ae32_(data, N, w, size)
+#else
+#define fft_plan_cplx2real(data, N, w, size) dsps_cplx2real_fc32_ansi_(data, N, w, size)
+#endif
+
+/*
+ * Die ANSI-Kernel von esp-dsp prüfen nur dsps_fft2r_initialized bzw. dsps_fft4r_initialized, die
+ * Tabellen kommen aus dem Plan. Gesetzt werden daher nur diese Flags, die globalen Tabellen bleiben
+ * leer (NULL): kein Plan besitzt sie und die Plangröße ist nicht an CONFIG_DSP_MAX_FFT_SIZE gebunden.
+ * Die globalen Einstiege (dsps_fft2r_fc32, dsps_fft4r_fc32, dsps_cplx2real_fc32, dsps_fft*r_init/deinit)
+ * sind damit in dieser Firmware tabu, siehe fft_plan.h: ein Aufruf greift auf NULL zu statt still
+ * hinter eine zu kleine Tabelle. Eine globale Initialisierung vor dem ersten Plan lässt dessen Aufbau
+ * scheitern, danach ist sie wirkungslos (esp-dsp sieht das Flag).
+ */
+static esp_err_t set_dsp_flags(void)
+{
+    if (dsps_fft_w_table_fc32 != NULL || dsps_fft4r_w_table_fc32 != NULL) {
+        ESP_LOGE(TAG, "Global esp-dsp FFT tables in use (dsps_fft*r_init_fc32 must not be called)");
+        return ESP_ERR_INVALID_STATE;
+    }
+    dsps_fft2r_initialized = 1;
+    dsps_fft4r_initialized = 1;
+    return ESP_OK;
+}
+
+static float *alloc_floats(int count)
+{
+    return (float *)heap_caps_aligned_alloc(16, count * sizeof(float), MALLOC_CAP_8BIT);
+}
+
+static esp_err_t copy_bitrev_table(fft_plan_t *plan, uint16_t *src, int pairs)
+{
+    plan->bitrev_size = pairs;
+    plan->bitrev_table = (uint16_t *)heap_caps_malloc(2 * pairs * sizeof(uint16_t), MALLOC_CAP_8BIT);
+    if (!plan->bitrev_table) {
+        return ESP_ERR_NO_MEM;
+    }
+    memcpy(plan->bitrev_table, src, 2 * pairs * sizeof(uint16_t));
+    return ESP_OK;
+}
+
+// Radix-2-Tabellen (Twiddle + Bitumkehr) für eine komplexe FFT mit n Punkten.
+static esp_err_t init_fft2r(fft_plan_t *plan, int n)
+{
+    plan->twiddle = alloc_floats(n);
+    if (!plan->twiddle) {
+        return ESP_ERR_NO_MEM;
+    }
+    dsps_gen_w_r2_fc32(plan->twiddle, n);
+    dsps_bit_rev_fc32_ansi(plan->twiddle, n >> 1);
+
+    // esp-dsp liefert Bitumkehr-Tabellen für 16..4096 Punkte
+    int pow = dsp_power_of_two(n);
+    if (pow >= 4 && pow <= 12) {
+        return copy_bitrev_table(plan, dsps_fft2r_rev_tables_fc32[pow - 4],
+                                 dsps_fft2r_rev_tables_fc32_size[pow - 4]);
+    }
+    return ESP_OK;
+}
+
+// Tabellen für den Real-Pfad: m = fft_size/2 komplexe Punkte.
+static esp_err_t init_real(fft_plan_t *plan, int m)
+{
+    int pow = dsp_power_of_two(m);
+    plan->use_fft4r = (pow & 1) == 0;
+    plan->twiddle4r_size = m * 2;
+
+    plan->twiddle4r = alloc_floats(m * 4);
+    if (!plan->twiddle4r) {
+        return ESP_ERR_NO_MEM;
+    }
+    for (int i = 0; i < plan->twiddle4r_size; i++) {
+        float angle = 2 * M_PI * i / (float)plan->twiddle4r_size;
+        plan->twiddle4r[2 * i + 0] = cosf(angle);
+        plan->twiddle4r[2 * i + 1] = sinf(angle);
+    }
+
+    if (!plan->use_fft4r) {
+        // m ist keine Viererpotenz (z. B. 512): Radix-2 für die komplexe Teil-FFT
+        return init_fft2r(plan, m);
+    }
+    if (pow >= 4 && pow <= 12) {
+        int idx = (pow >> 1) - 2;
+        return copy_bitrev_table(plan, dsps_fft4r_rev_tables_fc32[idx],
+                                 dsps_fft4r_rev_tables_fc32_size[idx]);
+    }
+    return ESP_OK;
+}
+
+/**
+ * Baut den FFT-Plan auf: Twiddle-Faktoren, Bitumkehr-Tabelle und (own_buffers) Hann-Fenster und
+ * Arbeitspuffer werden genau einmal berechnet bzw. allokiert.
+ */
+static esp_err_t init_plan(fft_plan_t *plan, int fft_size, fft_plan_mode_t mode, bool own_buffers)
+{
+    memset(plan, 0, sizeof(*plan));
+    if (!dsp_is_power_of_two(fft_size) || fft_size < 32 || fft_size > FFT_PLAN_MAX_SIZE) {
+        ESP_LOGE(TAG, "Invalid FFT size %d (max %d)", fft_size, FFT_PLAN_MAX_SIZE);
+        return ESP_ERR_INVALID_ARG;
+    }
+    plan->fft_size = fft_size;
+    plan->mode = mode;
+    plan->owns_buffers = own_buffers;
+
+    if (own_buffers) {
+        plan->window     = alloc_floats(fft_size);
+        plan->fft_input  = alloc_floats(fft_plan_input_floats(fft_size, mode));
+        plan->magnitudes = alloc_floats(fft_plan_magnitude_floats(fft_size, mode));
+    }
+    esp_err_t ret = ESP_ERR_NO_MEM;
+    if (!own_buffers || (plan->window && plan->fft_input && plan->magnitudes)) {
+        ret = set_dsp_flags();
+    }
+    if (ret == ESP_OK) {
+        ret = (mode == FFT_PLAN_REAL) ? init_real(plan, fft_size / 2) : init_fft2r(plan, fft_size);
+    }
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "FFT plan setup failed (N=%d): %s", fft_size, esp_err_to_name(ret));
+        fft_plan_deinit(plan);
+        return ret;
+    }
+
+    if (own_buffers) {
+        dsps_wind_hann_f32(plan->window, fft_size);
+        if (mode == FFT_PLAN_REAL) {
+            // dsps_cplx2reC_fc32 im komplexen Pfad liefert 2*X[k]; gleiche Skalierung hier über das Fenster
+            dsps_mulc_f32(plan->window, plan->window, fft_size, 2.0f, 1, 1);
+        }
+    }
+
+    ESP_LOGI(TAG, "FFT plan ready (N=%d, %s)", fft_size,
+             mode == FFT_PLAN_REAL ? (plan->use_fft4r ? "real/radix-4" : "real/radix-2") :
+             mode == FFT_PLAN_IQ ? "I/Q" : "complex");
+    return ESP_OK;
+}
+
+esp_err_t fft_plan_init(fft_plan_t *plan, int fft_size, fft_plan_mode_t mode)
+{
+    return init_plan(plan, fft_size, mode, true);
+}
+
+esp_err_t fft_plan_init_tables(fft_plan_t *plan, int fft_size, fft_plan_mode_t mode)
+{
+    return init_plan(plan, fft_size, mode, false);
+}
+
+void fft_plan_deinit(fft_plan_t *plan)
+{
+    heap_caps_free(plan->twiddle);
+    heap_caps_free(plan->twiddle4r);
+    heap_caps_free(plan->bitrev_table);
+    heap_caps_free(plan->window);
+    if (plan->owns_buffers) {
+        heap_caps_free(plan->fft_input);
+        heap_caps_free(plan->magnitudes);
+    }
+    memset(plan, 0, sizeof(*plan));
+}
+
+esp_err_t fft_plan_cache_get(fft_plan_cache_t *cache, int fft_size, fft_plan_mode_t mode,
+                             const fft_plan_t *keep, fft_plan_t **out)
+{
+    cache->clock++;
+    int slot = -1;
+    for (int i = 0; i < FFT_PLAN_CACHE_SLOTS; i++) {
+        fft_plan_t *plan = &cache->plans[i];
+        if (plan->fft_size == fft_size && plan->mode == mode) {
+            cache->last_used[i] = cache->clock;
+            cache->hits++;
+            *out = plan;
+            return ESP_OK;
+        }
+        // freier Platz, sonst der am längsten nicht benutzte (außer keep)
+        if (plan != keep && (slot < 0 || (cache->plans[slot].fft_size != 0 &&
+                             (plan->fft_size == 0 || cache->last_used[i] < cache->last_used[slot])))) {
+            slot = i;
+        }
+    }
+    cache->misses++;
+    if (slot < 0) {
+        return ESP_ERR_NO_MEM;
+    }
+
+    // Neuen Plan zuerst ohne Verdrängung aufbauen; reicht der Speicher nicht, den Platz freigeben
+    fft_plan_t plan;
+    esp_err_t ret = fft_plan_init_tables(&plan, fft_size, mode);
+    if (ret == ESP_ERR_NO_MEM && cache->plans[slot].fft_size != 0) {
+        fft_plan_deinit(&cache->plans[slot]);
+        ret = fft_plan_init_tables(&plan, fft_size, mode);
+    }
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    if (cache->plans[slot].fft_size != 0) {
+        ESP_LOGI(TAG, "Plan cache: N=%d replaces N=%d", fft_size, cache->plans[slot].fft_size);
+        fft_plan_deinit(&cache->plans[slot]);
+    }
+    cache->plans[slot] = plan;
+    cache->last_used[slot] = cache->clock;
+    *out = &cache->plans[slot];
+    return ESP_OK;
+}
+
+int fft_plan_cache_count(const fft_plan_cache_t *cache)
+{
+    int n = 0;
+    for (int i = 0; i < FFT_PLAN_CACHE_SLOTS; i++) {
+        n += (cache->plans[i].fft_size != 0);
+    }
+    return n;
+}
+
+void fft_plan_cache_deinit(fft_plan_cache_t *cache)
+{
+    for (int i = 0; i < FFT_PLAN_CACHE_SLOTS; i++) {
+        if (cache->plans[i].fft_size != 0) {
+            fft_plan_deinit(&cache->plans[i]);
+        }
+    }
+    memset(cache, 0, sizeof(*cache));
+}
+
+void fft_plan_execute(const fft_plan_t *plan)
+{
+    float *data = plan->fft_input;
+
+    if (plan->mode == FFT_PLAN_REAL) {
+        int m = plan->fft_size / 2;
+        if (plan->use_fft4r) {
+            fft_plan_fft4r(data, m, plan->twiddle4r, plan->twiddle4r_size);
+        } else {
+            fft_plan_fft2r(data, m, plan->twiddle);
+        }
+        if (plan->bitrev_table != NULL) {
+            dsps_bit_rev_lookup_fc32(data, plan->bitrev_size, plan->bitrev_table);
+        } else if (plan->use_fft4r) {
+            dsps_bit_rev4r_direct_fc32_ansi(data, m);
+        } else {
+            dsps_bit_rev_fc32(data, m);
+        }
+        fft_plan_cplx2real(data, m, plan->twiddle4r, plan->twiddle4r_size);
+        return;
+    }
+
+    int N = plan->fft_size;
+    fft_plan_fft2r(data, N, plan->twiddle);
+    if (plan->bitrev_table != NULL) {
+        dsps_bit_rev_lookup_fc32(data, plan->bitrev_size, plan->bitrev_table);
+    } else {
+        dsps_bit_rev_fc32(data, N);
+    }
+    if (plan->mode == FFT_PLAN_COMPLEX) {
+        dsps_cplx2reC_fc32(data, N);
+    }
+}
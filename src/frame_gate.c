@@ -0,0 +1,91 @@
+#include <string.h>
+#include <math.h>
+#include "frame_gate.h"
+
+// Samples je Teilsumme: 128 * 4095² passt noch in uint32_t, erst die Teilsummen laufen über 64 Bit
+#define ENERGY_BLOCK 128
+
+float frame_gate_energy_s16(const int16_t *x, int len)
+{
+    // Abstand zum ersten Sample statt zum Mittelwert (ein Durchlauf), Korrektur über die Summe
+    int32_t pivot = x[0];
+    int32_t sum = 0;
+    uint64_t sum_sq = 0;
+    for (int start = 0; start < len; start += ENERGY_BLOCK) {
+        int end = (start + ENERGY_BLOCK < len) ? start + ENERGY_BLOCK : len;
+        uint32_t block_sq = 0;
+        for (int i = start; i < end; i++) {
+            int32_t d = x[i] - pivot;
+            sum += d;
+            block_sq += (uint32_t)(d * d);
+        }
+        sum_sq += block_sq;
+    }
+    float energy = (float)sum_sq - (float)sum * (float)sum / len;
+    return (energy > 0.0f) ? energy : 0.0f;
+}
+
+void frame_gate_init(frame_gate_t *gate, int max_interval, float freq_tol, float level_tol)
+{
+    memset(gate, 0, sizeof(*gate));
+    gate->max_interval = (max_interval > 1) ? max_interval : 1;
+    gate->freq_tol = freq_tol;
+    gate->level_tol = level_tol;
+    gate->interval = 1;
+}
+
+void frame_gate_reset(frame_gate_t *gate)
+{
+    gate->interval = 1;
+    gate->held = 0;
+    gate->valid = false;
+}
+
+static inline bool within(float value, float ref, float tol)
+{
+    return fabsf(value - ref) <= tol * ref;
+}
+
+frame_gate_action_t frame_gate_check(frame_gate_t *gate, float energy, float silence_energy)
+{
+    gate->frames++;
+    if (energy < silence_energy && gate->held == 0) {
+        // leise: kein Ergebnis zu halten, der nächste laute Frame wird sofort ausgewertet
+        gate->silent++;
+        gate->interval = 1;
+        gate->valid = false;
+        return FRAME_GATE_SILENT;
+    }
+    if (gate->valid && gate->held + 1 < gate->interval && within(energy, gate->ref_energy, gate->level_tol)) {
+        gate->held++;
+        gate->holds++;
+        return FRAME_GATE_HOLD;
+    }
+    gate->analyzed++;
+    return FRAME_GATE_ANALYZE;
+}
+
+void frame_gate_update(frame_gate_t *gate, float energy, bool quiet, float frequency, float level)
+{
+    bool same = gate->valid && quiet == gate->ref_quiet &&
+                (quiet || (fabsf(frequency - gate->ref_frequency) <= gate->freq_tol &&
+                           within(level, gate->ref_level, gate->level_tol)));
+    if (same) {
+        gate->interval = (gate->interval * 2 < gate->max_interval) ? gate->interval * 2 : gate->max_interval;
+    } else {
+        if (gate->held > 0) {
+            gate->changes++;
+            gate->latency_sum += gate->held;
+            if ((uint32_t)gate->held > gate->latency_max) {
+                gate->latency_max = gate->held;
+            }
+        }
+        gate->interval = 1;
+    }
+    gate->held = 0;
+    gate->valid = true;
+    gate->ref_energy = energy;
+    gate->ref_quiet = quiet;
+    gate->ref_frequency = frequency;
+    gate->ref_level = level;
+}
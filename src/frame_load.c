@@ -0,0 +1,116 @@
+#include <stdlib.h>
+#include "esp_log.h"
+#include "esp_heap_caps.h"
+#include "esp_dsp.h"
+#include "frame_load.h"
+
+static const char *TAG = "FRAME_LOAD";
+
+void frame_load_s16_ansi(const int16_t *x, const float *window, float *out, int len, int stride)
+{
+    int32_t sum = 0;
+    for (int i = 0; i < len; i++) {
+        sum += x[i];
+    }
+    float mean = (float)sum / len;
+
+    for (int i = 0; i < len; i++) {
+        out[i * stride] = ((float)x[i] - mean) * window[i];
+    }
+}
+
+/*
+ * Variante für den ESP32-Kern (LX6 mit FPU): Die Summe läuft mit zwei unabhängigen Akkumulatoren,
+ * der zweite Durchlauf ist vierfach entrollt, damit sich Konvertierung, Subtraktion und
+ * Multiplikation der FPU-Pipeline überlappen (Gewinn mit ENABLE_FRAME_LOAD_BENCHMARK auf dem Ziel
+ * messen). Erwartet len % 4 == 0, sonst wird die ANSI-Variante verwendet; das Ergebnis ist
+ * bitgleich zur ANSI-Variante.
+ */
+void frame_load_s16_ae32(const int16_t *x, const float *window, float *out, int len, int stride)
+{
+    if ((len & 3) != 0) {
+        frame_load_s16_ansi(x, window, out, len, stride);
+        return;
+    }
+
+    int32_t sum_lo = 0;
+    int32_t sum_hi = 0;
+    for (int i = 0; i < len; i += 2) {
+        sum_lo += x[i];
+        sum_hi += x[i + 1];
+    }
+    float mean = (float)(sum_lo + sum_hi) / len;
+
+    float *o = out;
+    const int step = stride * 4;
+    for (int i = 0; i < len; i += 4) {
+        float x0 = (float)x[i + 0] - mean;
+        float x1 = (float)x[i + 1] - mean;
+        float x2 = (float)x[i + 2] - mean;
+        float x3 = (float)x[i + 3] - mean;
+        o[0]          = x0 * window[i + 0];
+        o[stride]     = x1 * window[i + 1];
+        o[stride * 2] = x2 * window[i + 2];
+        o[stride * 3] = x3 * window[i + 3];
+        o += step;
+    }
+}
+
+// Bisherige Eingangsstufe: Mittelwert, Abziehen in einen Zwischenpuffer, Fenster + Ablage
+static void frame_load_three_pass(const int16_t *x, const float *window, float *tmp, float *out, int len)
+{
+    float mean = 0.0f;
+    for (int i = 0; i < len; i++) {
+        mean += x[i];
+    }
+    mean /= len;
+    for (int i = 0; i < len; i++) {
+        tmp[i] = x[i] - mean;
+    }
+    dsps_mul_f32(tmp, window, out, len, 1, 1, 1);
+}
+
+void frame_load_benchmark(int len, int iterations)
+{
+    int16_t *x = (int16_t *)heap_caps_aligned_alloc(16, len * sizeof(int16_t), MALLOC_CAP_8BIT);
+    float *window = (float *)heap_caps_aligned_alloc(16, len * sizeof(float), MALLOC_CAP_8BIT);
+    float *tmp = (float *)heap_caps_aligned_alloc(16, len * sizeof(float), MALLOC_CAP_8BIT);
+    float *out = (float *)heap_caps_aligned_alloc(16, len * sizeof(float), MALLOC_CAP_8BIT);
+    if (!x || !window || !tmp || !out) {
+        ESP_LOGE(TAG, "Benchmark: out of memory");
+        goto cleanup;
+    }
+
+    dsps_wind_hann_f32(window, len);
+    for (int i = 0; i < len; i++) {
+        x[i] = 2048 + (int16_t)((rand() & 0x3FF) - 0x200);
+    }
+
+    uint32_t start = dsp_get_cpu_cycle_count();
+    for (int n = 0; n < iterations; n++) {
+        frame_load_three_pass(x, window, tmp, out, len);
+    }
+    uint32_t three_pass = dsp_get_cpu_cycle_count() - start;
+
+    start = dsp_get_cpu_cycle_count();
+    for (int n = 0; n < iterations; n++) {
+        frame_load_s16_ansi(x, window, out, len, 1);
+    }
+    uint32_t ansi = dsp_get_cpu_cycle_count() - start;
+
+    start = dsp_get_cpu_cycle_count();
+    for (int n = 0; n < iterations; n++) {
+        frame_load_s16(x, window, out, len, 1);
+    }
+    uint32_t fused = dsp_get_cpu_cycle_count() - start;
+
+    ESP_LOGI(TAG, "Input stage (N=%d): three-pass %u, fused ansi %u, fused %u cycles/frame", len,
+             (unsigned int)(three_pass / iterations), (unsigned int)(ansi / iterations),
+             (unsigned int)(fused / iterations));
+
+cleanup:
+    heap_caps_free(x);
+    heap_caps_free(window);
+    heap_caps_free(tmp);
+    heap_caps_free(out);
+}
@@ -0,0 +1,250 @@
+#include <string.h>
+#include <math.h>
+#include <new>
+#include "esp_log.h"
+#include "esp_dsp.h"
+#include "ekf.h"
+#include "freq_kalman.h"
+
+static const char *TAG = "FREQ_KALMAN";
+
+// Anfangsunsicherheit der Steigung in Hz/s (ein neuer Ton kann bereits gleiten)
+#define INIT_SLOPE_STDDEV 1000.0f
+// Größtes Verhältnis ref_magnitude / magnitude (sehr schwache Messungen zählen kaum noch)
+#define MAX_NOISE_RATIO 100.0f
+
+/**
+ * Zwei Zustände (Frequenz, Steigung), eine Rauscheingabe (Änderung der Steigung). F und G sind
+ * konstant; Process() schreibt Zustand und Kovarianz geschlossen fort (F ist nilpotent, I + F dt
+ * ist exakt), ohne die Runge-Kutta-Schritte und Mat-Temporaries von ekf::Process. Die Messung
+ * läuft über ekf::Update.
+ */
+class freq_ekf : public ekf {
+public:
+    freq_ekf() : ekf(2, 1), H(1, 2)
+    {
+    }
+
+    void Init() override
+    {
+        X *= 0;
+        P *= 0;
+        F *= 0;
+        F(0, 1) = 1.0f;
+        G *= 0;
+        G(1, 0) = 1.0f;
+        H *= 0;
+        H(0, 0) = 1.0f;
+    }
+
+    void LinearizeFG(dspm::Mat &x, float *u) override
+    {
+        // lineares Modell: F und G bleiben wie in Init()
+    }
+
+    void Process(float *u, float dt) override
+    {
+        X(0, 0) += X(1, 0) * dt;
+        // P = (I + F dt) P (I + F dt)' + dt² G Q G'
+        float p00 = P(0, 0), p01 = P(0, 1), p11 = P(1, 1);
+        P(0, 0) = p00 + dt * (2.0f * p01 + dt * p11);
+        P(0, 1) = P(1, 0) = p01 + dt * p11;
+        P(1, 1) = p11 + dt * dt * Q(0, 0);
+    }
+
+    // Neustart beim Messwert z mit der Messvarianz r
+    void Start(float z, float r)
+    {
+        X(0, 0) = z;
+        X(1, 0) = 0.0f;
+        P(0, 0) = r;
+        P(0, 1) = P(1, 0) = 0.0f;
+        P(1, 1) = INIT_SLOPE_STDDEV * INIT_SLOPE_STDDEV;
+    }
+
+    dspm::Mat H;
+};
+
+esp_err_t freq_kalman_init(freq_kalman_t *kf, float accel, float meas_noise_hz, float ref_magnitude,
+                           float gate, int max_outliers)
+{
+    memset(kf, 0, sizeof(*kf));
+    if (!(accel > 0.0f) || !(meas_noise_hz > 0.0f) || !(ref_magnitude > 0.0f) || !(gate > 0.0f)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    freq_ekf *filter = new (std::nothrow) freq_ekf();
+    if (!filter) {
+        return ESP_ERR_NO_MEM;
+    }
+    filter->Init();
+    filter->Q(0, 0) = accel * accel;
+    kf->ekf = filter;
+    kf->accel = accel;
+    kf->meas_noise_hz = meas_noise_hz;
+    kf->ref_magnitude = ref_magnitude;
+    kf->gate = gate;
+    kf->max_outliers = (max_outliers > 1) ? max_outliers : 1;
+    return ESP_OK;
+}
+
+void freq_kalman_deinit(freq_kalman_t *kf)
+{
+    delete static_cast<freq_ekf *>(kf->ekf);
+    kf->ekf = NULL;
+    kf->valid = false;
+}
+
+void freq_kalman_reset(freq_kalman_t *kf)
+{
+    kf->valid = false;
+    kf->outliers = 0;
+}
+
+// Messvarianz aus der Konfidenz (integrierte Magnitude) der Messung
+static inline float measurement_variance(const freq_kalman_t *kf, float magnitude)
+{
+    float ratio = (magnitude * MAX_NOISE_RATIO > kf->ref_magnitude) ? kf->ref_magnitude / magnitude : MAX_NOISE_RATIO;
+    float sigma = kf->meas_noise_hz * ratio;
+    return sigma * sigma;
+}
+
+float freq_kalman_update(freq_kalman_t *kf, float measured_hz, float magnitude, float dt)
+{
+    freq_ekf *filter = static_cast<freq_ekf *>(kf->ekf);
+    float r = measurement_variance(kf, magnitude);
+    bool restart = !kf->valid;
+    if (!restart) {
+        if (dt > 0.0f) {
+            filter->Process(NULL, dt);
+        }
+        float innovation = measured_hz - filter->X(0, 0);
+        float variance = filter->P(0, 0) + r;
+        if (innovation * innovation > kf->gate * kf->gate * variance) {
+            // Neustart erst, wenn die Ausreißer untereinander übereinstimmen (neuer Ton statt Oktavfehler)
+            float jump = measured_hz - kf->outlier_hz;
+            bool consistent = kf->outliers > 0 && jump * jump <= kf->gate * kf->gate * (r + kf->outlier_var);
+            kf->outliers = consistent ? kf->outliers + 1 : 1;
+            kf->outlier_hz = measured_hz;
+            kf->outlier_var = r;
+            kf->rejected++;
+            restart = (kf->outliers >= kf->max_outliers);
+        } else {
+            float expected = filter->X(0, 0);
+            filter->Update(filter->H, &measured_hz, &expected, &r);
+            kf->outliers = 0;
+        }
+    }
+    if (restart) {
+        filter->Start(measured_hz, r);
+        kf->restarts += kf->valid;
+        kf->valid = true;
+        kf->outliers = 0;
+    }
+    kf->updates++;
+    kf->frequency = filter->X(0, 0);
+    kf->slope = filter->X(1, 0);
+    kf->stddev = sqrtf(filter->P(0, 0));
+    return kf->frequency;
+}
+
+// Reproduzierbare Zufallszahlen für den Benchmark (LCG, Box-Muller)
+static uint32_t bench_seed;
+
+static float bench_uniform(void)
+{
+    bench_seed = bench_seed * 1664525u + 1013904223u;
+    return ((bench_seed >> 8) + 0.5f) / 16777216.0f;
+}
+
+static float bench_gauss(void)
+{
+    float u1 = bench_uniform();
+    float u2 = bench_uniform();
+    return sqrtf(-2.0f * logf(u1)) * cosf(2.0f * (float)M_PI * u2);
+}
+
+// Wahre Frequenz des Szenarios zum Zeitpunkt t (s)
+static float bench_truth(int scenario, float t)
+{
+    switch (scenario) {
+    case 0:  return 300.0f + 600.0f * t;                              // Sweep 600 Hz/s
+    case 1:  return 1000.0f + 30.0f * sinf(2.0f * (float)M_PI * 5.0f * t);   // Vibrato 5 Hz, +-30 Hz
+    default: return (fmodf(t, 1.0f) < 0.5f) ? 700.0f : 1300.0f;      // Tonwechsel alle 0,5 s
+    }
+}
+
+void freq_kalman_benchmark(float frame_rate, float accel, float meas_noise_hz, float max_jump_hz)
+{
+    static const char *const names[] = { "sweep 600 Hz/s", "vibrato 5 Hz +-30 Hz", "steps 700/1300 Hz" };
+    const int frames = (int)(2.0f * frame_rate);   // 2 s je Szenario
+    const float dt = 1.0f / frame_rate;
+    const float ref = 10.0f;
+
+    for (int scenario = 0; scenario < 3; scenario++) {
+        freq_kalman_t kf;
+        if (freq_kalman_init(&kf, accel, meas_noise_hz, ref, 4.0f, 2) != ESP_OK) {
+            ESP_LOGE(TAG, "Benchmark: setup failed");
+            return;
+        }
+        bench_seed = 12345u + scenario;
+        float raw_sq = 0.0f, noise_sq = 0.0f, limit_sq = 0.0f, kalman_sq = 0.0f;
+        int octaves = 0;
+        float limited = 0.0f;
+        uint32_t cycles = 0, max_cycles = 0;
+        for (int i = 0; i < frames; i++) {
+            float truth = bench_truth(scenario, i * dt);
+            // Konfidenz zwischen dem 1- und 10-fachen der Schwelle, 3 % Oktavfehler
+            float magnitude = 1.0f + 9.0f * bench_uniform();
+            float measured = truth + bench_gauss() * meas_noise_hz * ref / magnitude;
+            if (bench_uniform() < 0.03f) {
+                measured *= 2.0f;
+                octaves++;
+            } else {
+                noise_sq += (measured - truth) * (measured - truth);
+            }
+            if (i == 0 || fabsf(measured - limited) <= max_jump_hz) {
+                limited = measured;
+            } else {
+                limited += (measured > limited) ? max_jump_hz : -max_jump_hz;
+            }
+            uint32_t start = dsp_get_cpu_cycle_count();
+            float estimate = freq_kalman_update(&kf, measured, magnitude, dt);
+            uint32_t used = dsp_get_cpu_cycle_count() - start;
+            cycles += used;
+            max_cycles = (used > max_cycles) ? used : max_cycles;
+            raw_sq += (measured - truth) * (measured - truth);
+            limit_sq += (limited - truth) * (limited - truth);
+            kalman_sq += (estimate - truth) * (estimate - truth);
+        }
+        ESP_LOGI(TAG, "%s: RMS error raw %.2f Hz (%.2f Hz without %d octave errors), rate limit %.2f Hz, "
+                 "kalman %.2f Hz (%u rejected, %u restarts); %u cycles/update (max %u)",
+                 names[scenario], sqrtf(raw_sq / frames), sqrtf(noise_sq / (frames - octaves)), octaves,
+                 sqrtf(limit_sq / frames), sqrtf(kalman_sq / frames),
+                 (unsigned int)kf.rejected, (unsigned int)kf.restarts, (unsigned int)(cycles / frames),
+                 (unsigned int)max_cycles);
+        freq_kalman_deinit(&kf);
+    }
+
+    // Vergleich: Fortschreibung über ekf::Process (Runge-Kutta, Kovarianz mit Mat-Temporaries)
+    freq_ekf *filter = new (std::nothrow) freq_ekf();
+    if (!filter) {
+        return;
+    }
+    filter->Init();
+    filter->Q(0, 0) = accel * accel;
+    filter->Start(1000.0f, meas_noise_hz * meas_noise_hz);
+    float u = 0.0f;
+    uint32_t start = dsp_get_cpu_cycle_count();
+    for (int i = 0; i < 100; i++) {
+        filter->ekf::Process(&u, dt);
+    }
+    uint32_t generic = (dsp_get_cpu_cycle_count() - start) / 100;
+    start = dsp_get_cpu_cycle_count();
+    for (int i = 0; i < 100; i++) {
+        filter->Process(&u, dt);
+    }
+    uint32_t closed = (dsp_get_cpu_cycle_count() - start) / 100;
+    ESP_LOGI(TAG, "prediction: ekf::Process %u cycles, closed form %u cycles", (unsigned int)generic,
+             (unsigned int)closed);
+    delete filter;
+}
@@ -0,0 +1,196 @@
+#include <string.h>
+#include <math.h>
+#include "esp_log.h"
+#include "esp_heap_caps.h"
+#include "history.h"
+
+static const char *TAG = "HISTORY";
+
+static void acc_clear(history_acc_t *acc)
+{
+    memset(acc, 0, sizeof(*acc));
+}
+
+// Übernimmt die Summen src (ein Frame oder ein abgeschlossenes Intervall der vorigen Stufe) in acc.
+static void acc_merge(history_acc_t *acc, const history_acc_t *src)
+{
+    if (src->frames == 0) {
+        return;
+    }
+    if (src->count > 0) {
+        if (acc->count == 0 || src->freq_min < acc->freq_min) {
+            acc->freq_min = src->freq_min;
+        }
+        if (acc->count == 0 || src->freq_max > acc->freq_max) {
+            acc->freq_max = src->freq_max;
+        }
+        acc->freq_sum += src->freq_sum;
+        acc->count += src->count;
+    }
+    if (acc->frames == 0 || src->mag_min < acc->mag_min) {
+        acc->mag_min = src->mag_min;
+    }
+    if (acc->frames == 0 || src->mag_max > acc->mag_max) {
+        acc->mag_max = src->mag_max;
+    }
+    acc->mag_sum += src->mag_sum;
+    acc->frames += src->frames;
+}
+
+static inline int16_t quantize_freq(float hz)
+{
+    float steps = roundf(hz / HISTORY_FREQ_STEP);
+    return (int16_t)((steps > 32767.0f) ? 32767.0f : (steps < -32768.0f) ? -32768.0f : steps);
+}
+
+static inline uint8_t quantize_mag(float magnitude)
+{
+    if (!(magnitude > 1.0f)) {
+        return 0;
+    }
+    float steps = roundf(20.0f * log10f(magnitude) / HISTORY_MAG_STEP_DB);
+    return (uint8_t)((steps > 255.0f) ? 255.0f : steps);
+}
+
+// Schreibt das laufende Intervall der Stufe in den Ring und gibt es an die nächste Stufe weiter.
+static void tier_emit(history_t *h, int tier)
+{
+    history_tier_t *t = &h->tiers[tier];
+    const history_acc_t *acc = &t->acc;
+    uint32_t seq = t->head;
+    history_bucket_t bucket = {
+        .seq = seq,
+        .count = acc->count,
+        .freq_min = (acc->count > 0) ? quantize_freq(acc->freq_min) : 0,
+        .freq_max = (acc->count > 0) ? quantize_freq(acc->freq_max) : 0,
+        .freq_mean = (acc->count > 0) ? quantize_freq(acc->freq_sum / acc->count) : 0,
+        .mag_min = quantize_mag(acc->mag_min),
+        .mag_max = quantize_mag(acc->mag_max),
+        .mag_mean = quantize_mag(acc->mag_sum / acc->frames),
+        .voiced = (uint8_t)((acc->count * 255u + acc->frames / 2) / acc->frames),
+    };
+
+    // Eintrag zuerst ungültig markieren, dann füllen, zuletzt die Nummer setzen
+    history_bucket_t *slot = &t->buckets[seq % t->length];
+    __atomic_store_n(&slot->seq, HISTORY_SEQ_INVALID, __ATOMIC_SEQ_CST);
+    memcpy((uint8_t *)slot + sizeof(slot->seq), (const uint8_t *)&bucket + sizeof(bucket.seq),
+           sizeof(bucket) - sizeof(bucket.seq));
+    __atomic_store_n(&slot->seq, seq, __ATOMIC_SEQ_CST);
+}
+
+// Nimmt die Summen src zur Zeit time_s in eine Stufe auf; schließt dabei ggf. das laufende Intervall ab.
+static void tier_add(history_t *h, int tier, uint32_t time_s, const history_acc_t *src)
+{
+    history_tier_t *t = &h->tiers[tier];
+    uint32_t interval = time_s / t->period_s;
+    if (!t->started) {
+        t->started = true;
+        __atomic_store_n(&t->head, interval, __ATOMIC_SEQ_CST);
+    } else if (interval > t->head) {
+        if (t->acc.frames > 0) {
+            tier_emit(h, tier);
+            if (tier + 1 < h->num_tiers) {
+                tier_add(h, tier + 1, t->head * t->period_s, &t->acc);
+            }
+        }
+        acc_clear(&t->acc);
+        __atomic_store_n(&t->head, interval, __ATOMIC_SEQ_CST);
+    }
+    acc_merge(&t->acc, src);
+}
+
+esp_err_t history_init(history_t *h, const uint32_t *periods_s, const int *lengths, int num_tiers)
+{
+    memset(h, 0, sizeof(*h));
+    if (num_tiers < 1 || num_tiers > HISTORY_MAX_TIERS) {
+        ESP_LOGE(TAG, "Invalid number of tiers: %d", num_tiers);
+        return ESP_ERR_INVALID_ARG;
+    }
+    size_t total = 0;
+    for (int i = 0; i < num_tiers; i++) {
+        if (periods_s[i] < 1 || lengths[i] < 2 || (i > 0 && periods_s[i] % periods_s[i - 1] != 0)) {
+            ESP_LOGE(TAG, "Invalid tier %d (%u s x %d)", i, (unsigned int)periods_s[i], lengths[i]);
+            return ESP_ERR_INVALID_ARG;
+        }
+    }
+    h->num_tiers = num_tiers;
+    for (int i = 0; i < num_tiers; i++) {
+        history_tier_t *t = &h->tiers[i];
+        t->period_s = periods_s[i];
+        t->length = lengths[i];
+        t->buckets = (history_bucket_t *)heap_caps_malloc_prefer(lengths[i] * sizeof(history_bucket_t), 2,
+                                                                 MALLOC_CAP_SPIRAM, MALLOC_CAP_8BIT);
+        if (!t->buckets) {
+            ESP_LOGE(TAG, "Out of memory (tier %d: %d entries)", i, lengths[i]);
+            history_deinit(h);
+            return ESP_ERR_NO_MEM;
+        }
+        for (int j = 0; j < lengths[i]; j++) {
+            t->buckets[j].seq = HISTORY_SEQ_INVALID;
+        }
+        total += lengths[i] * sizeof(history_bucket_t);
+    }
+    ESP_LOGI(TAG, "History ready (%d tiers, %u bytes)", num_tiers, (unsigned int)total);
+    return ESP_OK;
+}
+
+void history_deinit(history_t *h)
+{
+    for (int i = 0; i < HISTORY_MAX_TIERS; i++) {
+        heap_caps_free(h->tiers[i].buckets);
+    }
+    memset(h, 0, sizeof(*h));
+}
+
+void history_add(history_t *h, int64_t time_us, float freq_hz, float magnitude, bool voiced)
+{
+    if (h->num_tiers == 0) {
+        return;
+    }
+    history_acc_t frame = {
+        .frames = 1,
+        .count = voiced ? 1 : 0,
+        .freq_min = freq_hz,
+        .freq_max = freq_hz,
+        .freq_sum = voiced ? freq_hz : 0.0f,
+        .mag_min = magnitude,
+        .mag_max = magnitude,
+        .mag_sum = magnitude,
+    };
+    tier_add(h, 0, (uint32_t)(time_us / 1000000), &frame);
+}
+
+uint32_t history_head(const history_t *h, int tier)
+{
+    if (tier < 0 || tier >= h->num_tiers) {
+        return 0;
+    }
+    return __atomic_load_n(&h->tiers[tier].head, __ATOMIC_SEQ_CST);
+}
+
+void history_read(const history_t *h, int tier, uint32_t from, int count, history_bucket_t *out)
+{
+    const history_tier_t *t = (tier >= 0 && tier < h->num_tiers) ? &h->tiers[tier] : NULL;
+    for (int i = 0; i < count; i++) {
+        uint32_t seq = from + i;
+        out[i].seq = HISTORY_SEQ_INVALID;
+        if (!t) {
+            continue;
+        }
+        uint32_t head = __atomic_load_n(&t->head, __ATOMIC_SEQ_CST);
+        // das älteste Intervall kann gerade überschrieben werden, daher ein Intervall Abstand
+        if (seq >= head || head - seq >= (uint32_t)t->length) {
+            continue;
+        }
+        const history_bucket_t *slot = &t->buckets[seq % t->length];
+        if (__atomic_load_n(&slot->seq, __ATOMIC_SEQ_CST) != seq) {
+            continue;
+        }
+        history_bucket_t copy;
+        memcpy(&copy, slot, sizeof(copy));
+        if (__atomic_load_n(&slot->seq, __ATOMIC_SEQ_CST) == seq) {
+            copy.seq = seq;
+            out[i] = copy;
+        }
+    }
+}
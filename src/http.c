@@ -1,12 +1,15 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <math.h>
 #include "esp_log.h"
 #include "esp_err.h"
 #include "esp_http_server.h"
 #include "config.h"
 #include "fastdetect.h"  // Enthält build_chunk_json, fastdetect_handler und ws_handler
 #include "wav.h"         // Enthält wav_download_handler
+#include "adc_fft.h"     // Enthält adc_fft_get_stats
+#include "arena.h"       // Scratch-Speicher für Handler
 #include "http.h"        // Eigene Header-Datei für HTTP-Funktionen
 
 static const char *TAG = "HTTP";
@@ -18,112 +21,622 @@ static esp_err_t favicon_handler(httpd_req_t *req)
     return httpd_resp_send(req, NULL, 0);
 }
 
-/* Index-Handler: Liefert /spiffs/index.html */
-static esp_err_t index_handler(httpd_req_t *req)
+/*
+ * Liefert eine Datei aus SPIFFS blockweise aus (HTTP_FILE_CHUNK_SIZE Bytes je Block aus der
+ * HTTP-Arena), statt die ganze Datei in den Heap zu laden.
+ */
+static esp_err_t send_spiffs_file(httpd_req_t *req, const char *path, const char *type)
 {
-    FILE *f = fopen("/spiffs/index.html", "r");
+    FILE *f = fopen(path, "r");
     if (!f) {
-        ESP_LOGE(TAG, "Failed to open /spiffs/index.html");
+        ESP_LOGE(TAG, "Failed to open %s", path);
         httpd_resp_send_err(req, HTTPD_404_NOT_FOUND, "HTML file not found");
         return ESP_FAIL;
     }
-    fseek(f, 0, SEEK_END);
-    long size = ftell(f);
-    fseek(f, 0, SEEK_SET);
-    if (size < 0) {
-        fclose(f);
-        ESP_LOGE(TAG, "Failed to determine size of /spiffs/index.html");
-        httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "ftell failed");
-        return ESP_FAIL;
-    }
-    char *buf = (char*)malloc(size + 1);
+    char *buf = (char*)arena_alloc(ARENA_HTTP, HTTP_FILE_CHUNK_SIZE);
     if (!buf) {
         fclose(f);
-        ESP_LOGE(TAG, "Failed to allocate memory for index.html");
         httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "OOM");
         return ESP_FAIL;
     }
-    fread(buf, 1, size, f);
+    httpd_resp_set_type(req, type);
+    esp_err_t res = ESP_OK;
+    size_t n;
+    while (res == ESP_OK && (n = fread(buf, 1, HTTP_FILE_CHUNK_SIZE, f)) > 0) {
+        res = httpd_resp_send_chunk(req, buf, n);
+    }
     fclose(f);
-    buf[size] = '\0';
-    httpd_resp_set_type(req, "text/html");
-    esp_err_t res = httpd_resp_send(req, buf, size);
-    free(buf);
-    return res;
+    arena_reset(ARENA_HTTP);
+    if (res != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to send %s", path);
+        return res;
+    }
+    return httpd_resp_send_chunk(req, NULL, 0);
+}
+
+/* Index-Handler: Liefert /spiffs/index.html */
+static esp_err_t index_handler(httpd_req_t *req)
+{
+    return send_spiffs_file(req, "/spiffs/index.html", "text/html");
 }
 
 /* Fastdetect-Handler: Liefert /spiffs/fastdetect.html */
 esp_err_t fastdetect_handler(httpd_req_t *req)
 {
-    FILE *f = fopen("/spiffs/fastdetect.html", "r");
-    if (!f) {
-        ESP_LOGE(TAG, "Failed to open /spiffs/fastdetect.html");
-        httpd_resp_send_err(req, HTTPD_404_NOT_FOUND, "HTML file not found");
-        return ESP_FAIL;
+    return send_spiffs_file(req, "/spiffs/fastdetect.html", "text/html");
+}
+
+/* Monitoring-Handler: Liefert /spiffs/monitoring.html */
+esp_err_t monitoring_handler(httpd_req_t *req)
+{
+    return send_spiffs_file(req, "/spiffs/monitoring.html", "text/html");
+}
+
+/* WAV-Handler: Liefert den generierten WAV-Stream (via wav_download_handler aus wav.c) */
+esp_err_t wav_handler(httpd_req_t *req)
+{
+    return wav_download_handler(req);
+}
+
+/* Stats-Handler: Zähler des ADC-Datenstroms als JSON */
+static esp_err_t stats_handler(httpd_req_t *req)
+{
+    adc_stream_stats_t stats;
+    adc_fft_get_stats(&stats);
+    const size_t json_size = 1280;
+    char *json = (char*)arena_alloc(ARENA_HTTP, json_size);
+    if (!json) {
+        return httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "OOM");
     }
-    fseek(f, 0, SEEK_END);
-    long size = ftell(f);
-    fseek(f, 0, SEEK_SET);
-    if (size < 0) {
-        fclose(f);
-        ESP_LOGE(TAG, "Failed to determine size of /spiffs/fastdetect.html");
-        httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "ftell failed");
-        return ESP_FAIL;
+    size_t len = snprintf(json, json_size,
+             "{\"samples\":%u,\"frames\":%u,\"frames_dropped\":%u,\"dma_overruns\":%u,"
+             "\"dropped_samples\":%u,\"invalid_samples\":%u,\"arena\":[",
+             (unsigned int)stats.samples_received, (unsigned int)stats.frames_analyzed,
+             (unsigned int)stats.frames_dropped, (unsigned int)stats.dma_overruns,
+             (unsigned int)stats.dropped_samples, (unsigned int)stats.invalid_samples);
+
+    // Belegung der Arena-Budgets (peak = maximal belegt seit dem Start)
+    for (int i = 0; i < ARENA_COUNT && len < json_size; i++) {
+        arena_stats_t a;
+        arena_get_stats((arena_id_t)i, &a);
+        len += snprintf(json + len, json_size - len,
+                        "%s{\"name\":\"%s\",\"size\":%u,\"peak\":%u,\"failures\":%u}",
+                        i ? "," : "", a.name, (unsigned int)a.size, (unsigned int)a.peak,
+                        (unsigned int)a.failures);
     }
-    char *buf = (char*)malloc(size + 1);
-    if (!buf) {
-        fclose(f);
-        ESP_LOGE(TAG, "Failed to allocate memory for fastdetect.html");
-        httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "OOM");
-        return ESP_FAIL;
+    if (len < json_size) {
+        len += snprintf(json + len, json_size - len, "],\"detectors\":[");
     }
-    fread(buf, 1, size, f);
-    fclose(f);
-    buf[size] = '\0';
-    httpd_resp_set_type(req, "text/html");
-    esp_err_t res = httpd_resp_send(req, buf, size);
-    free(buf);
+
+    // Rechenzeit und Stabilität der Grundfrequenz-Detektoren
+    adc_detector_stats_t det[DETECTOR_COUNT];
+    int num_det = adc_fft_get_detector_stats(det, DETECTOR_COUNT);
+    for (int i = 0; i < num_det && len < json_size; i++) {
+        len += snprintf(json + len, json_size - len,
+                        "%s{\"name\":\"%s\",\"active\":%s,\"frames\":%u,\"avg_cycles\":%u,"
+                        "\"last_cycles\":%u,\"octave_jumps\":%u,\"failures\":%u}",
+                        i ? "," : "", det[i].name, det[i].active ? "true" : "false",
+                        (unsigned int)det[i].frames, (unsigned int)det[i].avg_cycles,
+                        (unsigned int)det[i].last_cycles, (unsigned int)det[i].octave_jumps,
+                        (unsigned int)det[i].failures);
+    }
+    // Energie-Gate und Stationarität (eingesparte Rechenzeit, zusätzliche Verzögerung)
+    adc_gate_stats_t gate;
+    adc_fft_get_gate_stats(&gate);
+    if (len < json_size) {
+        len += snprintf(json + len, json_size - len,
+                        "],\"gate\":{\"frames\":%u,\"silent\":%u,\"held\":%u,\"analyzed\":%u,"
+                        "\"analysis_cycles\":%u,\"gate_cycles\":%u,\"cpu_saved\":%.3f,\"changes\":%u,"
+                        "\"avg_latency_ms\":%.1f,\"max_latency_ms\":%.1f,\"interval\":%d}}",
+                        (unsigned int)gate.frames, (unsigned int)gate.silent, (unsigned int)gate.held,
+                        (unsigned int)gate.analyzed, (unsigned int)gate.avg_analysis_cycles,
+                        (unsigned int)gate.avg_gate_cycles, gate.cpu_saved, (unsigned int)gate.changes,
+                        gate.avg_latency_ms, gate.max_latency_ms, gate.interval);
+    }
+    if (len >= json_size) {
+        len = json_size - 1;
+    }
+    httpd_resp_set_type(req, "application/json");
+    esp_err_t res = httpd_resp_send(req, json, len);
+    arena_reset(ARENA_HTTP);
     return res;
 }
 
-/* Monitoring-Handler: Liefert /spiffs/monitoring.html */
-esp_err_t monitoring_handler(httpd_req_t *req)
+/*
+ * Zoom-FFT: GET /zoom liefert die aktive Einstellung, /zoom?low=..&high=..[&factor=..] stellt
+ * Band und Faktor um (factor fehlt oder 0 = größter passender Faktor).
+ */
+static esp_err_t zoom_handler(httpd_req_t *req)
 {
-    FILE *f = fopen("/spiffs/monitoring.html", "r");
-    if (!f) {
-        ESP_LOGE(TAG, "Failed to open /spiffs/monitoring.html");
-        httpd_resp_send_err(req, HTTPD_404_NOT_FOUND, "HTML file not found");
-        return ESP_FAIL;
+    char query[64];
+    char value[16];
+    if (httpd_req_get_url_query_str(req, query, sizeof(query)) == ESP_OK) {
+        float low_hz = -1.0f, high_hz = -1.0f;
+        int factor = 0;
+        if (httpd_query_key_value(query, "low", value, sizeof(value)) == ESP_OK) {
+            low_hz = strtof(value, NULL);
+        }
+        if (httpd_query_key_value(query, "high", value, sizeof(value)) == ESP_OK) {
+            high_hz = strtof(value, NULL);
+        }
+        if (httpd_query_key_value(query, "factor", value, sizeof(value)) == ESP_OK) {
+            factor = atoi(value);
+        }
+        esp_err_t ret = adc_fft_set_zoom(low_hz, high_hz, factor);
+        if (ret != ESP_OK) {
+            ESP_LOGW(TAG, "zoom_handler: rejected %s (%s)", query, esp_err_to_name(ret));
+            return httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Invalid zoom setting");
+        }
     }
-    fseek(f, 0, SEEK_END);
-    long size = ftell(f);
-    fseek(f, 0, SEEK_SET);
-    if (size < 0) {
-        fclose(f);
-        ESP_LOGE(TAG, "Failed to determine size of /spiffs/monitoring.html");
-        httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "ftell failed");
-        return ESP_FAIL;
+
+    adc_zoom_config_t zoom;
+    adc_fft_get_zoom(&zoom);
+    const size_t json_size = 128;
+    char *json = (char*)arena_alloc(ARENA_HTTP, json_size);
+    if (!json) {
+        return httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "OOM");
     }
-    char *buf = (char*)malloc(size + 1);
-    if (!buf) {
-        fclose(f);
-        ESP_LOGE(TAG, "Failed to allocate memory for monitoring.html");
-        httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "OOM");
-        return ESP_FAIL;
+    size_t len = snprintf(json, json_size, "{\"low\":%.1f,\"high\":%.1f,\"factor\":%d,\"bin_hz\":%.3f}",
+                          zoom.low_hz, zoom.high_hz, zoom.factor, zoom.bin_hz);
+    if (len >= json_size) {
+        len = json_size - 1;
     }
-    fread(buf, 1, size, f);
-    fclose(f);
-    buf[size] = '\0';
-    httpd_resp_set_type(req, "text/html");
-    esp_err_t res = httpd_resp_send(req, buf, size);
-    free(buf);
+    httpd_resp_set_type(req, "application/json");
+    esp_err_t res = httpd_resp_send(req, json, len);
+    arena_reset(ARENA_HTTP);
     return res;
 }
 
-/* WAV-Handler: Liefert den generierten WAV-Stream (via wav_download_handler aus wav.c) */
-esp_err_t wav_handler(httpd_req_t *req)
+/*
+ * FFT-Einstellung: GET /fft liefert Größe, Fenster und Plan-Cache, /fft?size=<N> bzw. &window=<Name>
+ * stellt um (Zweierpotenz FFT_MIN_SIZE..FFT_MAX_SIZE, Fenstername aus window.h; übernommen vor dem
+ * nächsten Frame).
+ */
+static esp_err_t fft_size_handler(httpd_req_t *req)
 {
-    return wav_download_handler(req);
+    char query[64];
+    char value[20];
+    if (httpd_req_get_url_query_str(req, query, sizeof(query)) == ESP_OK) {
+        esp_err_t ret = ESP_OK;
+        if (httpd_query_key_value(query, "size", value, sizeof(value)) == ESP_OK) {
+            ret = adc_fft_set_fft_size(atoi(value));
+        }
+        if (ret == ESP_OK && httpd_query_key_value(query, "window", value, sizeof(value)) == ESP_OK) {
+            int type = window_from_name(value);
+            ret = (type < 0) ? ESP_ERR_INVALID_ARG : adc_fft_set_window((window_type_t)type);
+        }
+        if (ret != ESP_OK) {
+            ESP_LOGW(TAG, "fft_size_handler: rejected %s (%s)", query, esp_err_to_name(ret));
+            return httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Invalid FFT setting");
+        }
+    }
+
+    adc_fft_size_info_t info;
+    adc_fft_get_fft_size(&info);
+    const size_t json_size = 256;
+    char *json = (char*)arena_alloc(ARENA_HTTP, json_size);
+    if (!json) {
+        return httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "OOM");
+    }
+    size_t len = snprintf(json, json_size,
+                          "{\"fft_size\":%d,\"requested\":%d,\"min\":%d,\"max\":%d,\"bin_hz\":%.3f,\"hop\":%d,"
+                          "\"window\":\"%s\",\"coherent_gain\":%.4f,\"enbw\":%.4f,"
+                          "\"cached_plans\":%d,\"plan_hits\":%u,\"plan_misses\":%u}",
+                          info.fft_size, info.requested, FFT_MIN_SIZE, FFT_MAX_SIZE, info.bin_hz, info.hop,
+                          info.window, info.coherent_gain, info.enbw,
+                          info.cached_plans, (unsigned int)info.plan_hits, (unsigned int)info.plan_misses);
+    if (len >= json_size) {
+        len = json_size - 1;
+    }
+    httpd_resp_set_type(req, "application/json");
+    esp_err_t res = httpd_resp_send(req, json, len);
+    arena_reset(ARENA_HTTP);
+    return res;
+}
+
+// Kopf des binären Spektrogramm-Blocks (Little Endian), danach rows Zeilen zu je row_size Bytes
+// im Format von spectrogram.h (uint32 Nummer, float top_db, 1 Byte je Bin)
+typedef struct __attribute__((packed)) {
+    uint32_t first;        // Nummer der ersten Zeile
+    uint16_t rows;
+    uint16_t row_size;
+    uint16_t bins;         // Bins ab 0 Hz
+    uint8_t channel;
+    uint8_t row_header;    // Bytes vor den Bins einer Zeile
+    float bin_hz;
+    float row_seconds;     // Zeit zwischen zwei Zeilen
+    float db_step;         // dB je Stufe unter top_db (Wert 255 = top_db)
+} spectrogram_blob_header_t;
+
+/*
+ * Spektrogramm: GET /spectrogram?ch=<n>&from=<Zeile>&count=<n> bzw. &last=<n> (Standard: die letzten 64)
+ * liefert den Zeitausschnitt als ein Binärblock (application/octet-stream), blockweise aus der HTTP-Arena.
+ * Zeilen, die während der Übertragung überschrieben wurden, kommen mit Nummer 0xFFFFFFFF und Nullen.
+ */
+static esp_err_t spectrogram_handler(httpd_req_t *req)
+{
+    char query[64];
+    char value[16];
+    int channel = 0;
+    int count = 64;
+    long from = -1;
+    if (httpd_req_get_url_query_str(req, query, sizeof(query)) == ESP_OK) {
+        if (httpd_query_key_value(query, "ch", value, sizeof(value)) == ESP_OK) {
+            channel = atoi(value);
+        }
+        if (httpd_query_key_value(query, "count", value, sizeof(value)) == ESP_OK ||
+            httpd_query_key_value(query, "last", value, sizeof(value)) == ESP_OK) {
+            count = atoi(value);
+        }
+        if (httpd_query_key_value(query, "from", value, sizeof(value)) == ESP_OK) {
+            from = strtol(value, NULL, 10);
+        }
+    }
+
+    adc_spectrogram_info_t info;
+    esp_err_t err = adc_fft_get_spectrogram_info(channel, &info);
+    if (err == ESP_ERR_INVALID_STATE || err == ESP_ERR_NOT_SUPPORTED) {
+        return httpd_resp_send_err(req, HTTPD_404_NOT_FOUND, "Spectrogram disabled");
+    }
+    if (count < 1 || err != ESP_OK) {
+        return httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Invalid spectrogram request");
+    }
+    int rows_per_chunk = HTTP_FILE_CHUNK_SIZE / info.row_size;
+    uint8_t *buf = (uint8_t*)arena_alloc(ARENA_HTTP, HTTP_FILE_CHUNK_SIZE);
+    if (!buf || rows_per_chunk < 1) {
+        arena_reset(ARENA_HTTP);
+        return httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "OOM");
+    }
+
+    // Ausschnitt auf die vorhandenen Zeilen der aktiven FFT-Größe begrenzen
+    uint32_t head = info.head;
+    uint32_t oldest = info.oldest;
+    uint32_t first = (from < 0) ? ((head > (uint32_t)count) ? head - count : 0) : (uint32_t)from;
+    if (first < oldest) {
+        first = oldest;
+    }
+    int rows = (first < head) ? (int)(head - first) : 0;
+    if (rows > count) {
+        rows = count;
+    }
+
+    spectrogram_blob_header_t header = {
+        .first = first,
+        .rows = (uint16_t)rows,
+        .row_size = (uint16_t)info.row_size,
+        .bins = (uint16_t)info.bins,
+        .channel = (uint8_t)channel,
+        .row_header = SPECTROGRAM_ROW_HEADER,
+        .bin_hz = info.bin_hz,
+        .row_seconds = info.row_seconds,
+        .db_step = SPECTROGRAM_DB_STEP,
+    };
+    httpd_resp_set_type(req, "application/octet-stream");
+    esp_err_t ret = httpd_resp_send_chunk(req, (const char*)&header, sizeof(header));
+
+    uint32_t seq = first;
+    while (rows > 0 && ret == ESP_OK) {
+        int n = (rows < rows_per_chunk) ? rows : rows_per_chunk;
+        uint32_t got_first;
+        int got = adc_fft_read_spectrogram(channel, seq, n, buf, &got_first);
+        if (got_first != seq) {
+            got = 0;   // Anfang des Blocks bereits überschrieben
+        }
+        for (int r = got; r < n; r++) {
+            uint8_t *row = buf + r * info.row_size;
+            memset(row, 0, info.row_size);
+            memset(row, 0xFF, sizeof(uint32_t));
+        }
+        ret = httpd_resp_send_chunk(req, (const char*)buf, n * info.row_size);
+        seq += n;
+        rows -= n;
+    }
+    arena_reset(ARENA_HTTP);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to send spectrogram");
+        return ret;
+    }
+    return httpd_resp_send_chunk(req, NULL, 0);
+}
+
+// Kopf des binären Verlaufs-Blocks (Little Endian), danach count Intervalle im Format history_bucket_t
+typedef struct __attribute__((packed)) {
+    uint32_t first;        // Nummer des ersten Intervalls (Zeit seit dem Start / period_s)
+    uint32_t head;         // laufendes, noch nicht abgeschlossenes Intervall
+    uint32_t period_s;
+    uint16_t count;
+    uint8_t bucket_size;
+    uint8_t channel;
+    uint8_t tier;
+    uint8_t tiers;
+    float freq_step;       // Hz je Stufe von freq_*
+    float mag_step_db;     // dB je Stufe von mag_*
+} history_blob_header_t;
+
+/*
+ * Verlauf: GET /history?ch=<n>&tier=<Stufe>&from=<Intervall>&count=<n> (Standard: Stufe 0, die letzten 120
+ * abgeschlossenen Intervalle) liefert Minimum, Maximum und Mittelwert je Intervall als ein Binärblock.
+ * Fehlende oder während der Übertragung überschriebene Intervalle kommen mit Nummer 0xFFFFFFFF.
+ */
+static esp_err_t history_handler(httpd_req_t *req)
+{
+    char query[64];
+    char value[16];
+    int channel = 0;
+    int tier = 0;
+    int count = 120;
+    long from = -1;
+    if (httpd_req_get_url_query_str(req, query, sizeof(query)) == ESP_OK) {
+        if (httpd_query_key_value(query, "ch", value, sizeof(value)) == ESP_OK) {
+            channel = atoi(value);
+        }
+        if (httpd_query_key_value(query, "tier", value, sizeof(value)) == ESP_OK) {
+            tier = atoi(value);
+        }
+        if (httpd_query_key_value(query, "count", value, sizeof(value)) == ESP_OK) {
+            count = atoi(value);
+        }
+        if (httpd_query_key_value(query, "from", value, sizeof(value)) == ESP_OK) {
+            from = strtol(value, NULL, 10);
+        }
+    }
+
+    fastdetect_history_info_t info;
+    if (count < 1 || fastdetect_get_history_info(channel, tier, &info) != ESP_OK) {
+        return httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Invalid history request");
+    }
+    int buckets_per_chunk = HTTP_FILE_CHUNK_SIZE / sizeof(history_bucket_t);
+    history_bucket_t *buf = (history_bucket_t*)arena_alloc(ARENA_HTTP, buckets_per_chunk * sizeof(history_bucket_t));
+    if (!buf || buckets_per_chunk < 1) {
+        arena_reset(ARENA_HTTP);
+        return httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "OOM");
+    }
+
+    // Ausschnitt auf die abgeschlossenen Intervalle im Ring begrenzen
+    uint32_t head = info.head;
+    uint32_t oldest = (head > (uint32_t)info.length - 1) ? head - (info.length - 1) : 0;
+    uint32_t first = (from < 0) ? ((head > (uint32_t)count) ? head - count : 0) : (uint32_t)from;
+    if (first < oldest) {
+        first = oldest;
+    }
+    int n_total = (first < head) ? (int)(head - first) : 0;
+    if (n_total > count) {
+        n_total = count;
+    }
+
+    history_blob_header_t header = {
+        .first = first,
+        .head = head,
+        .period_s = info.period_s,
+        .count = (uint16_t)n_total,
+        .bucket_size = (uint8_t)sizeof(history_bucket_t),
+        .channel = (uint8_t)channel,
+        .tier = (uint8_t)tier,
+        .tiers = (uint8_t)info.tiers,
+        .freq_step = HISTORY_FREQ_STEP,
+        .mag_step_db = HISTORY_MAG_STEP_DB,
+    };
+    httpd_resp_set_type(req, "application/octet-stream");
+    esp_err_t ret = httpd_resp_send_chunk(req, (const char*)&header, sizeof(header));
+
+    uint32_t seq = first;
+    while (n_total > 0 && ret == ESP_OK) {
+        int n = (n_total < buckets_per_chunk) ? n_total : buckets_per_chunk;
+        fastdetect_read_history(channel, tier, seq, n, buf);
+        ret = httpd_resp_send_chunk(req, (const char*)buf, n * sizeof(history_bucket_t));
+        seq += n;
+        n_total -= n;
+    }
+    arena_reset(ARENA_HTTP);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to send history");
+        return ret;
+    }
+    return httpd_resp_send_chunk(req, NULL, 0);
+}
+
+// Bins je Lesevorgang aus dem Spektrum-Akkumulator
+#define SPECTRUM_READ_BINS 64
+
+// Kopf eines binären Spektrum-Frames über WebSocket (Little Endian), danach 1 Byte je Bin
+typedef struct __attribute__((packed)) {
+    uint16_t bins;       // Anzahl der folgenden Bins ab 0 Hz
+    uint8_t channel;
+    uint8_t mode;        // spectrum_avg_mode_t
+    float bin_hz;
+    uint32_t frames;     // aufgenommene Frames
+} spectrum_ws_header_t;
+
+/*
+ * Gemitteltes Spektrum: GET /spectrum?ch=<n>&mode=avg|exp|peak|min[&reset=1] liefert die Bins als
+ * JSON in dB (Sinus der Amplitude A = 20 log10(A)), blockweise aus der HTTP-Arena gesendet.
+ * reset=1 setzt Mittelwerte und Hold-Werte des Kanals zurück.
+ */
+static esp_err_t spectrum_handler(httpd_req_t *req)
+{
+    char query[64];
+    char value[16];
+    int channel = 0;
+    int mode = SPECTRUM_AVG_EXP;
+    bool reset = false;
+    if (httpd_req_get_url_query_str(req, query, sizeof(query)) == ESP_OK) {
+        if (httpd_query_key_value(query, "ch", value, sizeof(value)) == ESP_OK) {
+            channel = atoi(value);
+        }
+        if (httpd_query_key_value(query, "mode", value, sizeof(value)) == ESP_OK) {
+            mode = spectrum_avg_mode_from_name(value);
+        }
+        if (httpd_query_key_value(query, "reset", value, sizeof(value)) == ESP_OK) {
+            reset = atoi(value) != 0;
+        }
+    }
+
+    adc_spectrum_info_t info;
+    esp_err_t ret = (mode < 0) ? ESP_ERR_INVALID_ARG : adc_fft_get_spectrum_info(channel, &info);
+    if (ret != ESP_OK) {
+        return httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Invalid spectrum request");
+    }
+
+    char *text = (char*)arena_alloc(ARENA_HTTP, HTTP_FILE_CHUNK_SIZE);
+    float *power = (float*)arena_alloc(ARENA_HTTP, SPECTRUM_READ_BINS * sizeof(float));
+    if (!text || !power) {
+        arena_reset(ARENA_HTTP);
+        return httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "OOM");
+    }
+    httpd_resp_set_type(req, "application/json");
+    size_t len = snprintf(text, HTTP_FILE_CHUNK_SIZE,
+                          "{\"ch\":%d,\"mode\":\"%s\",\"bins\":%d,\"bin_hz\":%.3f,\"enbw\":%.3f,\"frames\":%u,\"db\":[",
+                          channel, spectrum_avg_mode_name((spectrum_avg_mode_t)mode), info.bins, info.bin_hz,
+                          info.enbw, (unsigned int)info.frames);
+    ret = ESP_OK;
+    for (int first = 0; first < info.bins && ret == ESP_OK; first += SPECTRUM_READ_BINS) {
+        int n = (info.bins - first < SPECTRUM_READ_BINS) ? info.bins - first : SPECTRUM_READ_BINS;
+        adc_fft_read_spectrum(channel, (spectrum_avg_mode_t)mode, first, n, power);
+        for (int i = 0; i < n; i++) {
+            // höchstens 8 Zeichen je Wert ("-120.5,")
+            if (len + 8 >= HTTP_FILE_CHUNK_SIZE) {
+                ret = httpd_resp_send_chunk(req, text, len);
+                len = 0;
+            }
+            len += snprintf(text + len, HTTP_FILE_CHUNK_SIZE - len, "%s%.1f", (first + i) ? "," : "",
+                            10.0f * log10f(power[i] * info.scale + 1e-12f));
+        }
+    }
+    if (ret == ESP_OK) {
+        len += snprintf(text + len, HTTP_FILE_CHUNK_SIZE - len, "]}");
+        ret = httpd_resp_send_chunk(req, text, len);
+    }
+    arena_reset(ARENA_HTTP);
+    if (reset) {
+        adc_fft_reset_spectrum(channel);
+    }
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to send spectrum");
+        return ret;
+    }
+    return httpd_resp_send_chunk(req, NULL, 0);
+}
+
+/*
+ * WebSocket-Antwort auf "spectrum:<ch>:<mode>": binärer Frame mit spectrum_ws_header_t und je Bin
+ * einem Byte (spectrum_db_u8, 0,5 dB je Stufe ab SPECTRUM_DB_MIN).
+ */
+static void ws_send_spectrum(httpd_req_t *req, const char *args)
+{
+    int channel = atoi(args);
+    const char *sep = strchr(args, ':');
+    int mode = sep ? spectrum_avg_mode_from_name(sep + 1) : SPECTRUM_AVG_EXP;
+    adc_spectrum_info_t info;
+    if (mode < 0 || adc_fft_get_spectrum_info(channel, &info) != ESP_OK) {
+        ESP_LOGW(TAG, "ws_handler: invalid spectrum request %s", args);
+        return;
+    }
+
+    size_t size = sizeof(spectrum_ws_header_t) + info.bins;
+    uint8_t *frame = (uint8_t*)arena_alloc(ARENA_WS, size);
+    float *power = (float*)arena_alloc(ARENA_WS, SPECTRUM_READ_BINS * sizeof(float));
+    if (!frame || !power) {
+        ESP_LOGW(TAG, "ws_handler: spectrum frame exceeds arena");
+        return;
+    }
+    spectrum_ws_header_t header = {
+        .bins = (uint16_t)info.bins,
+        .channel = (uint8_t)channel,
+        .mode = (uint8_t)mode,
+        .bin_hz = info.bin_hz,
+        .frames = info.frames,
+    };
+    memcpy(frame, &header, sizeof(header));
+    uint8_t *db = frame + sizeof(header);
+    for (int first = 0; first < info.bins; first += SPECTRUM_READ_BINS) {
+        int n = (info.bins - first < SPECTRUM_READ_BINS) ? info.bins - first : SPECTRUM_READ_BINS;
+        adc_fft_read_spectrum(channel, (spectrum_avg_mode_t)mode, first, n, power);
+        for (int i = 0; i < n; i++) {
+            db[first + i] = spectrum_db_u8(10.0f * log10f(power[i] * info.scale + 1e-12f));
+        }
+    }
+
+    httpd_ws_frame_t resp;
+    memset(&resp, 0, sizeof(resp));
+    resp.type = HTTPD_WS_TYPE_BINARY;
+    resp.payload = frame;
+    resp.len = size;
+    esp_err_t ret = httpd_ws_send_frame(req, &resp);
+    if (ret != ESP_OK) {
+        ESP_LOGW(TAG, "Send spectrum frame failed: %d", ret);
+    }
+}
+
+/* Sendet einen JSON-Text als WebSocket-Antwort */
+static void ws_send_json(httpd_req_t *req, const char *json)
+{
+    httpd_ws_frame_t resp;
+    memset(&resp, 0, sizeof(resp));
+    resp.type = HTTPD_WS_TYPE_TEXT;
+    resp.payload = (uint8_t*)json;
+    resp.len = strlen(json);
+    esp_err_t ret = httpd_ws_send_frame(req, &resp);
+    if (ret != ESP_OK) {
+        ESP_LOGW(TAG, "Send JSON failed: %d", ret);
+    }
+}
+
+/*
+ * WebSocket-Antwort auf "bands:<ch>": Bänder der letzten Bandsuche (je Fensterbreite die
+ * BAND_SEARCH_TOP_K stärksten, absteigend; sum 0 = nicht belegt), Frequenzen ohne OFFSET.
+ */
+static void ws_send_bands(httpd_req_t *req, const char *args)
+{
+    int channel = atoi(args);
+    if (channel < 0 || channel >= ADC_NUM_CHANNELS) {
+        ESP_LOGW(TAG, "ws_handler: invalid channel %d", channel);
+        return;
+    }
+    adc_band_t bands[WS_BANDS_MAX];
+    int n = adc_fft_get_bands(channel, bands, WS_BANDS_MAX);
+    char *json = (char*)arena_alloc(ARENA_WS, WS_RESULT_JSON_SIZE);
+    if (!json) {
+        ESP_LOGW(TAG, "ws_handler: bands JSON exceeds arena");
+        return;
+    }
+    size_t len = snprintf(json, WS_RESULT_JSON_SIZE, "{\"ch\":%d,\"bands\":[", channel);
+    for (int i = 0; i < n; i++) {
+        // höchstens 64 Zeichen je Band
+        len += snprintf(json + len, WS_RESULT_JSON_SIZE - len, "%s{\"hz\":%.2f,\"width\":%.2f,\"sum\":%.1f}",
+                        i ? "," : "", bands[i].center_hz, bands[i].width_hz, bands[i].sum);
+    }
+    snprintf(json + len, WS_RESULT_JSON_SIZE - len, "]}");
+    ws_send_json(req, json);
+}
+
+/*
+ * WebSocket-Antwort auf "tones:<ch>": Ergebnisse der Tracker-Bank (je Zielfrequenz Amplitude, Phase in
+ * rad und gemessene Frequenz) vom zuletzt abgeschlossenen Block; ohne ENABLE_TONE_TRACKER leer.
+ */
+static void ws_send_tones(httpd_req_t *req, const char *args)
+{
+    int channel = atoi(args);
+    if (channel < 0 || channel >= ADC_NUM_CHANNELS) {
+        ESP_LOGW(TAG, "ws_handler: invalid channel %d", channel);
+        return;
+    }
+    tone_result_t tones[TONE_TRACKER_MAX_TONES];
+    int n = adc_fft_get_tones(channel, tones, TONE_TRACKER_MAX_TONES);
+    char *json = (char*)arena_alloc(ARENA_WS, WS_RESULT_JSON_SIZE);
+    if (!json) {
+        ESP_LOGW(TAG, "ws_handler: tones JSON exceeds arena");
+        return;
+    }
+    size_t len = snprintf(json, WS_RESULT_JSON_SIZE, "{\"ch\":%d,\"tones\":[", channel);
+    for (int i = 0; i < n; i++) {
+        // höchstens 96 Zeichen je Ton
+        len += snprintf(json + len, WS_RESULT_JSON_SIZE - len,
+                        "%s{\"hz\":%.1f,\"amplitude\":%.2f,\"phase\":%.4f,\"measured_hz\":%.3f,\"updates\":%u}",
+                        i ? "," : "", tones[i].freq_hz, tones[i].amplitude, tones[i].phase, tones[i].measured_hz,
+                        (unsigned int)tones[i].updates);
+    }
+    snprintf(json + len, WS_RESULT_JSON_SIZE - len, "]}");
+    ws_send_json(req, json);
 }
 
 /* WebSocket-Handler */
@@ -141,33 +654,48 @@ esp_err_t ws_handler(httpd_req_t *req)
         ESP_LOGE(TAG, "ws_handler: get length error: %d", ret);
         return ret;
     }
+    if (ws_pkt.len > WS_MAX_PAYLOAD) {
+        ESP_LOGW(TAG, "ws_handler: message too long (%u bytes)", (unsigned int)ws_pkt.len);
+        return ESP_ERR_INVALID_SIZE;
+    }
     if (ws_pkt.len) {
-        uint8_t *buf = (uint8_t*)calloc(1, ws_pkt.len + 1);
+        uint8_t *buf = (uint8_t*)arena_alloc(ARENA_WS, ws_pkt.len + 1);
         if (!buf)
             return ESP_ERR_NO_MEM;
+        buf[ws_pkt.len] = '\0';
         ws_pkt.payload = buf;
         ret = httpd_ws_recv_frame(req, &ws_pkt, ws_pkt.len);
         if (ret == ESP_OK) {
             ESP_LOGI(TAG, "WS got: %s", ws_pkt.payload);
-            if (strcmp((char*)ws_pkt.payload, "getdata") == 0) {
-                char json[JSON_BUFFER_SIZE];
-                memset(json, 0, sizeof(json));
-                build_chunk_json(json, sizeof(json));
-                ESP_LOGI(TAG, "Sending JSON: %s", json);
-                httpd_ws_frame_t resp;
-                memset(&resp, 0, sizeof(resp));
-                resp.type = HTTPD_WS_TYPE_TEXT;
-                resp.payload = (uint8_t*)json;
-                resp.len = strlen(json);
-                esp_err_t r2 = httpd_ws_send_frame(req, &resp);
-                if (r2 != ESP_OK) {
-                    ESP_LOGW(TAG, "Send chunk JSON failed: %d", r2);
+            // "getdata" → Kanal 0, "getdata:<n>" → Kanal n, "spectrum:<n>:<mode>" → gemitteltes Spektrum,
+            // "bands:<n>" → Bänder der Bandsuche, "tones:<n>" → Tracker-Bank
+            int channel = -1;
+            if (strncmp((char*)ws_pkt.payload, "spectrum:", 9) == 0) {
+                ws_send_spectrum(req, (char*)ws_pkt.payload + 9);
+            } else if (strncmp((char*)ws_pkt.payload, "bands:", 6) == 0) {
+                ws_send_bands(req, (char*)ws_pkt.payload + 6);
+            } else if (strncmp((char*)ws_pkt.payload, "tones:", 6) == 0) {
+                ws_send_tones(req, (char*)ws_pkt.payload + 6);
+            } else if (strcmp((char*)ws_pkt.payload, "getdata") == 0) {
+                channel = 0;
+            } else if (strncmp((char*)ws_pkt.payload, "getdata:", 8) == 0) {
+                channel = atoi((char*)ws_pkt.payload + 8);
+                if (channel < 0 || channel >= ADC_NUM_CHANNELS) {
+                    ESP_LOGW(TAG, "ws_handler: invalid channel %d", channel);
+                    channel = -1;
                 }
             }
+            char *json = (channel >= 0) ? (char*)arena_alloc(ARENA_WS, JSON_BUFFER_SIZE) : NULL;
+            if (json) {
+                memset(json, 0, JSON_BUFFER_SIZE);
+                build_chunk_json(channel, json, JSON_BUFFER_SIZE);
+                ESP_LOGI(TAG, "Sending JSON: %s", json);
+                ws_send_json(req, json);
+            }
         } else {
             ESP_LOGE(TAG, "ws_handler: data recv error: %d", ret);
         }
-        free(buf);
+        arena_reset(ARENA_WS);
     }
     return ESP_OK;
 }
@@ -176,6 +704,7 @@ esp_err_t ws_handler(httpd_req_t *req)
 httpd_handle_t start_webserver(void)
 {
     httpd_config_t config = HTTPD_DEFAULT_CONFIG();
+    config.max_uri_handlers = HTTP_MAX_URI_HANDLERS;
     httpd_handle_t server = NULL;
     if (httpd_start(&server, &config) == ESP_OK) {
         // /favicon.ico
@@ -210,6 +739,54 @@ httpd_handle_t start_webserver(void)
             .user_ctx = NULL
         };
         httpd_register_uri_handler(server, &wav_uri);
+        // /stats
+        httpd_uri_t stats_uri = {
+            .uri = "/stats",
+            .method = HTTP_GET,
+            .handler = stats_handler,
+            .user_ctx = NULL
+        };
+        httpd_register_uri_handler(server, &stats_uri);
+        // /zoom
+        httpd_uri_t zoom_uri = {
+            .uri = "/zoom",
+            .method = HTTP_GET,
+            .handler = zoom_handler,
+            .user_ctx = NULL
+        };
+        httpd_register_uri_handler(server, &zoom_uri);
+        // /fft
+        httpd_uri_t fft_uri = {
+            .uri = "/fft",
+            .method = HTTP_GET,
+            .handler = fft_size_handler,
+            .user_ctx = NULL
+        };
+        httpd_register_uri_handler(server, &fft_uri);
+        // /spectrum
+        httpd_uri_t spectrum_uri = {
+            .uri = "/spectrum",
+            .method = HTTP_GET,
+            .handler = spectrum_handler,
+            .user_ctx = NULL
+        };
+        httpd_register_uri_handler(server, &spectrum_uri);
+        // /spectrogram
+        httpd_uri_t spectrogram_uri = {
+            .uri = "/spectrogram",
+            .method = HTTP_GET,
+            .handler = spectrogram_handler,
+            .user_ctx = NULL
+        };
+        httpd_register_uri_handler(server, &spectrogram_uri);
+        // /history
+        httpd_uri_t history_uri = {
+            .uri = "/history",
+            .method = HTTP_GET,
+            .handler = history_handler,
+            .user_ctx = NULL
+        };
+        httpd_register_uri_handler(server, &history_uri);
         // /ws (WebSocket)
         httpd_uri_t ws_uri = {
             .uri = "/ws",
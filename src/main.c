@@ -28,7 +28,7 @@ void app_main()
 
     // 2) ADC / FFT init
     configure_adc_continuous();
-    xTaskCreate(collect_adc_continuous_data, "ADC_Task", 4096, NULL, 5, NULL);
+    start_adc_fft_tasks();
 
     // 3) Start the web server
     start_webserver();
@@ -0,0 +1,203 @@
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "esp_log.h"
+#include "esp_heap_caps.h"
+#include "esp_dsp.h"
+#include "fft_plan.h"
+#include "frame_load.h"
+#include "peak_interp.h"
+
+static const char *TAG = "PEAK_INTERP";
+
+// Größter Frame-Abstand des Phase-Vocoders (eindeutig bis +-2/3 Bin)
+#define VOCODER_MAX_GAP(fft_size) ((uint32_t)(fft_size) * 3 / 4)
+
+static const char *const estimator_names[PEAK_EST_COUNT] = {
+    "none", "quadratic", "gaussian", "jacobsen", "phase vocoder",
+};
+
+const char *peak_estimator_name(peak_estimator_t est)
+{
+    return ((unsigned)est < PEAK_EST_COUNT) ? estimator_names[est] : "?";
+}
+
+static inline float clamp_offset(float delta)
+{
+    if (!(delta > -1.0f)) {   // auch NaN
+        return (delta < 0.0f) ? -1.0f : 0.0f;
+    }
+    return (delta > 1.0f) ? 1.0f : delta;
+}
+
+static inline float wrap_phase(float phase)
+{
+    return phase - 2.0f * (float)M_PI * floorf(phase / (2.0f * (float)M_PI) + 0.5f);
+}
+
+float peak_interp_offset(peak_estimator_t est, const float *spectrum, int k, float jacobsen_q)
+{
+    const float *l = spectrum + 2 * (k - 1);
+    const float *c = spectrum + 2 * k;
+    const float *r = spectrum + 2 * (k + 1);
+    float delta = 0.0f;
+
+    switch (est) {
+    case PEAK_EST_QUADRATIC: {
+        float ml = sqrtf(l[0] * l[0] + l[1] * l[1]);
+        float mc = sqrtf(c[0] * c[0] + c[1] * c[1]);
+        float mr = sqrtf(r[0] * r[0] + r[1] * r[1]);
+        float den = 2.0f * (2.0f * mc - ml - mr);
+        delta = (den > 0.0f) ? (mr - ml) / den : 0.0f;
+        break;
+    }
+    case PEAK_EST_GAUSSIAN: {
+        // ln|X| = ln(|X|^2) / 2, der Faktor kürzt sich heraus; +1e-20 gegen ln(0)
+        float gl = logf(l[0] * l[0] + l[1] * l[1] + 1e-20f);
+        float gc = logf(c[0] * c[0] + c[1] * c[1] + 1e-20f);
+        float gr = logf(r[0] * r[0] + r[1] * r[1] + 1e-20f);
+        float den = 2.0f * (2.0f * gc - gl - gr);
+        delta = (den > 0.0f) ? (gr - gl) / den : 0.0f;
+        break;
+    }
+    case PEAK_EST_JACOBSEN:
+    case PEAK_EST_PHASE_VOCODER: {
+        // delta = Q * Re[(X[k-1] - X[k+1]) / (2 X[k] - X[k-1] - X[k+1])]
+        float num_re = l[0] - r[0], num_im = l[1] - r[1];
+        float den_re = 2.0f * c[0] - l[0] - r[0], den_im = 2.0f * c[1] - l[1] - r[1];
+        float den = den_re * den_re + den_im * den_im;
+        delta = (den > 0.0f) ? jacobsen_q * (num_re * den_re + num_im * den_im) / den : 0.0f;
+        break;
+    }
+    default:
+        break;
+    }
+    return clamp_offset(delta);
+}
+
+bool peak_interp_vocoder(peak_track_t *track, const float *spectrum, int k, int fft_bin, int fft_size,
+                         uint32_t pos, float *offset)
+{
+    bool ok = false;
+    uint32_t gap = pos - track->pos;
+    int j = k - track->bin + 1;
+    if (track->valid && gap > 0 && gap <= VOCODER_MAX_GAP(fft_size) && j >= 0 && j < PEAK_TRACK_BINS) {
+        // Phasenfortschritt X[k] * conj(X_alt[k]) gegenüber dem Fortschritt der Bin-Mitte
+        float re = spectrum[2 * k] * track->re[j] + spectrum[2 * k + 1] * track->im[j];
+        float im = spectrum[2 * k + 1] * track->re[j] - spectrum[2 * k] * track->im[j];
+        float expected = 2.0f * (float)M_PI * (float)fft_bin * (float)(gap % (uint32_t)fft_size) / fft_size;
+        float deviation = wrap_phase(atan2f(im, re) - wrap_phase(expected));
+        *offset = clamp_offset(deviation * fft_size / (2.0f * (float)M_PI * gap));
+        ok = true;
+    }
+
+    track->valid = true;
+    track->bin = k;
+    track->pos = pos;
+    for (int i = 0; i < PEAK_TRACK_BINS; i++) {
+        track->re[i] = spectrum[2 * (k - 1 + i)];
+        track->im[i] = spectrum[2 * (k - 1 + i) + 1];
+    }
+    return ok;
+}
+
+static float *alloc_floats(int count)
+{
+    return (float *)heap_caps_aligned_alloc(16, count * sizeof(float), MALLOC_CAP_8BIT);
+}
+
+// Stärkster Bin in spectrum[from..to] (interleaved re/im)
+static int peak_bin(const float *spectrum, int from, int to)
+{
+    int best = from;
+    float best_power = -1.0f;
+    for (int k = from; k <= to; k++) {
+        float p = spectrum[2 * k] * spectrum[2 * k] + spectrum[2 * k + 1] * spectrum[2 * k + 1];
+        if (p > best_power) {
+            best_power = p;
+            best = k;
+        }
+    }
+    return best;
+}
+
+#define PEAK_BENCHMARK_TONES 32
+
+void peak_interp_benchmark(float sample_rate, float low_hz, float high_hz, int min_size, int max_size)
+{
+    for (int size = min_size; size <= max_size; size *= 2) {
+        fft_plan_t plan;
+        memset(&plan, 0, sizeof(plan));
+        int len = size + size / 2;   // zwei Frames mit 50 % Überlappung
+        float *tone = alloc_floats(len);
+        int16_t *x = (int16_t *)heap_caps_malloc(len * sizeof(int16_t), MALLOC_CAP_8BIT);
+        if (!tone || !x || fft_plan_init(&plan, size, FFT_PLAN_REAL) != ESP_OK) {
+            ESP_LOGE(TAG, "Benchmark: setup failed (N=%d)", size);
+            heap_caps_free(tone);
+            heap_caps_free(x);
+            fft_plan_deinit(&plan);
+            return;
+        }
+
+        float bin_width = sample_rate / size;
+        int from = (int)ceilf(low_hz / bin_width);
+        int to = (int)floorf(high_hz / bin_width);
+        float err_sum[PEAK_EST_COUNT] = {0}, err_max[PEAK_EST_COUNT] = {0};
+        uint32_t cycles[PEAK_EST_COUNT] = {0}, fft_cycles = 0;
+
+        for (int t = 0; t < PEAK_BENCHMARK_TONES; t++) {
+            // Töne mit beliebiger Lage zwischen den Bins, Amplitude 600 auf ADC-Offset 2048 mit leichtem Rauschen
+            float f = low_hz + (t + 0.5f + 0.4f * ((rand() & 0xFF) / 255.0f - 0.5f)) *
+                      (high_hz - low_hz) / PEAK_BENCHMARK_TONES;
+            dsps_tone_gen_f32(tone, len, 600.0f, f / sample_rate, (float)(rand() % 360));
+            for (int i = 0; i < len; i++) {
+                x[i] = 2048 + (int16_t)lrintf(tone[i]) + (int16_t)((rand() & 0x1F) - 0x10);
+            }
+
+            peak_track_t track = {0};
+            float delta[PEAK_EST_COUNT] = {0};
+            int k = 0;
+            for (int frame = 0; frame < 2; frame++) {
+                uint32_t start = dsp_get_cpu_cycle_count();
+                frame_load_s16(x + frame * size / 2, plan.window, plan.fft_input, size, 1);
+                fft_plan_execute(&plan);
+                fft_cycles += dsp_get_cpu_cycle_count() - start;
+                k = peak_bin(plan.fft_input, from, to);
+                if (k < 1 || k > size / 2 - 2) {
+                    break;
+                }
+                if (frame == 0) {
+                    // erster Frame nur als Vorgänger für den Phase-Vocoder
+                    peak_interp_vocoder(&track, plan.fft_input, k, k, size, 0, &delta[PEAK_EST_PHASE_VOCODER]);
+                    continue;
+                }
+                for (int est = PEAK_EST_QUADRATIC; est <= PEAK_EST_JACOBSEN; est++) {
+                    start = dsp_get_cpu_cycle_count();
+                    delta[est] = peak_interp_offset((peak_estimator_t)est, plan.fft_input, k, PEAK_JACOBSEN_Q_HANN);
+                    cycles[est] += dsp_get_cpu_cycle_count() - start;
+                }
+                start = dsp_get_cpu_cycle_count();
+                peak_interp_vocoder(&track, plan.fft_input, k, k, size, size / 2, &delta[PEAK_EST_PHASE_VOCODER]);
+                cycles[PEAK_EST_PHASE_VOCODER] += dsp_get_cpu_cycle_count() - start;
+            }
+
+            for (int est = 0; est < PEAK_EST_COUNT; est++) {
+                float err = fabsf((k + delta[est]) * bin_width - f);
+                err_sum[est] += err;
+                err_max[est] = fmaxf(err_max[est], err);
+            }
+        }
+
+        ESP_LOGI(TAG, "N=%d (%.1f Hz bins, FFT %u cycles):", size, bin_width,
+                 (unsigned int)(fft_cycles / (2 * PEAK_BENCHMARK_TONES)));
+        for (int est = 0; est < PEAK_EST_COUNT; est++) {
+            ESP_LOGI(TAG, "  %-13s error %6.2f Hz avg / %6.2f Hz max, %u cycles", peak_estimator_name(est),
+                     err_sum[est] / PEAK_BENCHMARK_TONES, err_max[est],
+                     (unsigned int)(cycles[est] / PEAK_BENCHMARK_TONES));
+        }
+
+        heap_caps_free(tone);
+        heap_caps_free(x);
+        fft_plan_deinit(&plan);
+    }
+}
@@ -0,0 +1,62 @@
+#include <string.h>
+#include "sample_ring.h"
+
+void sample_ring_init(sample_ring_t *ring, int16_t *storage, uint32_t capacity, uint32_t frame_len)
+{
+    ring->data = storage;
+    ring->capacity = capacity;
+    ring->frame_len = frame_len;
+    ring->write_idx = 0;
+    memset(storage, 0, (capacity + frame_len) * sizeof(int16_t));
+}
+
+void sample_ring_write(sample_ring_t *ring, const int16_t *src, uint32_t n)
+{
+    // Mehr als capacity Samples: nur die jüngsten behalten
+    if (n > ring->capacity) {
+        src += n - ring->capacity;
+        n = ring->capacity;
+    }
+
+    while (n > 0) {
+        uint32_t idx = ring->write_idx;
+        uint32_t chunk = ring->capacity - idx;
+        if (chunk > n) {
+            chunk = n;
+        }
+        memcpy(ring->data + idx, src, chunk * sizeof(int16_t));
+
+        // Spiegelbereich: Samples am Anfang zusätzlich hinter das Ende kopieren
+        if (idx < ring->frame_len) {
+            uint32_t mirror = ring->frame_len - idx;
+            if (mirror > chunk) {
+                mirror = chunk;
+            }
+            memcpy(ring->data + ring->capacity + idx, src, mirror * sizeof(int16_t));
+        }
+
+        idx += chunk;
+        ring->write_idx = (idx == ring->capacity) ? 0 : idx;
+        src += chunk;
+        n -= chunk;
+    }
+}
+
+void sample_ring_commit(sample_ring_t *ring, uint32_t n)
+{
+    uint32_t idx = ring->write_idx;
+    uint32_t end = idx + n;
+
+    if (end > ring->capacity) {
+        // Überhang liegt bereits im Spiegelbereich (logische Indizes 0..spill-1)
+        uint32_t spill = end - ring->capacity;
+        memcpy(ring->data, ring->data + ring->capacity, spill * sizeof(int16_t));
+        end = ring->capacity;
+    }
+    if (idx < ring->frame_len) {
+        uint32_t mirror_end = (end < ring->frame_len) ? end : ring->frame_len;
+        memcpy(ring->data + ring->capacity + idx, ring->data + idx, (mirror_end - idx) * sizeof(int16_t));
+    }
+
+    ring->write_idx = (idx + n) % ring->capacity;
+}
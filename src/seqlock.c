@@ -0,0 +1,54 @@
+#include <string.h>
+#include "seqlock.h"
+
+void seqlock_init(seqlock_t *lock)
+{
+    atomic_init(&lock->seq, 0);
+}
+
+void seqlock_write_begin(seqlock_t *lock)
+{
+    uint32_t seq = atomic_load_explicit(&lock->seq, memory_order_relaxed);
+    atomic_store_explicit(&lock->seq, seq + 1, memory_order_relaxed);
+    // Die ungerade Nummer ist sichtbar, bevor sich die Daten ändern
+    atomic_thread_fence(memory_order_release);
+}
+
+void seqlock_write_end(seqlock_t *lock)
+{
+    uint32_t seq = atomic_load_explicit(&lock->seq, memory_order_relaxed);
+    // Release: Die Daten sind vollständig sichtbar, bevor die Nummer wieder gerade wird
+    atomic_store_explicit(&lock->seq, seq + 1, memory_order_release);
+}
+
+uint32_t seqlock_read_begin(seqlock_t *lock)
+{
+    return atomic_load_explicit(&lock->seq, memory_order_acquire);
+}
+
+bool seqlock_read_retry(seqlock_t *lock, uint32_t start)
+{
+    // Die Daten sind gelesen, bevor die Nummer erneut geladen wird
+    atomic_thread_fence(memory_order_acquire);
+    return (start & 1) != 0 || atomic_load_explicit(&lock->seq, memory_order_relaxed) != start;
+}
+
+bool seqlock_read(seqlock_t *lock, void *dst, const void *src, size_t size, int max_tries)
+{
+    for (int i = 0; i < max_tries; i++) {
+        uint32_t start = seqlock_read_begin(lock);
+        if (start & 1) {
+            continue;   // Schreiben läuft
+        }
+        memcpy(dst, src, size);
+        if (!seqlock_read_retry(lock, start)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+uint32_t seqlock_generation(seqlock_t *lock)
+{
+    return atomic_load_explicit(&lock->seq, memory_order_acquire) / 2;
+}
@@ -0,0 +1,259 @@
+#include <string.h>
+#include <math.h>
+#include <stdlib.h>
+#include "esp_log.h"
+#include "esp_heap_caps.h"
+#include "esp_dsp.h"
+#include "spectrogram.h"
+
+static const char *TAG = "SPECTROGRAM";
+
+// log2 in Q8 (1/256) aus Exponent und den oberen LOG_LUT_BITS Bits der Mantisse
+#define LOG_LUT_BITS 7
+static int16_t log_lut[1 << LOG_LUT_BITS];   // log2(1 + (i + 0.5) / 128) in Q8
+static bool log_lut_ready = false;
+
+// Stufen je log2-Einheit in Q16: 10 log10(2) / SPECTROGRAM_DB_STEP / 256 * 65536
+#define STEPS_PER_LOG2_Q16 ((int32_t)(3.0103f / SPECTROGRAM_DB_STEP / 256.0f * 65536.0f + 0.5f))
+
+static void init_log_lut(void)
+{
+    for (int i = 0; i < (1 << LOG_LUT_BITS); i++) {
+        log_lut[i] = (int16_t)lrintf(256.0f * log2f(1.0f + (i + 0.5f) / (1 << LOG_LUT_BITS)));
+    }
+    log_lut_ready = true;
+}
+
+static inline int32_t log2_q8(float x)
+{
+    uint32_t bits;
+    memcpy(&bits, &x, sizeof(bits));
+    int32_t e = (int32_t)((bits >> 23) & 0xFF) - 127;
+    return (e << 8) + log_lut[(bits >> (23 - LOG_LUT_BITS)) & ((1 << LOG_LUT_BITS) - 1)];
+}
+
+void spectrogram_quantize(const float *power, int n, float scale, uint8_t *out, float *top_db)
+{
+    float top = 0.0f;
+    for (int i = 0; i < n; i++) {
+        if (power[i] > top) {
+            top = power[i];
+        }
+    }
+    if (!(top > 0.0f)) {
+        memset(out, 0, n);
+        *top_db = -120.0f;
+        return;
+    }
+    *top_db = 10.0f * log10f(top * scale);
+
+    // Abstand zum Maximum in Stufen (gerundet); Leistungen <= 0 bzw. denormal liegen weit unter dem Maximum
+    int32_t top_q8 = log2_q8(top);
+    for (int i = 0; i < n; i++) {
+        int32_t below = (power[i] > 1e-30f)
+                        ? ((top_q8 - log2_q8(power[i])) * STEPS_PER_LOG2_Q16 + 0x8000) >> 16 : 255;
+        out[i] = (below >= 255) ? 0 : (uint8_t)(255 - below);
+    }
+}
+
+esp_err_t spectrogram_init(spectrogram_t *sg, int max_bins, int rows, int divider, float scale)
+{
+    memset(sg, 0, sizeof(*sg));
+    if (max_bins < 1 || rows < 2 || divider < 1) {
+        ESP_LOGE(TAG, "Invalid setup (%d bins, %d rows, divider %d)", max_bins, rows, divider);
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (!log_lut_ready) {
+        init_log_lut();
+    }
+    sg->bins = max_bins;
+    sg->max_bins = max_bins;
+    sg->rows = rows;
+    sg->row_size = (SPECTROGRAM_ROW_HEADER + max_bins + 3) & ~3;
+    sg->divider = divider;
+    sg->scale = scale;
+    sg->data = (uint8_t *)heap_caps_malloc_prefer((size_t)rows * sg->row_size, 2,
+                                                  MALLOC_CAP_SPIRAM, MALLOC_CAP_8BIT);
+    sg->acc = (float *)heap_caps_aligned_alloc(16, max_bins * sizeof(float), MALLOC_CAP_8BIT);
+    if (!sg->data || !sg->acc) {
+        ESP_LOGE(TAG, "Out of memory (%d rows of %d bytes)", rows, sg->row_size);
+        spectrogram_deinit(sg);
+        return ESP_ERR_NO_MEM;
+    }
+    for (int r = 0; r < rows; r++) {
+        uint32_t invalid = SPECTROGRAM_SEQ_INVALID;
+        memcpy(sg->data + (size_t)r * sg->row_size, &invalid, sizeof(invalid));
+    }
+    memset(sg->acc, 0, max_bins * sizeof(float));
+    ESP_LOGI(TAG, "Spectrogram ready (%d bins x %d rows, %d frames per row, %u bytes)",
+             max_bins, rows, divider, (unsigned int)(rows * sg->row_size));
+    return ESP_OK;
+}
+
+void spectrogram_deinit(spectrogram_t *sg)
+{
+    heap_caps_free(sg->data);
+    heap_caps_free(sg->acc);
+    memset(sg, 0, sizeof(*sg));
+}
+
+void spectrogram_reset(spectrogram_t *sg, int bins, float scale)
+{
+    if (bins < 1 || bins > sg->max_bins) {
+        bins = sg->max_bins;
+    }
+    memset(sg->acc, 0, sg->max_bins * sizeof(float));
+    sg->acc_count = 0;
+    sg->scale = scale;
+    __atomic_store_n(&sg->bins, bins, __ATOMIC_SEQ_CST);
+    __atomic_store_n(&sg->first_valid, sg->head, __ATOMIC_SEQ_CST);
+}
+
+int spectrogram_bins(const spectrogram_t *sg)
+{
+    return __atomic_load_n(&sg->bins, __ATOMIC_SEQ_CST);
+}
+
+// Schreibt die fertige Zeile aus acc in den Ring und beginnt eine neue.
+static void spectrogram_emit(spectrogram_t *sg)
+{
+    uint32_t seq = sg->head;
+    uint8_t *row = sg->data + (size_t)(seq % sg->rows) * sg->row_size;
+    uint32_t *row_seq = (uint32_t *)row;
+
+    // Zeile zuerst ungültig markieren, dann füllen, zuletzt die Nummer setzen
+    __atomic_store_n(row_seq, SPECTROGRAM_SEQ_INVALID, __ATOMIC_SEQ_CST);
+    float top_db;
+    spectrogram_quantize(sg->acc, sg->bins, sg->scale / sg->divider, row + SPECTROGRAM_ROW_HEADER, &top_db);
+    memset(row + SPECTROGRAM_ROW_HEADER + sg->bins, 0, sg->row_size - SPECTROGRAM_ROW_HEADER - sg->bins);
+    memcpy(row + 4, &top_db, sizeof(top_db));
+    __atomic_store_n(row_seq, seq, __ATOMIC_SEQ_CST);
+    __atomic_store_n(&sg->head, seq + 1, __ATOMIC_SEQ_CST);
+
+    memset(sg->acc, 0, sg->bins * sizeof(float));
+    sg->acc_count = 0;
+}
+
+bool spectrogram_push(spectrogram_t *sg, const float *power)
+{
+    return spectrogram_push_frames(sg, power, 1);
+}
+
+bool spectrogram_push_frames(spectrogram_t *sg, const float *power, int frames)
+{
+    bool completed = false;
+    while (frames > 0) {
+        int take = sg->divider - sg->acc_count;
+        if (take > frames) {
+            take = frames;
+        }
+        if (power && take == 1) {
+            dsps_add_f32(sg->acc, power, sg->acc, sg->bins, 1, 1, 1);
+        } else if (power) {
+            for (int i = 0; i < sg->bins; i++) {
+                sg->acc[i] += power[i] * take;
+            }
+        }
+        sg->acc_count += take;
+        frames -= take;
+        if (sg->acc_count == sg->divider) {
+            spectrogram_emit(sg);
+            completed = true;
+        }
+    }
+    return completed;
+}
+
+uint32_t spectrogram_head(const spectrogram_t *sg)
+{
+    return __atomic_load_n(&sg->head, __ATOMIC_SEQ_CST);
+}
+
+uint32_t spectrogram_oldest(const spectrogram_t *sg)
+{
+    uint32_t head = spectrogram_head(sg);
+    // die älteste Zeile kann gerade überschrieben werden, daher eine Zeile Abstand
+    uint32_t oldest = (head > (uint32_t)sg->rows - 1) ? head - (sg->rows - 1) : 0;
+    uint32_t first_valid = __atomic_load_n(&sg->first_valid, __ATOMIC_SEQ_CST);
+    return (first_valid > oldest) ? first_valid : oldest;
+}
+
+int spectrogram_read(const spectrogram_t *sg, uint32_t from, int count, uint8_t *out, uint32_t *first)
+{
+    uint32_t head = spectrogram_head(sg);
+    uint32_t oldest = spectrogram_oldest(sg);
+    if (from < oldest) {
+        from = oldest;
+    }
+    *first = from;
+
+    int copied = 0;
+    for (uint32_t seq = from; copied < count && seq < head; seq++) {
+        const uint8_t *row = sg->data + (size_t)(seq % sg->rows) * sg->row_size;
+        const uint32_t *row_seq = (const uint32_t *)row;
+        if (__atomic_load_n(row_seq, __ATOMIC_SEQ_CST) != seq) {
+            break;
+        }
+        memcpy(out + (size_t)copied * sg->row_size, row, sg->row_size);
+        if (__atomic_load_n(row_seq, __ATOMIC_SEQ_CST) != seq) {
+            break;   // während des Kopierens überschrieben
+        }
+        copied++;
+    }
+    if (copied == 0 && from < head) {
+        // die ersten Zeilen wurden überholt: neu ab der jetzt ältesten gültigen Zeile
+        return (spectrogram_head(sg) - from > (uint32_t)sg->rows - 1)
+               ? spectrogram_read(sg, spectrogram_head(sg) - (sg->rows - 1), count, out, first) : 0;
+    }
+    return copied;
+}
+
+void spectrogram_benchmark(int bins)
+{
+    if (!log_lut_ready) {
+        init_log_lut();
+    }
+    float *power = (float *)heap_caps_aligned_alloc(16, bins * sizeof(float), MALLOC_CAP_8BIT);
+    uint8_t *out = (uint8_t *)heap_caps_malloc(bins, MALLOC_CAP_8BIT);
+    if (!power || !out) {
+        ESP_LOGE(TAG, "Benchmark: out of memory");
+        heap_caps_free(power);
+        heap_caps_free(out);
+        return;
+    }
+    // Rauschen über 100 dB Dynamik mit einer Spitze
+    for (int i = 0; i < bins; i++) {
+        power[i] = powf(10.0f, (rand() % 1000) / 100.0f);
+    }
+    power[bins / 3] = 1e11f;
+
+    const int runs = 16;
+    float top_db;
+    uint32_t start = dsp_get_cpu_cycle_count();
+    for (int r = 0; r < runs; r++) {
+        spectrogram_quantize(power, bins, 1.0f, out, &top_db);
+    }
+    uint32_t lut_cycles = (dsp_get_cpu_cycle_count() - start) / runs;
+
+    volatile float sink = 0.0f;
+    start = dsp_get_cpu_cycle_count();
+    for (int r = 0; r < runs; r++) {
+        for (int i = 0; i < bins; i++) {
+            sink += 10.0f * log10f(power[i]);
+        }
+    }
+    uint32_t log_cycles = (dsp_get_cpu_cycle_count() - start) / runs;
+
+    float max_err = 0.0f;
+    for (int i = 0; i < bins; i++) {
+        float exact = 10.0f * log10f(power[i]);
+        float approx = top_db - (255 - out[i]) * SPECTROGRAM_DB_STEP;
+        if (out[i] > 0) {
+            max_err = fmaxf(max_err, fabsf(approx - exact));
+        }
+    }
+    ESP_LOGI(TAG, "Quantize %d bins: %u cycles (LUT) vs. %u cycles (log10f only), max error %.2f dB",
+             bins, (unsigned int)lut_cycles, (unsigned int)log_cycles, max_err);
+    heap_caps_free(power);
+    heap_caps_free(out);
+}
@@ -0,0 +1,139 @@
+#include <string.h>
+#include <float.h>
+#include "esp_log.h"
+#include "esp_heap_caps.h"
+#include "spectrum_avg.h"
+
+static const char *TAG = "SPECTRUM_AVG";
+
+static const char *const mode_names[SPECTRUM_AVG_COUNT] = { "avg", "exp", "peak", "min" };
+
+static float *alloc_floats(int count)
+{
+    return (float *)heap_caps_aligned_alloc(16, count * sizeof(float), MALLOC_CAP_8BIT);
+}
+
+esp_err_t spectrum_avg_init(spectrum_avg_t *avg, int bins, int linear_frames, float alpha)
+{
+    memset(avg, 0, sizeof(*avg));
+    if (bins < 1 || linear_frames < 1 || !(alpha > 0.0f && alpha <= 1.0f)) {
+        ESP_LOGE(TAG, "Invalid setup (%d bins, %d frames, alpha %.3f)", bins, linear_frames, alpha);
+        return ESP_ERR_INVALID_ARG;
+    }
+    avg->bins = bins;
+    avg->linear_frames = linear_frames;
+    avg->alpha = alpha;
+    avg->sum = alloc_floats(bins);
+    for (int m = 0; m < SPECTRUM_AVG_COUNT; m++) {
+        avg->out[m] = alloc_floats(bins);
+    }
+    for (int m = 0; m < SPECTRUM_AVG_COUNT; m++) {
+        if (!avg->out[m] || !avg->sum) {
+            spectrum_avg_deinit(avg);
+            return ESP_ERR_NO_MEM;
+        }
+    }
+    spectrum_avg_reset(avg);
+    ESP_LOGI(TAG, "Spectrum accumulator ready (%d bins, linear over %d frames, alpha %.3f)",
+             bins, linear_frames, alpha);
+    return ESP_OK;
+}
+
+void spectrum_avg_deinit(spectrum_avg_t *avg)
+{
+    heap_caps_free(avg->sum);
+    for (int m = 0; m < SPECTRUM_AVG_COUNT; m++) {
+        heap_caps_free(avg->out[m]);
+    }
+    memset(avg, 0, sizeof(*avg));
+}
+
+void spectrum_avg_reset(spectrum_avg_t *avg)
+{
+    memset(avg->sum, 0, avg->bins * sizeof(float));
+    memset(avg->out[SPECTRUM_AVG_LINEAR], 0, avg->bins * sizeof(float));
+    memset(avg->out[SPECTRUM_AVG_EXP], 0, avg->bins * sizeof(float));
+    memset(avg->out[SPECTRUM_AVG_PEAK], 0, avg->bins * sizeof(float));
+    for (int i = 0; i < avg->bins; i++) {
+        avg->out[SPECTRUM_AVG_MIN][i] = FLT_MAX;
+    }
+    avg->count = 0;
+    avg->frames = 0;
+    avg->blocks = 0;
+}
+
+void spectrum_avg_update(spectrum_avg_t *avg, const float *power, int first, int n)
+{
+    float *sum = avg->sum + first;
+    float *linear = avg->out[SPECTRUM_AVG_LINEAR] + first;
+    float *exp_avg = avg->out[SPECTRUM_AVG_EXP] + first;
+    float *peak = avg->out[SPECTRUM_AVG_PEAK] + first;
+    float *min = avg->out[SPECTRUM_AVG_MIN] + first;
+
+    // Lineare Mittelung: am Blockende Mittelwert ablegen und Summe neu beginnen
+    if (avg->count + 1 == avg->linear_frames) {
+        float scale = 1.0f / avg->linear_frames;
+        for (int i = 0; i < n; i++) {
+            linear[i] = (sum[i] + power[i]) * scale;
+            sum[i] = 0.0f;
+        }
+    } else {
+        for (int i = 0; i < n; i++) {
+            sum[i] += power[i];
+        }
+    }
+
+    // Exponentielle Mittelung (der erste Frame setzt den Startwert)
+    float alpha = (avg->frames == 0) ? 1.0f : avg->alpha;
+    for (int i = 0; i < n; i++) {
+        exp_avg[i] += alpha * (power[i] - exp_avg[i]);
+    }
+
+    for (int i = 0; i < n; i++) {
+        if (power[i] > peak[i]) {
+            peak[i] = power[i];
+        }
+        if (power[i] < min[i]) {
+            min[i] = power[i];
+        }
+    }
+}
+
+void spectrum_avg_commit(spectrum_avg_t *avg)
+{
+    avg->frames++;
+    if (++avg->count == avg->linear_frames) {
+        avg->count = 0;
+        avg->blocks++;
+    }
+}
+
+void spectrum_avg_read(const spectrum_avg_t *avg, spectrum_avg_mode_t mode, int first, int n, float *out)
+{
+    if (mode == SPECTRUM_AVG_LINEAR && avg->blocks == 0) {
+        // noch kein vollständiger Block: laufender Mittelwert
+        float scale = (avg->count > 0) ? 1.0f / avg->count : 0.0f;
+        for (int i = 0; i < n; i++) {
+            out[i] = avg->sum[first + i] * scale;
+        }
+    } else if (mode == SPECTRUM_AVG_MIN && avg->frames == 0) {
+        memset(out, 0, n * sizeof(float));
+    } else {
+        memcpy(out, avg->out[mode] + first, n * sizeof(float));
+    }
+}
+
+const char *spectrum_avg_mode_name(spectrum_avg_mode_t mode)
+{
+    return ((unsigned)mode < SPECTRUM_AVG_COUNT) ? mode_names[mode] : "?";
+}
+
+int spectrum_avg_mode_from_name(const char *name)
+{
+    for (int m = 0; m < SPECTRUM_AVG_COUNT; m++) {
+        if (strcmp(name, mode_names[m]) == 0) {
+            return m;
+        }
+    }
+    return -1;
+}
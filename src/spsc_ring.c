@@ -0,0 +1,46 @@
+#include "spsc_ring.h"
+
+bool spsc_ring_init(spsc_ring_t *ring, uint32_t *storage, uint32_t capacity)
+{
+    if (capacity == 0 || (capacity & (capacity - 1)) != 0) {
+        return false;
+    }
+    ring->slots = storage;
+    ring->mask = capacity - 1;
+    atomic_init(&ring->head, 0);
+    atomic_init(&ring->tail, 0);
+    return true;
+}
+
+bool spsc_ring_push(spsc_ring_t *ring, uint32_t value)
+{
+    uint32_t head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+    uint32_t tail = atomic_load_explicit(&ring->tail, memory_order_acquire);
+    if ((uint32_t)(head - tail) > ring->mask) {
+        return false;   // voll
+    }
+    ring->slots[head & ring->mask] = value;
+    // Release: Der Eintrag ist sichtbar, bevor der Konsument den neuen head sieht
+    atomic_store_explicit(&ring->head, head + 1, memory_order_release);
+    return true;
+}
+
+bool spsc_ring_pop(spsc_ring_t *ring, uint32_t *value)
+{
+    uint32_t tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+    uint32_t head = atomic_load_explicit(&ring->head, memory_order_acquire);
+    if (head == tail) {
+        return false;   // leer
+    }
+    *value = ring->slots[tail & ring->mask];
+    // Release: Der Slot darf erst nach dem Lesen wieder vom Produzenten belegt werden
+    atomic_store_explicit(&ring->tail, tail + 1, memory_order_release);
+    return true;
+}
+
+uint32_t spsc_ring_count(spsc_ring_t *ring)
+{
+    uint32_t head = atomic_load_explicit(&ring->head, memory_order_acquire);
+    uint32_t tail = atomic_load_explicit(&ring->tail, memory_order_acquire);
+    return head - tail;
+}
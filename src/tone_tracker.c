@@ -0,0 +1,322 @@
+#include <string.h>
+#include <math.h>
+#include "esp_log.h"
+#include "esp_heap_caps.h"
+#include "esp_dsp.h"
+#include "fft_plan.h"
+#include "frame_load.h"
+#include "tone_tracker.h"
+
+static const char *TAG = "TONE_TRACKER";
+
+// Dämpfung der gleitenden DFT: Rundungsfehler der Rekursion klingen mit 1 / (1 - r) Samples ab
+#define SLIDING_DAMPING 0.99999f
+
+// Glättung des DC-Schätzwerts (Anteil des neuen Blockmittelwerts)
+#define TRACKER_DC_ALPHA (1.0f / 16)
+
+static float *alloc_floats(int count)
+{
+    return (float *)heap_caps_aligned_alloc(16, count * sizeof(float), MALLOC_CAP_8BIT);
+}
+
+esp_err_t tone_tracker_init(tone_tracker_t *tracker, tone_tracker_mode_t mode, float sample_rate, int len,
+                            const float *freqs_hz, int num_tones, uint32_t max_in)
+{
+    memset(tracker, 0, sizeof(*tracker));
+    if (num_tones < 1 || num_tones > TONE_TRACKER_MAX_TONES || len < 16 || max_in < 1) {
+        ESP_LOGE(TAG, "Invalid tracker setup (%d tones, length %d)", num_tones, len);
+        return ESP_ERR_INVALID_ARG;
+    }
+    tracker->mode = mode;
+    tracker->sample_rate = sample_rate;
+    tracker->len = len;
+    tracker->num_tones = num_tones;
+    tracker->max_in = max_in;
+
+    tracker->x = alloc_floats(max_in);
+    if (mode == TONE_TRACKER_SLIDING) {
+        tracker->history = alloc_floats(len);
+    } else {
+        tracker->window = alloc_floats(len);
+    }
+    if (!tracker->x || (!tracker->history && !tracker->window)) {
+        tone_tracker_deinit(tracker);
+        return ESP_ERR_NO_MEM;
+    }
+
+    // Sinus der Amplitude A → |Y| = A / 2 * Fenstersumme (Sliding: gedämpftes Rechteckfenster)
+    float r = SLIDING_DAMPING;
+    float r_len = powf(r, len);
+    float weight = 0.0f;
+    if (mode == TONE_TRACKER_SLIDING) {
+        memset(tracker->history, 0, len * sizeof(float));
+        weight = (1.0f - r_len) / (1.0f - r);
+    } else {
+        dsps_wind_hann_f32(tracker->window, len);
+        for (int i = 0; i < len; i++) {
+            weight += tracker->window[i];
+        }
+    }
+    tracker->norm = 2.0f / weight;
+
+    for (int i = 0; i < num_tones; i++) {
+        tone_bin_t *bin = &tracker->tones[i];
+        if (!(freqs_hz[i] > 0.0f) || freqs_hz[i] >= sample_rate / 2) {
+            ESP_LOGE(TAG, "Invalid target frequency %.1f Hz", freqs_hz[i]);
+            tone_tracker_deinit(tracker);
+            return ESP_ERR_INVALID_ARG;
+        }
+        bin->omega = 2.0f * M_PI * freqs_hz[i] / sample_rate;
+        bin->coeff = 2.0f * cosf(bin->omega);
+        bin->rot_re = r * cosf(bin->omega);
+        bin->rot_im = r * sinf(bin->omega);
+        // w * len modulo 2 pi in double, damit die Phase auch bei großen Fenstern stimmt
+        double wl = fmod(2.0 * M_PI * freqs_hz[i] / sample_rate * len, 2.0 * M_PI);
+        bin->tail_re = r_len * (float)cos(wl);
+        bin->tail_im = r_len * (float)sin(wl);
+        bin->result.freq_hz = freqs_hz[i];
+    }
+
+    ESP_LOGI(TAG, "Tone tracker ready (%d tones, %s, %d samples)", num_tones,
+             mode == TONE_TRACKER_SLIDING ? "sliding DFT" : "Goertzel", len);
+    return ESP_OK;
+}
+
+void tone_tracker_deinit(tone_tracker_t *tracker)
+{
+    heap_caps_free(tracker->x);
+    heap_caps_free(tracker->window);
+    heap_caps_free(tracker->history);
+    memset(tracker, 0, sizeof(*tracker));
+}
+
+// Übernimmt Y = y_re + j y_im als neues Ergebnis eines Ziels (Samplezähler = jüngstes Sample + 1).
+static void publish(tone_tracker_t *tracker, tone_bin_t *bin, float y_re, float y_im, uint64_t sample)
+{
+    tone_result_t *res = &bin->result;
+    float phase = atan2f(y_im, y_re);
+
+    // Abweichung des Phasenfortschritts vom erwarteten w * Abstand → Frequenzabweichung
+    if (res->updates > 0) {
+        uint32_t distance = (uint32_t)(sample - bin->last_sample);
+        float expected = (float)fmod((double)bin->omega * distance, 2.0 * M_PI);
+        float delta = phase - res->phase - expected;
+        delta -= 2.0f * M_PI * floorf((delta + M_PI) / (2.0f * M_PI));
+        res->measured_hz = res->freq_hz + delta / (2.0f * M_PI * distance) * tracker->sample_rate;
+    }
+    res->amplitude = tracker->norm * sqrtf(y_re * y_re + y_im * y_im);
+    res->phase = phase;
+    res->updates++;
+    bin->last_sample = sample;
+}
+
+// Goertzel über n Samples; schließt den Block ab, wenn er len Samples erreicht.
+static void goertzel_chunk(tone_tracker_t *tracker, const float *x, uint32_t n)
+{
+    // Je zwei Ziele pro Durchlauf: die Rekursionen sind voneinander unabhängig und überlappen
+    int t = 0;
+    for (; t + 1 < tracker->num_tones; t += 2) {
+        tone_bin_t *a = &tracker->tones[t];
+        tone_bin_t *b = &tracker->tones[t + 1];
+        float ca = a->coeff, cb = b->coeff;
+        float a1 = a->s1, a2 = a->s2, b1 = b->s1, b2 = b->s2;
+        for (uint32_t i = 0; i < n; i++) {
+            float a0 = x[i] + ca * a1 - a2;
+            float b0 = x[i] + cb * b1 - b2;
+            a2 = a1;
+            a1 = a0;
+            b2 = b1;
+            b1 = b0;
+        }
+        a->s1 = a1;
+        a->s2 = a2;
+        b->s1 = b1;
+        b->s2 = b2;
+    }
+    if (t < tracker->num_tones) {
+        tone_bin_t *bin = &tracker->tones[t];
+        float coeff = bin->coeff;
+        float s1 = bin->s1, s2 = bin->s2;
+        for (uint32_t i = 0; i < n; i++) {
+            float s0 = x[i] + coeff * s1 - s2;
+            s2 = s1;
+            s1 = s0;
+        }
+        bin->s1 = s1;
+        bin->s2 = s2;
+    }
+
+    tracker->pos += n;
+    tracker->samples += n;
+    if (tracker->pos < (uint32_t)tracker->len) {
+        return;
+    }
+    // Y = s[N-1] - e^(-j w) s[N-2]
+    for (int t = 0; t < tracker->num_tones; t++) {
+        tone_bin_t *bin = &tracker->tones[t];
+        float y_re = bin->s1 - 0.5f * bin->coeff * bin->s2;
+        float y_im = sinf(bin->omega) * bin->s2;
+        publish(tracker, bin, y_re, y_im, tracker->samples);
+        bin->s1 = bin->s2 = 0.0f;
+    }
+    tracker->pos = 0;
+}
+
+// Gleitende DFT über n Samples (höchstens bis zum Ringende):
+// Y[n] = x[n] + r e^(jw) Y[n-1] - r^len e^(jw len) x[n-len]
+static void sliding_chunk(tone_tracker_t *tracker, const float *x, uint32_t n)
+{
+    const float *old = tracker->history + tracker->pos;
+    for (int t = 0; t < tracker->num_tones; t++) {
+        tone_bin_t *bin = &tracker->tones[t];
+        float rot_re = bin->rot_re, rot_im = bin->rot_im;
+        float tail_re = bin->tail_re, tail_im = bin->tail_im;
+        float y_re = bin->y_re, y_im = bin->y_im;
+        for (uint32_t i = 0; i < n; i++) {
+            float re = x[i] + rot_re * y_re - rot_im * y_im - tail_re * old[i];
+            y_im = rot_im * y_re + rot_re * y_im - tail_im * old[i];
+            y_re = re;
+        }
+        bin->y_re = y_re;
+        bin->y_im = y_im;
+    }
+    memcpy(tracker->history + tracker->pos, x, n * sizeof(float));
+    tracker->pos += n;
+    if (tracker->pos == (uint32_t)tracker->len) {
+        tracker->pos = 0;
+    }
+    tracker->samples += n;
+}
+
+void tone_tracker_process(tone_tracker_t *tracker, const int16_t *in, uint32_t n)
+{
+    while (n > 0) {
+        uint32_t block = (n > tracker->max_in) ? tracker->max_in : n;
+
+        // Gleichanteil entfernen (ADC-Offset würde über die Nebenzipfel des Rechteckfensters einstreuen)
+        int32_t sum = 0;
+        for (uint32_t i = 0; i < block; i++) {
+            sum += in[i];
+        }
+        float mean = (float)sum / block;
+        if (tracker->dc_valid) {
+            tracker->dc += (mean - tracker->dc) * TRACKER_DC_ALPHA;
+        } else {
+            tracker->dc = mean;
+            tracker->dc_valid = true;
+        }
+        for (uint32_t i = 0; i < block; i++) {
+            tracker->x[i] = in[i] - tracker->dc;
+        }
+
+        // Teilstücke bis zum Block- bzw. Ringende
+        float *x = tracker->x;
+        uint32_t left = block;
+        while (left > 0) {
+            uint32_t chunk = tracker->len - tracker->pos;
+            if (chunk > left) {
+                chunk = left;
+            }
+            if (tracker->mode == TONE_TRACKER_SLIDING) {
+                sliding_chunk(tracker, x, chunk);
+            } else {
+                // Fenster einmal je Sample statt je Ziel anwenden
+                dsps_mul_f32(x, tracker->window + tracker->pos, x, chunk, 1, 1, 1);
+                goertzel_chunk(tracker, x, chunk);
+            }
+            x += chunk;
+            left -= chunk;
+        }
+        if (tracker->mode == TONE_TRACKER_SLIDING && tracker->samples >= (uint64_t)tracker->len) {
+            for (int t = 0; t < tracker->num_tones; t++) {
+                tone_bin_t *bin = &tracker->tones[t];
+                publish(tracker, bin, bin->y_re, bin->y_im, tracker->samples);
+            }
+        }
+
+        in += block;
+        n -= block;
+    }
+}
+
+int tone_tracker_get(const tone_tracker_t *tracker, tone_result_t *out, int max)
+{
+    int n = (tracker->num_tones < max) ? tracker->num_tones : max;
+    for (int i = 0; i < n; i++) {
+        out[i] = tracker->tones[i].result;
+    }
+    return n;
+}
+
+void tone_tracker_benchmark(float sample_rate, int len, const float *freqs_hz, int num_tones, int fft_size)
+{
+    const int total = 16 * fft_size;
+    const int block = fft_size / 2;
+    tone_tracker_t goertzel, sliding;
+    fft_plan_t plan;
+    memset(&goertzel, 0, sizeof(goertzel));
+    memset(&sliding, 0, sizeof(sliding));
+    memset(&plan, 0, sizeof(plan));
+
+    float *tone = alloc_floats(total);
+    int16_t *x = (int16_t *)heap_caps_malloc(total * sizeof(int16_t), MALLOC_CAP_8BIT);
+    if (!tone || !x ||
+        tone_tracker_init(&goertzel, TONE_TRACKER_GOERTZEL, sample_rate, len, freqs_hz, num_tones, block) != ESP_OK ||
+        tone_tracker_init(&sliding, TONE_TRACKER_SLIDING, sample_rate, len, freqs_hz, num_tones, block) != ESP_OK ||
+        fft_plan_init(&plan, fft_size, FFT_PLAN_REAL) != ESP_OK) {
+        ESP_LOGE(TAG, "Benchmark: setup failed");
+        goto cleanup;
+    }
+
+    // Testsignal: jedes Ziel um 0,7 Hz verstimmt, Amplitude 300 auf ADC-Offset 2048
+    for (int i = 0; i < total; i++) {
+        x[i] = 2048;
+    }
+    for (int t = 0; t < num_tones; t++) {
+        dsps_tone_gen_f32(tone, total, 300.0f, (freqs_hz[t] + 0.7f) / sample_rate, 0.0f);
+        for (int i = 0; i < total; i++) {
+            x[i] += (int16_t)lrintf(tone[i]);
+        }
+    }
+
+    uint32_t start = dsp_get_cpu_cycle_count();
+    for (int i = 0; i < total; i += block) {
+        tone_tracker_process(&goertzel, x + i, block);
+    }
+    uint32_t goertzel_cycles = dsp_get_cpu_cycle_count() - start;
+
+    start = dsp_get_cpu_cycle_count();
+    for (int i = 0; i < total; i += block) {
+        tone_tracker_process(&sliding, x + i, block);
+    }
+    uint32_t sliding_cycles = dsp_get_cpu_cycle_count() - start;
+
+    int frames = 0;
+    start = dsp_get_cpu_cycle_count();
+    for (int i = 0; i + fft_size <= total; i += fft_size / 2, frames++) {
+        frame_load_s16(x + i, plan.window, plan.fft_input, fft_size, 1);
+        fft_plan_execute(&plan);
+    }
+    uint32_t fft_cycles = dsp_get_cpu_cycle_count() - start;
+
+    float seconds = total / sample_rate;
+    for (int t = 0; t < num_tones; t++) {
+        const tone_result_t *g = &goertzel.tones[t].result;
+        const tone_result_t *s = &sliding.tones[t].result;
+        ESP_LOGI(TAG, "%.1f Hz (+0.7 Hz, A=300): Goertzel A=%.1f f=%.2f, sliding A=%.1f f=%.2f",
+                 g->freq_hz, g->amplitude, g->measured_hz, s->amplitude, s->measured_hz);
+    }
+    ESP_LOGI(TAG, "Goertzel: %.2f Mcycles/s, %.0f results/s; sliding DFT: %.2f Mcycles/s, %.0f results/s "
+             "(%.0f/s possible); FFT N=%d: %.2f Mcycles/s, %.0f frames/s",
+             goertzel_cycles / seconds / 1e6f, sample_rate / len,
+             sliding_cycles / seconds / 1e6f, sample_rate / block, sample_rate,
+             fft_size, fft_cycles / seconds / 1e6f, frames / seconds);
+
+cleanup:
+    heap_caps_free(tone);
+    heap_caps_free(x);
+    tone_tracker_deinit(&goertzel);
+    tone_tracker_deinit(&sliding);
+    fft_plan_deinit(&plan);
+}
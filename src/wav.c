@@ -17,7 +17,7 @@ static const char *TAG = "WAV";
 
 // Function to create WAV header
 void generate_wav_header(uint8_t *header, uint32_t data_size) {
-    uint32_t sample_rate = SAMPLE_RATE;
+    uint32_t sample_rate = (uint32_t)ANALYSIS_SAMPLE_RATE;
     uint16_t bits_per_sample = 16;
     uint16_t num_channels = 1;
     uint32_t byte_rate = sample_rate * num_channels * (bits_per_sample / 8);
@@ -58,9 +58,10 @@ esp_err_t wav_download_handler(httpd_req_t *req) {
         return res;
     }
 
-    // Stream ADC data buffer-by-buffer
-    for (int i = 0; i < NUM_BUFFERS; i++) {
-        res = httpd_resp_send_chunk(req, (const char *)collected_data[i], FFT_SIZE * sizeof(int16_t));
+    // Stream ADC data of the first channel buffer-by-buffer, oldest buffer of the ring first
+    for (int n = 0; n < NUM_BUFFERS; n++) {
+        int i = (current_buffer_index + 1 + n) % NUM_BUFFERS;
+        res = httpd_resp_send_chunk(req, (const char *)collected_data[0][i], FFT_SIZE * sizeof(int16_t));
         if (res != ESP_OK) {
             ESP_LOGE(TAG, "Failed to send buffer %d", i);
             return res;
@@ -0,0 +1,206 @@
+#include <string.h>
+#include <math.h>
+#include "esp_log.h"
+#include "esp_heap_caps.h"
+#include "esp_dsp.h"
+#include "window.h"
+
+static const char *TAG = "WINDOW";
+
+// Bins je Seite, die für band_gain ausgewertet werden
+#define WINDOW_LOBE_BINS (WINDOW_GAIN_WIDTHS / 2)
+
+// band_gain des Hann-Fensters (Bins 0, +-1 mit den Beträgen 1 und 1/2, weiter außen 0)
+static const float hann_gain[2][4] = {
+    { 0.0f, 1.0f, 1.5f, 2.0f },
+    { 0.0f, 1.0f, 1.25f, 1.5f },
+};
+
+// Lage des Testtons für jacobsen_q (Bruchteil eines Bins neben Bin k)
+#define JACOBSEN_Q_OFFSET 0.25f
+
+typedef void (*window_fn_t)(float *window, int len);
+
+static const struct {
+    const char *name;
+    window_fn_t generate;
+} windows[WINDOW_COUNT] = {
+    [WINDOW_HANN]             = { "hann",             dsps_wind_hann_f32 },
+    [WINDOW_BLACKMAN]         = { "blackman",         dsps_wind_blackman_f32 },
+    [WINDOW_BLACKMAN_HARRIS]  = { "blackman-harris",  dsps_wind_blackman_harris_f32 },
+    [WINDOW_BLACKMAN_NUTTALL] = { "blackman-nuttall", dsps_wind_blackman_nuttall_f32 },
+    [WINDOW_NUTTALL]          = { "nuttall",          dsps_wind_nuttall_f32 },
+    [WINDOW_FLAT_TOP]         = { "flattop",          dsps_wind_flat_top_f32 },
+};
+
+const char *window_name(window_type_t type)
+{
+    return ((unsigned)type < WINDOW_COUNT) ? windows[type].name : "?";
+}
+
+int window_from_name(const char *name)
+{
+    for (int t = 0; t < WINDOW_COUNT; t++) {
+        if (strcmp(name, windows[t].name) == 0) {
+            return t;
+        }
+    }
+    return -1;
+}
+
+// Spektrum des Fensters bei offset Bins (DTFT): Σ w[n] e^(-j 2π offset n / N), Zeiger per Rotation
+static void window_dtft(const float *w, int n, float offset, double *re, double *im)
+{
+    double step = -2.0 * M_PI * offset / n;
+    double rot_re = cos(step), rot_im = sin(step);
+    double p_re = 1.0, p_im = 0.0;
+    double sum_re = 0.0, sum_im = 0.0;
+    for (int i = 0; i < n; i++) {
+        sum_re += w[i] * p_re;
+        sum_im += w[i] * p_im;
+        double t = p_re * rot_re - p_im * rot_im;
+        p_im = p_re * rot_im + p_im * rot_re;
+        p_re = t;
+    }
+    *re = sum_re;
+    *im = sum_im;
+}
+
+// Kenngrößen aus der ungenormten Tabelle (einmalig je Tabelle, O(N * Bins))
+static void window_measure(window_table_t *win)
+{
+    const float *w = win->table;
+    int n = win->size;
+    double sum = 0.0, sum_sq = 0.0;
+    for (int i = 0; i < n; i++) {
+        sum += w[i];
+        sum_sq += (double)w[i] * w[i];
+    }
+    win->coherent_gain = (float)(sum / n);
+    win->enbw = (float)(n * sum_sq / (sum * sum));
+
+    // Ton in Bin-Mitte: Bins 0, +-1, +-2, ... nacheinander aufsummieren (gerade Breiten: eine Seite mehr)
+    double mag[WINDOW_LOBE_BINS + 1];
+    double re, im;
+    for (int k = 0; k <= WINDOW_LOBE_BINS; k++) {
+        window_dtft(w, n, (float)k, &re, &im);
+        mag[k] = sqrt(re * re + im * im) / sum;
+    }
+    double mag_sum = 0.0, pow_sum = 0.0;
+    win->band_gain[0][0] = win->band_gain[1][0] = 0.0f;
+    for (int width = 1; width <= WINDOW_GAIN_WIDTHS; width++) {
+        double m = mag[width / 2];
+        mag_sum += m;
+        pow_sum += m * m;
+        win->band_gain[0][width] = (float)mag_sum;
+        win->band_gain[1][width] = (float)pow_sum;
+    }
+
+    // Ton bei Bin k + d: X[k + m] = W(m - d); Q gleicht den Jacobsen-Schätzer an d an
+    double l_re, l_im, c_re, c_im, r_re, r_im;
+    const float d = JACOBSEN_Q_OFFSET;
+    window_dtft(w, n, -1.0f - d, &l_re, &l_im);
+    window_dtft(w, n, -d, &c_re, &c_im);
+    window_dtft(w, n, 1.0f - d, &r_re, &r_im);
+    double num_re = l_re - r_re, num_im = l_im - r_im;
+    double den_re = 2.0 * c_re - l_re - r_re, den_im = 2.0 * c_im - l_im - r_im;
+    double raw = (num_re * den_re + num_im * den_im) / (den_re * den_re + den_im * den_im);
+    win->jacobsen_q = (raw > 0.0) ? (float)(d / raw) : 1.0f;
+}
+
+esp_err_t window_table_init(window_table_t *win, window_type_t type, int size, float scale)
+{
+    memset(win, 0, sizeof(*win));
+    if ((unsigned)type >= WINDOW_COUNT || size < 16) {
+        ESP_LOGE(TAG, "Invalid window %d (N=%d)", (int)type, size);
+        return ESP_ERR_INVALID_ARG;
+    }
+    win->table = (float *)heap_caps_aligned_alloc(16, size * sizeof(float), MALLOC_CAP_8BIT);
+    if (!win->table) {
+        return ESP_ERR_NO_MEM;
+    }
+    win->type = type;
+    win->size = size;
+    windows[type].generate(win->table, size);
+    window_measure(win);
+    dsps_mulc_f32(win->table, win->table, size, scale / win->coherent_gain, 1, 1);
+
+    ESP_LOGI(TAG, "Window %s (N=%d): coherent gain %.3f, ENBW %.3f bins, Jacobsen Q %.3f",
+             windows[type].name, size, win->coherent_gain, win->enbw, win->jacobsen_q);
+    return ESP_OK;
+}
+
+float window_hann_gain(int width, bool power)
+{
+    return (width < 1) ? 0.0f : hann_gain[power][(width < 3) ? width : 3];
+}
+
+float window_band_norm(const window_table_t *win, int width, bool power)
+{
+    if (width < 1) {
+        return 1.0f;
+    }
+    return window_hann_gain(width, power) /
+           win->band_gain[power][(width < WINDOW_GAIN_WIDTHS) ? width : WINDOW_GAIN_WIDTHS];
+}
+
+void window_table_deinit(window_table_t *win)
+{
+    heap_caps_free(win->table);
+    memset(win, 0, sizeof(*win));
+}
+
+void window_cache_init(window_cache_t *cache, float scale)
+{
+    memset(cache, 0, sizeof(*cache));
+    cache->scale = scale;
+}
+
+esp_err_t window_cache_get(window_cache_t *cache, window_type_t type, int size,
+                           const window_table_t *keep, const window_table_t **out)
+{
+    cache->clock++;
+    int slot = -1;
+    for (int i = 0; i < WINDOW_CACHE_SLOTS; i++) {
+        window_table_t *win = &cache->tables[i];
+        if (win->size == size && win->type == type) {
+            cache->last_used[i] = cache->clock;
+            cache->hits++;
+            *out = win;
+            return ESP_OK;
+        }
+        // freier Platz, sonst der am längsten nicht benutzte (außer keep)
+        if (win != keep && (slot < 0 || (cache->tables[slot].size != 0 &&
+                            (win->size == 0 || cache->last_used[i] < cache->last_used[slot])))) {
+            slot = i;
+        }
+    }
+    cache->misses++;
+    if (slot < 0) {
+        return ESP_ERR_NO_MEM;
+    }
+
+    // Neue Tabelle zuerst ohne Verdrängung berechnen; reicht der Speicher nicht, den Platz freigeben
+    window_table_t win;
+    esp_err_t ret = window_table_init(&win, type, size, cache->scale);
+    if (ret == ESP_ERR_NO_MEM && cache->tables[slot].size != 0) {
+        window_table_deinit(&cache->tables[slot]);
+        ret = window_table_init(&win, type, size, cache->scale);
+    }
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    window_table_deinit(&cache->tables[slot]);
+    cache->tables[slot] = win;
+    cache->last_used[slot] = cache->clock;
+    *out = &cache->tables[slot];
+    return ESP_OK;
+}
+
+void window_cache_deinit(window_cache_t *cache)
+{
+    for (int i = 0; i < WINDOW_CACHE_SLOTS; i++) {
+        window_table_deinit(&cache->tables[i]);
+    }
+    memset(cache, 0, sizeof(*cache));
+}
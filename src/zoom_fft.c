@@ -0,0 +1,362 @@
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "esp_log.h"
+#include "esp_heap_caps.h"
+#include "esp_dsp.h"
+#include "decimator.h"
+#include "frame_load.h"
+#include "zoom_fft.h"
+
+static const char *TAG = "ZOOM_FFT";
+
+// Glättung des DC-Schätzwerts (Anteil des neuen Blockmittelwerts)
+#define ZOOM_DC_ALPHA (1.0f / 16)
+
+// Länge der Oszillatortabelle (dsps_cplx_gen, 256..8192)
+#define ZOOM_LO_LUT_LEN 4096
+
+static float *alloc_floats(int count)
+{
+    return (float *)heap_caps_aligned_alloc(16, count * sizeof(float), MALLOC_CAP_8BIT);
+}
+
+esp_err_t zoom_fft_init(zoom_fft_t *zoom, int fft_size, float sample_rate, int max_factor,
+                        int taps_per_factor, uint32_t max_in)
+{
+    memset(zoom, 0, sizeof(*zoom));
+    if (max_factor < 1 || taps_per_factor < 4 || (taps_per_factor % 4) != 0) {
+        ESP_LOGE(TAG, "Invalid zoom setup (max factor %d, %d taps per factor)", max_factor, taps_per_factor);
+        return ESP_ERR_INVALID_ARG;
+    }
+    zoom->sample_rate = sample_rate;
+    zoom->max_factor = max_factor;
+    zoom->taps_per_factor = taps_per_factor;
+    zoom->max_in = max_in;
+
+    esp_err_t ret = fft_plan_init(&zoom->plan, fft_size, FFT_PLAN_IQ);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    // Beim Mischen eines reellen Signals landet die halbe Amplitude im Basisband; der Faktor 2 im
+    // Fenster gleicht das aus (gleiche Skalierung wie der Real-Pfad von fft_plan)
+    dsps_mulc_f32(zoom->plan.window, zoom->plan.window, fft_size, 2.0f, 1, 1);
+
+    int max_taps = taps_per_factor * max_factor;
+    zoom->coeffs   = alloc_floats(max_taps);
+    zoom->delay_i  = alloc_floats(max_taps);
+    zoom->delay_q  = alloc_floats(max_taps);
+    zoom->lo_buf   = alloc_floats(2 * max_in);
+    zoom->in       = alloc_floats(max_in);
+    zoom->mix_i    = alloc_floats(max_in + max_factor);
+    zoom->mix_q    = alloc_floats(max_in + max_factor);
+    zoom->dec_i    = alloc_floats(max_in + 1);
+    zoom->dec_q    = alloc_floats(max_in + 1);
+    zoom->baseband = alloc_floats(2 * fft_size);
+    if (!zoom->coeffs || !zoom->delay_i || !zoom->delay_q || !zoom->lo_buf || !zoom->in ||
+        !zoom->mix_i || !zoom->mix_q || !zoom->dec_i || !zoom->dec_q || !zoom->baseband) {
+        zoom_fft_deinit(zoom);
+        return ESP_ERR_NO_MEM;
+    }
+
+    ret = dsps_cplx_gen_init(&zoom->lo, F32_FLOAT, NULL, ZOOM_LO_LUT_LEN, 0.0f, 0.0f);
+    if (ret != ESP_OK) {
+        zoom_fft_deinit(zoom);
+        return ret;
+    }
+    return ESP_OK;
+}
+
+void zoom_fft_deinit(zoom_fft_t *zoom)
+{
+    cplx_gen_free(&zoom->lo);
+    fft_plan_deinit(&zoom->plan);
+    heap_caps_free(zoom->coeffs);
+    heap_caps_free(zoom->delay_i);
+    heap_caps_free(zoom->delay_q);
+    heap_caps_free(zoom->lo_buf);
+    heap_caps_free(zoom->in);
+    heap_caps_free(zoom->mix_i);
+    heap_caps_free(zoom->mix_q);
+    heap_caps_free(zoom->dec_i);
+    heap_caps_free(zoom->dec_q);
+    heap_caps_free(zoom->baseband);
+    memset(zoom, 0, sizeof(*zoom));
+}
+
+esp_err_t zoom_fft_select_factor(float sample_rate, float low_hz, float high_hz, int factor,
+                                 int max_factor, int *out_factor)
+{
+    if (!(low_hz >= 0.0f) || !(high_hz > low_hz) || high_hz >= sample_rate / 2) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    // Das Band muss nach der Dezimierung in den nutzbaren Teil des Basisbands passen
+    int limit = (int)(ZOOM_FFT_USABLE_BW * sample_rate / (high_hz - low_hz));
+    if (limit > max_factor) {
+        limit = max_factor;
+    }
+    if (factor == 0) {
+        factor = limit;
+    }
+    if (factor < 1 || factor > limit) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    *out_factor = factor;
+    return ESP_OK;
+}
+
+esp_err_t zoom_fft_configure(zoom_fft_t *zoom, float low_hz, float high_hz, int factor)
+{
+    esp_err_t ret = zoom_fft_select_factor(zoom->sample_rate, low_hz, high_hz, factor,
+                                           zoom->max_factor, &factor);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Invalid zoom band %.1f..%.1f Hz", low_hz, high_hz);
+        return ret;
+    }
+    zoom->low_hz = low_hz;
+    zoom->high_hz = high_hz;
+    zoom->center_hz = (low_hz + high_hz) / 2;
+    zoom->factor = factor;
+    zoom->bin_width = zoom->sample_rate / factor / zoom->plan.fft_size;
+
+    // Tiefpass mit Grenzfrequenz = halbe Basisband-Abtastrate, gemeinsam für I und Q
+    int taps = zoom->taps_per_factor * factor;
+    decimator_design_lowpass(zoom->coeffs, taps, 0.5f / factor);
+    ret = dsps_fird_init_f32(&zoom->fir_i, zoom->coeffs, zoom->delay_i, taps, factor);
+    if (ret == ESP_OK) {
+        ret = dsps_fird_init_f32(&zoom->fir_q, zoom->coeffs, zoom->delay_q, taps, factor);
+    }
+    if (ret == ESP_OK) {
+        // Phase in Umdrehungen pro Sample, negative Frequenz → Mischen nach unten
+        ret = dsps_cplx_gen_set(&zoom->lo, -zoom->center_hz / zoom->sample_rate, 0.0f);
+    }
+    if (ret != ESP_OK) {
+        return ret;
+    }
+
+    zoom->dc_valid = false;
+    zoom->in_len = 0;
+    zoom->bb_write = 0;
+    zoom->bb_filled = 0;
+    zoom->bb_new = 0;
+
+    ESP_LOGI(TAG, "Zoom band %.1f..%.1f Hz, factor %d, %d taps, %.2f Hz bins",
+             low_hz, high_hz, factor, taps, zoom->bin_width);
+    return ESP_OK;
+}
+
+// Mischt und dezimiert einen Block von n (<= max_in) Samples.
+static void zoom_fft_push_block(zoom_fft_t *zoom, const int16_t *in, uint32_t n)
+{
+    // Gleichanteil entfernen (sonst liegt der ADC-Offset nach dem Mischen bei -center_hz im Basisband)
+    int32_t sum = 0;
+    for (uint32_t i = 0; i < n; i++) {
+        sum += in[i];
+    }
+    float mean = (float)sum / n;
+    if (zoom->dc_valid) {
+        zoom->dc += (mean - zoom->dc) * ZOOM_DC_ALPHA;
+    } else {
+        zoom->dc = mean;
+        zoom->dc_valid = true;
+    }
+    for (uint32_t i = 0; i < n; i++) {
+        zoom->in[i] = in[i] - zoom->dc;
+    }
+
+    // Oszillator für den Block; dsps_cplx_gen schreibt die Phase nicht zurück, daher hier fortschreiben
+    float *lo = zoom->lo_buf;
+    dsps_cplx_gen(&zoom->lo, lo, n);
+    float phase = zoom->lo.phase + zoom->lo.freq * n;
+    phase -= floorf(phase);
+    dsps_cplx_gen_phase_set(&zoom->lo, (phase < 1.0f) ? phase : 0.0f);
+
+    // x * e^(-j w t): I = x * cos, Q = x * (-sin), hinter den Rest des letzten Blocks
+    dsps_mul_f32(zoom->in, lo, zoom->mix_i + zoom->in_len, n, 1, 2, 1);
+    dsps_mul_f32(zoom->in, lo + 1, zoom->mix_q + zoom->in_len, n, 1, 2, 1);
+
+    uint32_t total = zoom->in_len + n;
+    uint32_t out_len = total / zoom->factor;
+    uint32_t used = out_len * zoom->factor;
+    dsps_fird_f32(&zoom->fir_i, zoom->mix_i, zoom->dec_i, out_len);
+    dsps_fird_f32(&zoom->fir_q, zoom->mix_q, zoom->dec_q, out_len);
+
+    zoom->in_len = total - used;
+    memmove(zoom->mix_i, zoom->mix_i + used, zoom->in_len * sizeof(float));
+    memmove(zoom->mix_q, zoom->mix_q + used, zoom->in_len * sizeof(float));
+
+    // Dezimierte Werte in den Basisband-Ring
+    uint32_t size = zoom->plan.fft_size;
+    uint32_t w = zoom->bb_write;
+    for (uint32_t i = 0; i < out_len; i++) {
+        zoom->baseband[2 * w + 0] = zoom->dec_i[i];
+        zoom->baseband[2 * w + 1] = zoom->dec_q[i];
+        w = (w + 1 == size) ? 0 : w + 1;
+    }
+    zoom->bb_write = w;
+    zoom->bb_filled = (zoom->bb_filled + out_len < size) ? zoom->bb_filled + out_len : size;
+    zoom->bb_new += out_len;
+    zoom->bb_count += out_len;
+}
+
+void zoom_fft_push(zoom_fft_t *zoom, const int16_t *in, uint32_t n)
+{
+    while (n > 0) {
+        uint32_t chunk = (n > zoom->max_in) ? zoom->max_in : n;
+        zoom_fft_push_block(zoom, in, chunk);
+        in += chunk;
+        n -= chunk;
+    }
+}
+
+float *zoom_fft_execute(zoom_fft_t *zoom)
+{
+    int size = zoom->plan.fft_size;
+    float *data = zoom->plan.fft_input;
+    const float *window = zoom->plan.window;
+
+    // Fenster über die letzten fft_size Werte (ab der ältesten Position im Ring)
+    uint32_t r = zoom->bb_write;
+    for (int i = 0; i < size; i++) {
+        data[2 * i + 0] = zoom->baseband[2 * r + 0] * window[i];
+        data[2 * i + 1] = zoom->baseband[2 * r + 1] * window[i];
+        r = (r + 1 == (uint32_t)size) ? 0 : r + 1;
+    }
+    fft_plan_execute(&zoom->plan);
+
+    // Negative Frequenzen (Bins size/2..size-1) vor die positiven tauschen
+    for (int i = 0; i < size; i++) {
+        float t = data[i];
+        data[i] = data[i + size];
+        data[i + size] = t;
+    }
+
+    zoom->bb_new = 0;
+    zoom->frame_pos = zoom->bb_count - size;
+    return data;
+}
+
+// Index des stärksten Bins in spectrum[from..to] (interleaved re/im)
+static int peak_bin(const float *spectrum, int from, int to)
+{
+    int best = from;
+    float best_power = -1.0f;
+    for (int k = from; k <= to; k++) {
+        float p = spectrum[2 * k] * spectrum[2 * k] + spectrum[2 * k + 1] * spectrum[2 * k + 1];
+        if (p > best_power) {
+            best_power = p;
+            best = k;
+        }
+    }
+    return best;
+}
+
+// Normale FFT (Real-Modus) über die letzten plan->fft_size Samples; liefert die Frequenz des stärksten Bins im Band.
+static float plain_peak(fft_plan_t *plan, const int16_t *x, float sample_rate, float low_hz,
+                        float high_hz, uint32_t *cycles)
+{
+    int size = plan->fft_size;
+    uint32_t start = dsp_get_cpu_cycle_count();
+    frame_load_s16(x, plan->window, plan->fft_input, size, 1);
+    fft_plan_execute(plan);
+    float bin_width = sample_rate / size;
+    int k = peak_bin(plan->fft_input, (int)ceilf(low_hz / bin_width), (int)floorf(high_hz / bin_width));
+    *cycles += dsp_get_cpu_cycle_count() - start;
+    return k * bin_width;
+}
+
+#define ZOOM_BENCHMARK_TONES 8
+
+void zoom_fft_benchmark(float sample_rate, int fft_size, float low_hz, float high_hz, int factor,
+                        int taps_per_factor, int plain_size)
+{
+    zoom_fft_t zoom;
+    fft_plan_t plain, wide;
+    int block = 256;
+    bool plain_ok = false, wide_ok = false;
+    memset(&plain, 0, sizeof(plain));
+    memset(&wide, 0, sizeof(wide));
+
+    if (zoom_fft_init(&zoom, fft_size, sample_rate, factor ? factor : 64, taps_per_factor, block) != ESP_OK ||
+        zoom_fft_configure(&zoom, low_hz, high_hz, factor) != ESP_OK) {
+        ESP_LOGE(TAG, "Benchmark: zoom setup failed");
+        zoom_fft_deinit(&zoom);
+        return;
+    }
+    factor = zoom.factor;
+
+    // Normale FFT mit gleicher Auflösung nur, wenn die Größe von fft_plan unterstützt wird
+    int wide_size = fft_size * factor;
+    plain_ok = fft_plan_init(&plain, plain_size, FFT_PLAN_REAL) == ESP_OK;
+    wide_ok = wide_size <= FFT_PLAN_MAX_SIZE && fft_plan_init(&wide, wide_size, FFT_PLAN_REAL) == ESP_OK;
+
+    // Signal: Einschwingen der Filter + ein voller Zoom-Frame
+    int len = taps_per_factor * factor + wide_size;
+    int16_t *x = (int16_t *)heap_caps_malloc(len * sizeof(int16_t), MALLOC_CAP_8BIT);
+    if (!x || !plain_ok) {
+        ESP_LOGE(TAG, "Benchmark: out of memory");
+        goto cleanup;
+    }
+
+    float zoom_err = 0, zoom_max = 0, plain_err = 0, plain_max = 0, wide_err = 0, wide_max = 0;
+    uint32_t push_cycles = 0, exec_cycles = 0, plain_cycles = 0, wide_cycles = 0;
+    for (int t = 0; t < ZOOM_BENCHMARK_TONES; t++) {
+        // Töne zwischen den Bins, leichtes Rauschen auf ADC-Offset 2048
+        float f = low_hz + (t + 0.37f) * (high_hz - low_hz) / ZOOM_BENCHMARK_TONES;
+        for (int i = 0; i < len; i++) {
+            x[i] = 2048 + (int16_t)lrintf(600.0f * sinf(2.0f * M_PI * f * i / sample_rate)) +
+                   (int16_t)((rand() & 0x3F) - 0x20);
+        }
+
+        zoom_fft_configure(&zoom, low_hz, high_hz, factor);
+        uint32_t start = dsp_get_cpu_cycle_count();
+        zoom_fft_push(&zoom, x, len);
+        push_cycles += dsp_get_cpu_cycle_count() - start;
+
+        start = dsp_get_cpu_cycle_count();
+        float *spectrum = zoom_fft_execute(&zoom);
+        float bin_from = (low_hz - zoom.center_hz) / zoom.bin_width + fft_size / 2;
+        float bin_to = (high_hz - zoom.center_hz) / zoom.bin_width + fft_size / 2;
+        int k = peak_bin(spectrum, (int)ceilf(bin_from), (int)floorf(bin_to));
+        exec_cycles += dsp_get_cpu_cycle_count() - start;
+
+        float err = fabsf(zoom_fft_bin_hz(&zoom, k) - f);
+        zoom_err += err;
+        zoom_max = fmaxf(zoom_max, err);
+
+        err = fabsf(plain_peak(&plain, x + len - plain_size, sample_rate, low_hz, high_hz, &plain_cycles) - f);
+        plain_err += err;
+        plain_max = fmaxf(plain_max, err);
+        if (wide_ok) {
+            err = fabsf(plain_peak(&wide, x + len - wide_size, sample_rate, low_hz, high_hz, &wide_cycles) - f);
+            wide_err += err;
+            wide_max = fmaxf(wide_max, err);
+        }
+    }
+
+    // Rechenzeit pro Sekunde Signal bei 50 % Überlappung: Eingangsstufe für jedes Sample,
+    // FFT alle fft_size / 2 Basisband-Werte bzw. alle plain_size / 2 Samples
+    float zoom_per_s = (float)push_cycles / (ZOOM_BENCHMARK_TONES * len) * sample_rate +
+                       (float)exec_cycles / ZOOM_BENCHMARK_TONES * sample_rate / (factor * fft_size / 2.0f);
+    float plain_per_s = (float)plain_cycles / ZOOM_BENCHMARK_TONES * sample_rate / (plain_size / 2.0f);
+    ESP_LOGI(TAG, "Zoom FFT (N=%d, factor %d, %.2f Hz bins): error %.2f Hz avg / %.2f Hz max, %.2f Mcycles/s",
+             fft_size, factor, zoom.bin_width, zoom_err / ZOOM_BENCHMARK_TONES, zoom_max, zoom_per_s / 1e6f);
+    ESP_LOGI(TAG, "Plain FFT (N=%d, %.2f Hz bins): error %.2f Hz avg / %.2f Hz max, %.2f Mcycles/s",
+             plain_size, sample_rate / plain_size, plain_err / ZOOM_BENCHMARK_TONES, plain_max, plain_per_s / 1e6f);
+    if (wide_ok) {
+        float wide_per_s = (float)wide_cycles / ZOOM_BENCHMARK_TONES * sample_rate / (wide_size / 2.0f);
+        ESP_LOGI(TAG, "Plain FFT (N=%d, same bins): error %.2f Hz avg / %.2f Hz max, %.2f Mcycles/s",
+                 wide_size, wide_err / ZOOM_BENCHMARK_TONES, wide_max, wide_per_s / 1e6f);
+    } else {
+        // Abschätzung über N log2 N aus der gemessenen normalen FFT
+        float scale = (float)wide_size * log2f(wide_size) / (plain_size * log2f(plain_size));
+        ESP_LOGI(TAG, "Plain FFT (N=%d, same bins): exceeds FFT_PLAN_MAX_SIZE, est. %.2f Mcycles/s",
+                 wide_size, plain_per_s * scale / 1e6f);
+    }
+
+cleanup:
+    heap_caps_free(x);
+    fft_plan_deinit(&plain);
+    fft_plan_deinit(&wide);
+    zoom_fft_deinit(&zoom);
+}
@@ -0,0 +1,35 @@
+# Prüft, dass src/ und include/ keine globalen esp-dsp-FFT-Einstiege benutzen (siehe fft_plan.h):
+#   cmake -DREPO_DIR=<repo> -P check_no_global_fft.cmake
+# Kommentarzeilen werden übersprungen, Zeilenkommentare abgeschnitten.
+set(FORBIDDEN
+    "dsps_(fft2r|fft4r|cplx2real)_fc32(_ansi|_ae32|_aes3|_arp4)?[ \t]*\\("
+    "dsps_fft[24]r_(init|deinit)_fc32"
+)
+
+file(GLOB SOURCES ${REPO_DIR}/src/*.c ${REPO_DIR}/src/*.h ${REPO_DIR}/include/*.h)
+set(found 0)
+foreach(source ${SOURCES})
+    file(STRINGS ${source} lines)
+    set(number 0)
+    foreach(line IN LISTS lines)
+        math(EXPR number "${number} + 1")
+        if(line MATCHES "^[ \t]*(\\*|/\\*|//)")
+            continue()
+        endif()
+        string(REGEX REPLACE "//.*$" "" code "${line}")
+        foreach(pattern ${FORBIDDEN})
+            if(code MATCHES "${pattern}")
+                message(SEND_ERROR "${source}:${number}: global esp-dsp FFT entry point: ${line}")
+                set(found 1)
+            endif()
+        endforeach()
+    endforeach()
+endforeach()
+
+list(LENGTH SOURCES count)
+if(count EQUAL 0)
+    message(FATAL_ERROR "no sources below ${REPO_DIR}")
+endif()
+if(NOT found)
+    message(STATUS "check_no_global_fft: OK (${count} files)")
+endif()
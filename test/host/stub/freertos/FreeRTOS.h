@@ -0,0 +1,5 @@
+#pragma once
+#include <stdint.h>
+typedef int BaseType_t;
+typedef unsigned int UBaseType_t;
+typedef uint32_t TickType_t;
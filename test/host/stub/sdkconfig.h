@@ -0,0 +1,7 @@
+#pragma once
+// Host-Build: nur die ANSI-Kernel von esp-dsp
+#define CONFIG_DSP_ANSI 1
+#define CONFIG_DSP_OPTIMIZED 0
+#define CONFIG_DSP_OPTIMIZATION 0
+#define CONFIG_DSP_MAX_FFT_SIZE_4096 1
+#define CONFIG_DSP_MAX_FFT_SIZE 4096
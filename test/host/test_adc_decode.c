@@ -0,0 +1,160 @@
+/*
+ * adc_decode (user-005): TYPE1-Dekodierung gegen eine einfache Referenz (ein Eintrag nach dem anderen).
+ * Abgedeckt: fremde Kanäle, ungerade Eintragsanzahl (Rest-Schleife), max_out-Grenze, *invalid und die
+ * Mehrkanal-Zuordnung mit Kanal-IDs außerhalb des Patterns. Die Ausgabepuffer sind genau max_out groß
+ * (ASan meldet Schreibzugriffe dahinter).
+ */
+#include <stdlib.h>
+#include <string.h>
+#include "adc_decode.h"
+#include "test_util.h"
+
+#define MAX_ENTRIES 257
+
+static inline uint16_t entry(uint8_t channel, uint16_t value)
+{
+    return (uint16_t)((channel << 12) | (value & 0x0FFF));
+}
+
+// Referenz: Einträge der Reihe nach, Abbruch sobald max_out erreicht ist
+static uint32_t reference(const uint16_t *e, uint32_t entries, uint8_t channel, int16_t *out,
+                          uint32_t max_out, uint32_t *invalid)
+{
+    uint32_t n = 0, i = 0;
+    for (; i < entries && n < max_out; i++) {
+        if ((e[i] >> 12) == channel) {
+            out[n++] = e[i] & 0x0FFF;
+        }
+    }
+    *invalid += i - n;
+    return n;
+}
+
+static void check_single(const uint16_t *e, uint32_t entries, uint8_t channel, uint32_t max_out)
+{
+    int16_t expected[MAX_ENTRIES];
+    uint32_t expected_invalid = 5;
+    uint32_t n_ref = reference(e, entries, channel, expected, max_out, &expected_invalid);
+
+    int16_t *out_s16 = malloc((max_out ? max_out : 1) * sizeof(int16_t));
+    float *out_f32 = malloc((max_out ? max_out : 1) * sizeof(float));
+    uint32_t invalid_s16 = 5, invalid_f32 = 5;
+    uint32_t n_s16 = adc_decode_type1_s16((const uint8_t *)e, entries * 2, channel, out_s16, max_out, &invalid_s16);
+    uint32_t n_f32 = adc_decode_type1_f32((const uint8_t *)e, entries * 2, channel, out_f32, max_out, &invalid_f32);
+
+    CHECK_EQ(n_s16, n_ref);
+    CHECK_EQ(n_f32, n_ref);
+    CHECK_EQ(invalid_s16, expected_invalid);
+    CHECK_EQ(invalid_f32, expected_invalid);
+    for (uint32_t i = 0; i < n_ref && i < n_s16 && i < n_f32; i++) {
+        CHECK_EQ(out_s16[i], expected[i]);
+        CHECK(out_f32[i] == (float)expected[i]);
+    }
+    free(out_s16);
+    free(out_f32);
+}
+
+static void test_fixed_cases(void)
+{
+    static uint32_t words[4];
+    uint16_t *e = (uint16_t *)words;
+
+    // fremde Kanäle in beiden Hälften eines 32-Bit-Worts, ungerade Anzahl (letzter Eintrag einzeln)
+    e[0] = entry(2, 100);
+    e[1] = entry(3, 200);
+    e[2] = entry(3, 300);
+    e[3] = entry(2, 4095);
+    e[4] = entry(2, 7);
+    int16_t out[3];
+    uint32_t invalid = 0;
+    CHECK_EQ(adc_decode_type1_s16((const uint8_t *)e, 5 * 2, 2, out, 3, &invalid), 3);
+    CHECK_EQ(out[0], 100);
+    CHECK_EQ(out[1], 4095);
+    CHECK_EQ(out[2], 7);
+    CHECK_EQ(invalid, 2);
+
+    // max_out = 1: Paarschleife läuft nicht, die Rest-Schleife hört nach dem ersten Treffer auf
+    invalid = 0;
+    CHECK_EQ(adc_decode_type1_s16((const uint8_t *)e, 5 * 2, 3, out, 1, &invalid), 1);
+    CHECK_EQ(out[0], 200);
+    CHECK_EQ(invalid, 1);
+
+    // max_out = 0 und leere Eingabe
+    invalid = 0;
+    CHECK_EQ(adc_decode_type1_s16((const uint8_t *)e, 5 * 2, 2, out, 0, &invalid), 0);
+    CHECK_EQ(adc_decode_type1_s16((const uint8_t *)e, 0, 2, out, 3, &invalid), 0);
+    CHECK_EQ(invalid, 0);
+}
+
+static void test_random_single(void)
+{
+    static uint32_t words[(MAX_ENTRIES + 1) / 2];
+    uint16_t *e = (uint16_t *)words;
+    srand(5);
+    for (int round = 0; round < 20000; round++) {
+        uint32_t entries = rand() % MAX_ENTRIES;   // gerade und ungerade
+        for (uint32_t i = 0; i < entries; i++) {
+            // meist Kanal 6, sonst beliebige Kanal-ID (0..15)
+            uint8_t channel = (rand() % 4) ? 6 : rand() % 16;
+            e[i] = entry(channel, rand());
+        }
+        uint32_t max_out = rand() % (entries + 3);
+        check_single(e, entries, 6, max_out);
+    }
+}
+
+static void test_multi(void)
+{
+    static const uint8_t channels[] = { 3, 7, 0, 7 };   // 7 doppelt: nur ein Slot
+    adc_decode_map_t map;
+    adc_decode_map_init(&map, channels, 4);
+    CHECK_EQ(map.num_slots, 3);
+    CHECK_EQ(map.slot[3], 0);
+    CHECK_EQ(map.slot[7], 1);
+    CHECK_EQ(map.slot[0], 2);
+    CHECK_EQ(map.slot[5], -1);
+    CHECK_EQ(map.slot[15], -1);
+
+    static uint32_t words[(MAX_ENTRIES + 1) / 2];
+    uint16_t *e = (uint16_t *)words;
+    srand(6);
+    for (int round = 0; round < 20000; round++) {
+        uint32_t entries = rand() % MAX_ENTRIES;
+        for (uint32_t i = 0; i < entries; i++) {
+            e[i] = entry(rand() % 16, rand());   // auch IDs, die nicht im Pattern sind
+        }
+        uint32_t max_out = rand() % 40;
+        int16_t *outs[3];
+        int16_t expected[3][MAX_ENTRIES];
+        uint32_t counts[3] = { 0, 0, 0 }, expected_counts[3] = { 0, 0, 0 };
+        uint32_t invalid = 1, expected_invalid = 1;
+        for (int s = 0; s < 3; s++) {
+            outs[s] = malloc((max_out ? max_out : 1) * sizeof(int16_t));
+        }
+        for (uint32_t i = 0; i < entries; i++) {
+            int slot = (e[i] >> 12) == 3 ? 0 : (e[i] >> 12) == 7 ? 1 : (e[i] >> 12) == 0 ? 2 : -1;
+            if (slot < 0 || expected_counts[slot] >= max_out) {
+                expected_invalid++;
+                continue;
+            }
+            expected[slot][expected_counts[slot]++] = e[i] & 0x0FFF;
+        }
+        adc_decode_type1_multi_s16((const uint8_t *)e, entries * 2, &map, outs, counts, max_out, &invalid);
+        CHECK_EQ(invalid, expected_invalid);
+        for (int s = 0; s < 3; s++) {
+            CHECK_EQ(counts[s], expected_counts[s]);
+            for (uint32_t i = 0; i < counts[s] && i < expected_counts[s]; i++) {
+                CHECK_EQ(outs[s][i], expected[s][i]);
+            }
+            free(outs[s]);
+        }
+    }
+}
+
+int main(void)
+{
+    test_fixed_cases();
+    test_random_single();
+    test_multi();
+    return test_result("test_adc_decode");
+}
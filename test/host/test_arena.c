@@ -0,0 +1,63 @@
+/*
+ * Arena (user-008): Ausrichtung, Spitzenbelegung, Überlauf des Budgets (auch ohne Überlauf der
+ * Rechnung bei riesigen Anforderungen) und arena_reset().
+ */
+#include <stdint.h>
+#include "arena.h"
+#include "test_util.h"
+
+static arena_stats_t stats(arena_id_t id)
+{
+    arena_stats_t s;
+    arena_get_stats(id, &s);
+    return s;
+}
+
+int main(void)
+{
+    const arena_id_t id = ARENA_WS;
+    const uint32_t size = stats(id).size;
+    CHECK(size > 64);
+
+    // Ausrichtung: jede Allokation beginnt auf 8 Bytes, auch nach ungeraden Größen
+    uint8_t *a = arena_alloc(id, 1);
+    uint8_t *b = arena_alloc(id, 13);
+    uint8_t *c = arena_alloc(id, 8);
+    CHECK(a && b && c);
+    CHECK_EQ((uintptr_t)a % 8, 0);
+    CHECK_EQ(b - a, 8);
+    CHECK_EQ(c - b, 16);
+    CHECK_EQ(stats(id).used, 32);
+    CHECK_EQ(stats(id).peak, 32);
+
+    // Überlauf: größer als das Budget, größer als der Rest, riesige Anforderung (offset + size liefe über)
+    CHECK(arena_alloc(id, size + 1) == NULL);
+    CHECK(arena_alloc(id, size - 32 + 1) == NULL);
+    CHECK(arena_alloc(id, SIZE_MAX) == NULL);
+    CHECK(arena_alloc(id, SIZE_MAX - 16) == NULL);
+    CHECK_EQ(stats(id).failures, 4);
+    CHECK_EQ(stats(id).used, 32);
+
+    // Der Rest passt genau
+    uint8_t *rest = arena_alloc(id, size - 32);
+    CHECK(rest == a + 32);
+    CHECK_EQ(stats(id).used, size);
+    CHECK(arena_alloc(id, 1) == NULL);
+
+    // Zurücksetzen: Belegung 0, Spitze bleibt, nächste Allokation beginnt wieder am Anfang
+    arena_reset(id);
+    CHECK_EQ(stats(id).used, 0);
+    CHECK_EQ(stats(id).peak, size);
+    CHECK(arena_alloc(id, 100) == a);
+    CHECK_EQ(stats(id).peak, size);
+    arena_reset(id);
+
+    // Die Arenen sind unabhängig; die FFT-Arena liegt auf 16 Bytes (SIMD-Kernel)
+    CHECK_EQ(stats(ARENA_HTTP).used, 0);
+    CHECK_EQ(stats(ARENA_HTTP).failures, 0);
+    uint8_t *fft = arena_alloc(ARENA_FFT, 4);
+    CHECK(fft != NULL);
+    CHECK_EQ((uintptr_t)fft % 16, 0);
+
+    return test_result("test_arena");
+}
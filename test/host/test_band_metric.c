@@ -0,0 +1,84 @@
+/*
+ * Maße der Bandsuche (user-011) auf 500 synthetischen Spektren (Ton mit Hann-Hauptkeule bei
+ * zufälliger Frequenz und Phase, dazu Rauschen): POWER und MAGNITUDE exakt, MAGNITUDE_FAST und
+ * AMBM innerhalb ihres Näherungsfehlers; das beste Fenster stimmt fast immer mit dem exakten überein.
+ */
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include "band_search.h"
+#include "test_util.h"
+
+#define SPECTRA 500
+#define BINS 54
+#define WIDTH 5
+
+static float frand(void)
+{
+    return (float)rand() / RAND_MAX;
+}
+
+// Ton der Amplitude amp bei Bin pos (Hann-Fenster: Hauptkeule über ±2 Bins) plus Rauschen
+static void make_spectrum(float *spec, float pos, float amp, float phase)
+{
+    for (int k = 0; k < BINS; k++) {
+        float d = k - pos;
+        float a = (fabsf(d) < 2.0f) ? amp * 0.5f * (1.0f + cosf((float)M_PI * d / 2.0f)) : 0.0f;
+        float p = phase + (float)M_PI * d;
+        spec[2 * k] = a * cosf(p) + 40.0f * (frand() - 0.5f);
+        spec[2 * k + 1] = a * sinf(p) + 40.0f * (frand() - 0.5f);
+    }
+}
+
+int main(void)
+{
+    static float spec[2 * BINS];
+    static float exact[BINS], mag[BINS], scratch[BINS];
+    double max_err[4] = { 0 };
+    int agree[4] = { 0 };
+    const int width = WIDTH;
+    srand(3);
+
+    for (int s = 0; s < SPECTRA; s++) {
+        make_spectrum(spec, 3.0f + frand() * (BINS - 6), 200.0f + frand() * 5000.0f, frand() * 6.283f);
+        for (int k = 0; k < BINS; k++) {
+            exact[k] = (float)sqrt((double)spec[2 * k] * spec[2 * k] + (double)spec[2 * k + 1] * spec[2 * k + 1]);
+        }
+        band_window_t best_exact;
+        band_search(exact, BINS, &width, 1, 1, &best_exact);
+
+        for (int m = BAND_METRIC_POWER; m <= BAND_METRIC_AMBM; m++) {
+            memset(mag, 0, sizeof(mag));
+            band_magnitudes(spec, BINS, (band_metric_t)m, mag, scratch);
+            for (int k = 0; k < BINS; k++) {
+                float re = spec[2 * k], im = spec[2 * k + 1];
+                if (m == BAND_METRIC_POWER) {
+                    CHECK(mag[k] == re * re + im * im);
+                } else if (m == BAND_METRIC_MAGNITUDE) {
+                    CHECK(mag[k] == sqrtf(re * re + im * im));
+                }
+                float value = (m == BAND_METRIC_POWER) ? sqrtf(mag[k]) : mag[k];
+                if (exact[k] > 1.0f) {
+                    max_err[m] = fmax(max_err[m], fabs(value - exact[k]) / exact[k]);
+                }
+            }
+            band_window_t best;
+            band_search(mag, BINS, &width, 1, 1, &best);
+            agree[m] += best.start == best_exact.start;
+        }
+    }
+
+    const char *names[] = { "power", "magnitude", "magnitude_fast", "ambm" };
+    for (int m = 0; m < 4; m++) {
+        printf("%-15s max rel error %.4f, best window %d/%d\n", names[m], max_err[m], agree[m], SPECTRA);
+    }
+    CHECK(max_err[BAND_METRIC_POWER] < 1e-6);
+    CHECK(max_err[BAND_METRIC_MAGNITUDE] < 1e-6);
+    CHECK_EQ(agree[BAND_METRIC_MAGNITUDE], SPECTRA);
+    CHECK(max_err[BAND_METRIC_MAGNITUDE_FAST] < 0.04);
+    CHECK(max_err[BAND_METRIC_AMBM] < 0.04);
+    CHECK(agree[BAND_METRIC_MAGNITUDE_FAST] >= SPECTRA * 97 / 100);
+    CHECK(agree[BAND_METRIC_AMBM] >= SPECTRA * 95 / 100);
+    CHECK(agree[BAND_METRIC_POWER] >= SPECTRA * 95 / 100);
+    return test_result("test_band_metric");
+}
@@ -0,0 +1,124 @@
+/*
+ * band_search (user-009) gegen eine erschöpfende Referenz: alle Fensterpositionen direkt summiert,
+ * dann gierig das stärkste Fenster, das keines der bereits gewählten überlappt. Ganzzahlige
+ * Magnituden machen die Summen exakt, bei Gleichstand gewinnt in beiden das frühere Fenster.
+ */
+#include <stdbool.h>
+#include <stdlib.h>
+#include "band_search.h"
+#include "test_util.h"
+
+#define MAX_BINS 200
+
+static void reference(const float *mag, int n, int w, int top_k, band_window_t *top)
+{
+    if (w > n) w = n;
+    if (w < 1) w = 1;
+    for (int k = 0; k < top_k; k++) {
+        top[k] = (band_window_t){ .start = 0, .width = w, .sum = 0.0f };
+    }
+    for (int k = 0; k < top_k; k++) {
+        band_window_t best = { .start = 0, .width = w, .sum = 0.0f };
+        for (int start = 0; start + w <= n; start++) {
+            bool free = true;
+            for (int i = 0; i < k; i++) {
+                free = free && (start + w <= top[i].start || top[i].start + w <= start);
+            }
+            float sum = 0.0f;
+            for (int i = 0; i < w; i++) {
+                sum += mag[start + i];
+            }
+            if (free && sum > best.sum) {
+                best.start = start;
+                best.sum = sum;
+            }
+        }
+        if (best.sum <= 0.0f) {
+            break;
+        }
+        top[k] = best;
+    }
+}
+
+static void check_against_reference(const float *mag, int n, const int *widths, int num_widths, int top_k)
+{
+    band_window_t results[BAND_SEARCH_MAX_WIDTHS * BAND_SEARCH_MAX_TOP_K];
+    band_window_t expected[BAND_SEARCH_MAX_TOP_K];
+    for (int i = 0; i < num_widths * top_k; i++) {
+        results[i] = (band_window_t){ .start = -1, .width = -1, .sum = -1.0f };   // muss überschrieben werden
+    }
+    band_search(mag, n, widths, num_widths, top_k, results);
+    for (int j = 0; j < num_widths; j++) {
+        reference(mag, n, widths[j], top_k, expected);
+        for (int k = 0; k < top_k; k++) {
+            const band_window_t *got = &results[j * top_k + k];
+            CHECK_EQ(got->start, expected[k].start);
+            CHECK_EQ(got->width, expected[k].width);
+            CHECK(got->sum == expected[k].sum);
+        }
+    }
+}
+
+static void test_shifted_group(void)
+{
+    // w = 4: Summen 9, 10, 11 an den Starts 0, 2, 5 (sonst kleiner). Das Maximum der Gruppe wandert
+    // von 0 über 2 nach 5 und überlappt das Fenster bei 0 am Ende nicht mehr → {5: 11, 0: 9}
+    static const float mag[] = { 2, 2, 3, 2, 0, 5, 1, 0, 5, 2 };
+    static const int widths[] = { 4 };
+    band_window_t top[3];
+    band_search(mag, 10, widths, 1, 3, top);
+    CHECK_EQ(top[0].start, 5);
+    CHECK(top[0].sum == 11.0f);
+    CHECK_EQ(top[1].start, 0);
+    CHECK(top[1].sum == 9.0f);
+    CHECK(top[2].sum == 0.0f);
+    check_against_reference(mag, 10, widths, 1, 3);
+}
+
+static void test_empty(void)
+{
+    // n < 1: Ergebnisse trotzdem belegt (sum = 0, start = 0)
+    static const int widths[] = { 3, 5 };
+    band_window_t top[2 * 2];
+    for (int i = 0; i < 4; i++) {
+        top[i] = (band_window_t){ .start = 7, .width = 7, .sum = 7.0f };
+    }
+    band_search(NULL, 0, widths, 2, 2, top);
+    for (int i = 0; i < 4; i++) {
+        CHECK_EQ(top[i].start, 0);
+        CHECK(top[i].sum == 0.0f);
+    }
+
+    static const float zeros[8];
+    band_search(zeros, 8, widths, 2, 2, top);
+    for (int i = 0; i < 4; i++) {
+        CHECK(top[i].sum == 0.0f);
+    }
+}
+
+static void test_random(void)
+{
+    static float mag[MAX_BINS];
+    srand(9);
+    for (int round = 0; round < 3000; round++) {
+        int n = 1 + rand() % MAX_BINS;
+        int sparse = rand() % 2;
+        for (int i = 0; i < n; i++) {
+            mag[i] = (sparse && rand() % 4) ? 0.0f : (float)(rand() % 16);
+        }
+        int num_widths = 1 + rand() % BAND_SEARCH_MAX_WIDTHS;
+        int widths[BAND_SEARCH_MAX_WIDTHS];
+        for (int j = 0; j < num_widths; j++) {
+            widths[j] = 1 + rand() % 24;   // auch breiter als n
+        }
+        check_against_reference(mag, n, widths, num_widths, 1 + rand() % BAND_SEARCH_MAX_TOP_K);
+    }
+}
+
+int main(void)
+{
+    test_shifted_group();
+    test_empty();
+    test_random();
+    return test_result("test_band_search");
+}
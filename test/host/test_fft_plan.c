@@ -0,0 +1,88 @@
+/*
+ * FFT_PLAN_REAL gegen FFT_PLAN_COMPLEX (user-002): Beide Pfade bekommen dieselben Frames, jeweils mit
+ * dem Fenster ihres Plans geladen wie in adc_fft.c. Die Bins 1..N/2-1 müssen bis auf Rundungsfehler
+ * übereinstimmen, für Radix-4 (N/2 Viererpotenz) und Radix-2 (sonst) im Real-Pfad. Bin 0 legt
+ * dsps_cplx2real_fc32 gepackt ab (Realteil 2 * DC, Imaginärteil Nyquist); geprüft wird dort der DC-Anteil.
+ * Zuletzt: keine globalen esp-dsp-Tabellen; eine globale Initialisierung vor dem ersten Plan lässt den
+ * Planaufbau scheitern.
+ */
+#include <math.h>
+#include <stdlib.h>
+#include "esp_dsp.h"
+#include "fft_plan.h"
+#include "test_util.h"
+
+#define FRAMES 8
+// größter Abstand eines Bins, bezogen auf den größten Betrag im Spektrum
+#define MAX_REL_ERROR 1e-5
+
+static void make_frame(float *x, int n, int frame)
+{
+    srand(1000 + frame);
+    float f1 = 0.01f + 0.4f * rand() / (float)RAND_MAX;
+    float f2 = 0.01f + 0.4f * rand() / (float)RAND_MAX;
+    for (int i = 0; i < n; i++) {
+        // 12-Bit-ADC-Werte: Offset, zwei Töne, Rauschen
+        x[i] = 2048.0f + 1200.0f * sinf(2.0f * (float)M_PI * f1 * i) + 300.0f * cosf(2.0f * (float)M_PI * f2 * i + 0.3f)
+               + (rand() % 200 - 100);
+    }
+}
+
+static double compare(int n, int *use_fft4r)
+{
+    fft_plan_t complex_plan, real_plan;
+    CHECK_EQ(fft_plan_init(&complex_plan, n, FFT_PLAN_COMPLEX), ESP_OK);
+    CHECK_EQ(fft_plan_init(&real_plan, n, FFT_PLAN_REAL), ESP_OK);
+    *use_fft4r = real_plan.use_fft4r;
+    float *x = malloc(n * sizeof(float));
+    double worst = 0.0;
+
+    for (int frame = 0; frame < FRAMES; frame++) {
+        make_frame(x, n, frame);
+        for (int i = 0; i < n; i++) {
+            complex_plan.fft_input[2 * i] = x[i] * complex_plan.window[i];
+            complex_plan.fft_input[2 * i + 1] = 0.0f;
+            real_plan.fft_input[i] = x[i] * real_plan.window[i];
+        }
+        fft_plan_execute(&complex_plan);
+        fft_plan_execute(&real_plan);
+
+        double peak = 0.0;
+        double max_error = fabs(2.0 * complex_plan.fft_input[0] - real_plan.fft_input[0]) / 2.0;
+        for (int k = 1; k < n / 2; k++) {
+            const float *c = &complex_plan.fft_input[2 * k];
+            const float *r = &real_plan.fft_input[2 * k];
+            peak = fmax(peak, hypot(c[0], c[1]));
+            max_error = fmax(max_error, hypot(c[0] - r[0], c[1] - r[1]));
+        }
+        worst = fmax(worst, max_error / peak);
+    }
+    free(x);
+    fft_plan_deinit(&complex_plan);
+    fft_plan_deinit(&real_plan);
+    return worst;
+}
+
+int main(void)
+{
+    for (int n = 64; n <= FFT_PLAN_MAX_SIZE; n *= 2) {
+        int use_fft4r;
+        double error = compare(n, &use_fft4r);
+        printf("N=%4d %s: max bin error %.2e of peak\n", n, use_fft4r ? "radix-4" : "radix-2", error);
+        CHECK(error < MAX_REL_ERROR);
+    }
+
+    // Die Pläne belegen keine globalen esp-dsp-Tabellen (eine spätere globale Initialisierung ist wirkungslos)
+    CHECK(dsps_fft2r_initialized && dsps_fft4r_initialized);
+    CHECK_EQ(dsps_fft2r_init_fc32(NULL, 64), ESP_OK);
+    CHECK(dsps_fft_w_table_fc32 == NULL && dsps_fft4r_w_table_fc32 == NULL);
+
+    // Global initialisiert vor dem ersten Plan: der Planaufbau scheitert
+    dsps_fft2r_initialized = 0;
+    CHECK_EQ(dsps_fft2r_init_fc32(NULL, 64), ESP_OK);
+    fft_plan_t plan;
+    CHECK_EQ(fft_plan_init(&plan, 1024, FFT_PLAN_REAL), ESP_ERR_INVALID_STATE);
+    CHECK(plan.twiddle == NULL && plan.window == NULL);
+    dsps_fft2r_deinit_fc32();
+    return test_result("test_fft_plan");
+}
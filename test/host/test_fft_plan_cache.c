@@ -0,0 +1,100 @@
+/*
+ * Plan-Cache (user-018): Treffer und Fehlgriffe, Verdrängung des am längsten nicht benutzten Plans
+ * (nie des aktiven) und Wechsel der FFT-Größe wie in adc_fft.c: Fenster und Arbeitspuffer stellt der
+ * Aufrufer, die Spitze eines 812-Hz-Tons muss bei jeder Größe auf dem nächstgelegenen Bin liegen.
+ */
+#include <math.h>
+#include <stdlib.h>
+#include "fft_plan.h"
+#include "test_util.h"
+
+#define SAMPLE_RATE 44100.0f
+#define TONE_HZ 812.0f
+#define MAX_SIZE 2048
+
+static float input[MAX_SIZE * 2];
+static float magnitudes[MAX_SIZE];
+
+// Ton (ohne Gleichanteil) mit Hann-Fenster und dem Faktor 2 des Real-Pfads laden (wie fft_plan_init), FFT, Spitzen-Bin
+static int peak_bin(fft_plan_t *plan)
+{
+    int n = plan->fft_size;
+    plan->fft_input = input;
+    plan->magnitudes = magnitudes;
+    for (int i = 0; i < n; i++) {
+        float w = 2.0f * (0.5f - 0.5f * cosf(2.0f * (float)M_PI * i / n));
+        input[i] = w * 1000.0f * sinf(2.0f * (float)M_PI * TONE_HZ * i / SAMPLE_RATE);
+    }
+    fft_plan_execute(plan);
+    int peak = 1;
+    for (int k = 1; k < n / 2; k++) {
+        magnitudes[k] = hypotf(input[2 * k], input[2 * k + 1]);
+        if (magnitudes[k] > magnitudes[peak]) {
+            peak = k;
+        }
+    }
+    return peak;
+}
+
+static bool cached(const fft_plan_cache_t *cache, int fft_size)
+{
+    for (int i = 0; i < FFT_PLAN_CACHE_SLOTS; i++) {
+        if (cache->plans[i].fft_size == fft_size) {
+            return true;
+        }
+    }
+    return false;
+}
+
+int main(void)
+{
+    static fft_plan_cache_t cache;
+    fft_plan_t *plan = NULL, *again = NULL;
+
+    // Größenwechsel wie über GET /fft?size=N; der aktive Plan wird jeweils als keep übergeben
+    const int sizes[] = {1024, 256, 2048, 1024, 2048, 512, 256};
+    const int hits[]  = {0,    0,   0,    1,    2,    2,   3};
+    for (int i = 0; i < (int)(sizeof(sizes) / sizeof(sizes[0])); i++) {
+        CHECK_EQ(fft_plan_cache_get(&cache, sizes[i], FFT_PLAN_REAL, plan, &plan), ESP_OK);
+        CHECK_EQ(plan->fft_size, sizes[i]);
+        CHECK(plan->window == NULL && !plan->owns_buffers);
+        CHECK_EQ(cache.hits, hits[i]);
+        CHECK_EQ(cache.hits + cache.misses, i + 1);
+        int expected = (int)lrintf(TONE_HZ * sizes[i] / SAMPLE_RATE);
+        int peak = peak_bin(plan);
+        printf("N=%4d: peak bin %d (expected %d)\n", sizes[i], peak, expected);
+        CHECK_EQ(peak, expected);
+    }
+    CHECK_EQ(fft_plan_cache_count(&cache), 4);
+
+    // Treffer liefert denselben Plan, ein anderer Modus ist ein eigener Plan
+    CHECK_EQ(fft_plan_cache_get(&cache, 256, FFT_PLAN_REAL, plan, &again), ESP_OK);
+    CHECK(again == plan);
+
+    // Voll: verdrängt wird der am längsten nicht abgerufene (1024), nicht der aktive
+    CHECK_EQ(fft_plan_cache_get(&cache, 256, FFT_PLAN_COMPLEX, plan, &again), ESP_OK);
+    CHECK(!cached(&cache, 1024));
+    CHECK(cached(&cache, 2048) && cached(&cache, 512));
+    CHECK_EQ(again->mode, FFT_PLAN_COMPLEX);
+
+    // Ist der aktive Plan der älteste, trifft es den nächstälteren
+    CHECK_EQ(fft_plan_cache_get(&cache, 2048, FFT_PLAN_REAL, plan, &plan), ESP_OK);   // aktiv: 2048
+    CHECK_EQ(fft_plan_cache_get(&cache, 512, FFT_PLAN_REAL, plan, &again), ESP_OK);
+    CHECK_EQ(fft_plan_cache_get(&cache, 256, FFT_PLAN_REAL, plan, &again), ESP_OK);
+    CHECK_EQ(fft_plan_cache_get(&cache, 256, FFT_PLAN_COMPLEX, plan, &again), ESP_OK);
+    uint32_t misses = cache.misses;
+    CHECK_EQ(fft_plan_cache_get(&cache, 4096, FFT_PLAN_REAL, plan, &again), ESP_OK);
+    CHECK_EQ(cache.misses, misses + 1);
+    CHECK(cached(&cache, 2048) && cached(&cache, 4096));
+    CHECK(!cached(&cache, 512));
+    CHECK_EQ(plan->fft_size, 2048);
+    CHECK_EQ(peak_bin(plan), (int)lrintf(TONE_HZ * 2048 / SAMPLE_RATE));
+
+    // Ungültige Größe: Fehler, der Cache bleibt unverändert
+    CHECK_EQ(fft_plan_cache_get(&cache, 1000, FFT_PLAN_REAL, plan, &again), ESP_ERR_INVALID_ARG);
+    CHECK_EQ(fft_plan_cache_count(&cache), 4);
+
+    fft_plan_cache_deinit(&cache);
+    CHECK_EQ(fft_plan_cache_count(&cache), 0);
+    return test_result("test_fft_plan_cache");
+}
@@ -0,0 +1,82 @@
+/*
+ * frame_load (user-010): frame_load_s16_ae32 muss bitgleich zu frame_load_s16_ansi sein, für
+ * stride 1 und 2, len % 4 != 0 (Rückfall) und ein nicht ausgerichtetes x; beide müssen einer
+ * Referenz in double (Mittelwert abziehen, Fenster) entsprechen und nur jeden stride-ten Wert schreiben.
+ */
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include "frame_load.h"
+#include "esp_dsp.h"
+#include "test_util.h"
+
+#define MAX_LEN 1030
+#define GUARD 12345.0f
+
+static int16_t samples[MAX_LEN + 2] __attribute__((aligned(16)));
+static float window[MAX_LEN];
+static float out_ansi[2 * MAX_LEN + 1];
+static float out_opt[2 * MAX_LEN + 1];
+
+static void check_case(const int16_t *x, int len, int stride)
+{
+    for (int i = 0; i <= 2 * MAX_LEN; i++) {
+        out_ansi[i] = out_opt[i] = GUARD;
+    }
+    frame_load_s16_ansi(x, window, out_ansi, len, stride);
+    frame_load_s16_ae32(x, window, out_opt, len, stride);
+
+    double mean = 0.0;
+    for (int i = 0; i < len; i++) {
+        mean += x[i];
+    }
+    mean /= len;
+    int mismatches = 0;
+    double max_err = 0.0;
+    for (int i = 0; i < len * stride; i++) {
+        mismatches += memcmp(&out_ansi[i], &out_opt[i], sizeof(float)) != 0;
+        if (i % stride != 0) {
+            CHECK(out_ansi[i] == GUARD && out_opt[i] == GUARD);   // Imaginärteile bleiben unberührt
+            continue;
+        }
+        double ref = (x[i / stride] - mean) * window[i / stride];
+        max_err = fmax(max_err, fabs(out_ansi[i] - ref));
+    }
+    CHECK(out_ansi[len * stride] == GUARD && out_opt[len * stride] == GUARD);
+    if (mismatches || max_err > 1e-3) {
+        fprintf(stderr, "len %d stride %d aligned %d: %d mismatches, max error %g\n", len, stride,
+                ((uintptr_t)x & 3) == 0, mismatches, max_err);
+    }
+    CHECK_EQ(mismatches, 0);
+    CHECK(max_err <= 1e-3);
+}
+
+int main(void)
+{
+    srand(1);
+    for (int i = 0; i < MAX_LEN + 2; i++) {
+        samples[i] = (int16_t)(2048 + (rand() % 4001) - 2000);
+    }
+    samples[5] = 4095;
+    samples[6] = 0;
+
+    const int lens[] = { 4, 256, 1024, 1027, 1030, 13 };
+    for (unsigned l = 0; l < sizeof(lens) / sizeof(lens[0]); l++) {
+        int len = lens[l];
+        dsps_wind_hann_f32(window, len);
+        for (int stride = 1; stride <= 2; stride++) {
+            check_case(samples, len, stride);       // ausgerichtet
+            check_case(samples + 1, len, stride);   // nur 2-Byte-ausgerichtet
+        }
+    }
+
+    // Negative Samples (vorzeichenrichtige Summe)
+    for (int i = 0; i < 256; i++) {
+        samples[i] = (int16_t)((i & 1) ? -30000 : 29000 - i);
+    }
+    dsps_wind_hann_f32(window, 256);
+    check_case(samples, 256, 1);
+    check_case(samples + 1, 256, 2);
+
+    return test_result("test_frame_load");
+}
@@ -0,0 +1,152 @@
+/*
+ * Verlauf in Stufen (user-025): 3,3 simulierte Stunden mit 10 Frames/s, zufälligen Frequenzen und
+ * Magnituden, expliziten voiced-Flags und einer Lücke von 200 s. Jedes lesbare Intervall jeder Stufe
+ * wird mit einem Aggregat über alle Frames verglichen; Intervalle in der Lücke fehlen.
+ */
+#include <math.h>
+#include <stdlib.h>
+#include "history.h"
+#include "test_util.h"
+
+#define FRAMES_PER_S 10
+#define DURATION_S 11880
+#define GAP_START_S 11500
+#define GAP_END_S 11700
+#define NUM_FRAMES (DURATION_S * FRAMES_PER_S)
+
+static const uint32_t periods[] = {1, 60, 3600};
+static const int lengths[] = {600, 240, 8};
+#define NUM_TIERS 3
+
+typedef struct {
+    uint32_t time_s;
+    float freq;
+    float mag;
+    bool voiced;
+} frame_t;
+
+static frame_t frames[NUM_FRAMES];
+static int num_frames;
+
+static int quantize_freq(double hz)
+{
+    return (int)lround(hz / HISTORY_FREQ_STEP);
+}
+
+static int quantize_mag(double magnitude)
+{
+    if (!(magnitude > 1.0)) {
+        return 0;
+    }
+    long steps = lround(20.0 * log10(magnitude) / HISTORY_MAG_STEP_DB);
+    return steps > 255 ? 255 : (int)steps;
+}
+
+// Abweichung um eine Stufe: Mittelwerte werden in float stufenweise summiert
+#define CHECK_NEAR(a, b) CHECK(abs((int)(a) - (int)(b)) <= 1)
+
+// Vergleicht ein gelesenes Intervall mit dem Aggregat über alle Frames; liefert false bei fehlendem Intervall
+static bool check_bucket(int tier, uint32_t seq, const history_bucket_t *b)
+{
+    uint32_t n = 0, count = 0;
+    double fmin = 0, fmax = 0, fsum = 0, mmin = 0, mmax = 0, msum = 0;
+    for (int i = 0; i < num_frames; i++) {
+        const frame_t *f = &frames[i];
+        if (f->time_s / periods[tier] != seq) {
+            continue;
+        }
+        if (f->voiced) {
+            fmin = (count == 0 || f->freq < fmin) ? f->freq : fmin;
+            fmax = (count == 0 || f->freq > fmax) ? f->freq : fmax;
+            fsum += f->freq;
+            count++;
+        }
+        mmin = (n == 0 || f->mag < mmin) ? f->mag : mmin;
+        mmax = (n == 0 || f->mag > mmax) ? f->mag : mmax;
+        msum += f->mag;
+        n++;
+    }
+    if (n == 0) {
+        CHECK_EQ(b->seq, HISTORY_SEQ_INVALID);
+        return false;
+    }
+    CHECK_EQ(b->seq, seq);
+    CHECK_EQ(b->count, count);
+    CHECK_EQ(b->voiced, (count * 255u + n / 2) / n);
+    if (count > 0) {
+        CHECK_EQ(b->freq_min, quantize_freq(fmin));
+        CHECK_EQ(b->freq_max, quantize_freq(fmax));
+        CHECK_NEAR(b->freq_mean, quantize_freq(fsum / count));
+    } else {
+        CHECK(b->freq_min == 0 && b->freq_max == 0 && b->freq_mean == 0);
+    }
+    CHECK_EQ(b->mag_min, quantize_mag(mmin));
+    CHECK_EQ(b->mag_max, quantize_mag(mmax));
+    CHECK_NEAR(b->mag_mean, quantize_mag(msum / n));
+    return true;
+}
+
+int main(void)
+{
+    static history_t h;
+    const uint32_t bad_periods[] = {1, 60, 3500};   // 3500 kein Vielfaches von 60
+    CHECK_EQ(history_init(&h, bad_periods, lengths, NUM_TIERS), ESP_ERR_INVALID_ARG);
+    CHECK_EQ(history_init(&h, periods, lengths, NUM_TIERS), ESP_OK);
+
+    srand(25);
+    for (uint32_t s = 0; s < DURATION_S; s++) {
+        if (s >= GAP_START_S && s < GAP_END_S) {
+            continue;
+        }
+        // jede 7. Minute ohne Ton, sonst ein Viertel der Frames stumm (Frequenz dann beliebig)
+        bool silent_minute = (s / 60) % 7 == 3;
+        for (int k = 0; k < FRAMES_PER_S; k++) {
+            frame_t *f = &frames[num_frames++];
+            f->time_s = s;
+            f->voiced = !silent_minute && rand() % 4 != 0;
+            f->freq = f->voiced ? 80.0f + (rand() % 200000) / 100.0f : (float)(rand() % 5000);
+            f->mag = powf(10.0f, (rand() % 500) / 100.0f - 0.5f);
+            history_add(&h, (int64_t)s * 1000000 + k * (1000000 / FRAMES_PER_S), f->freq, f->mag, f->voiced);
+        }
+    }
+
+    history_bucket_t out[600 + 1];
+    for (int tier = 0; tier < NUM_TIERS; tier++) {
+        uint32_t head = history_head(&h, tier);
+        CHECK_EQ(head, (DURATION_S - 1) / periods[tier]);
+        // lesbar sind head - length + 1 .. head - 1; davor, das laufende und danach fehlen
+        uint32_t from = head - (lengths[tier] - 1) - 1;
+        int count = lengths[tier] + 1;
+        if (head < (uint32_t)lengths[tier]) {
+            from = 0;
+            count = head + 2;
+        }
+        history_read(&h, tier, from, count, out);
+        int present = 0, missing = 0;
+        for (int i = 0; i < count; i++) {
+            uint32_t seq = from + i;
+            if (seq >= head || head - seq >= (uint32_t)lengths[tier]) {
+                CHECK_EQ(out[i].seq, HISTORY_SEQ_INVALID);
+                continue;
+            }
+            if (check_bucket(tier, seq, &out[i])) {
+                present++;
+            } else {
+                missing++;
+            }
+        }
+        printf("tier %d (%u s): head %u, %d intervals checked, %d missing\n",
+               tier, (unsigned int)periods[tier], (unsigned int)head, present, missing);
+        CHECK(present > 0);
+        // Lücke: 200 s in Stufe 0, die vollständig überdeckten Minuten 192..194 in Stufe 1
+        CHECK_EQ(missing, tier == 0 ? GAP_END_S - GAP_START_S : tier == 1 ? 3 : 0);
+    }
+
+    // Ungültige Stufe
+    history_read(&h, NUM_TIERS, 0, 1, out);
+    CHECK_EQ(out[0].seq, HISTORY_SEQ_INVALID);
+    CHECK_EQ(history_head(&h, NUM_TIERS), 0);
+
+    history_deinit(&h);
+    return test_result("test_history");
+}
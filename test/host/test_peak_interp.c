@@ -0,0 +1,110 @@
+/*
+ * Schätzer zwischen den Bins (user-014): Töne 200..2500 Hz bei 44100 Hz über die echte Eingangsstufe
+ * (frame_load_s16, Hann-Fenster des Plans) und die reelle FFT, N = 256..1024. Geprüft werden der
+ * mittlere Fehler je Schätzer und die Reihenfolge none > quadratic > gaussian > jacobsen.
+ */
+#include <math.h>
+#include <stdlib.h>
+#include "fft_plan.h"
+#include "frame_load.h"
+#include "peak_interp.h"
+#include "test_util.h"
+
+#define SAMPLE_RATE 44100.0f
+#define TONES 64
+#define MAX_SIZE 1024
+
+static int peak_bin(const float *spectrum, int from, int to)
+{
+    int best = from;
+    float best_power = -1.0f;
+    for (int k = from; k <= to; k++) {
+        float p = spectrum[2 * k] * spectrum[2 * k] + spectrum[2 * k + 1] * spectrum[2 * k + 1];
+        if (p > best_power) {
+            best_power = p;
+            best = k;
+        }
+    }
+    return best;
+}
+
+int main(void)
+{
+    // obere Grenzen des mittleren Fehlers in Hz je Größe (256, 512, 1024)
+    const float limits[PEAK_EST_COUNT][3] = {
+        [PEAK_EST_NONE]          = { 50.0f, 25.0f, 12.0f },
+        [PEAK_EST_QUADRATIC]     = { 10.0f,  4.0f,  2.0f },
+        [PEAK_EST_GAUSSIAN]      = {  3.5f,  1.2f,  0.6f },
+        [PEAK_EST_JACOBSEN]      = {  1.5f,  0.15f, 0.06f },
+        [PEAK_EST_PHASE_VOCODER] = {  0.3f,  0.1f,  0.03f },
+    };
+    static int16_t x[MAX_SIZE + MAX_SIZE / 2];
+    srand(7);
+
+    int s = 0;
+    for (int size = 256; size <= MAX_SIZE; size *= 2, s++) {
+        fft_plan_t plan = { 0 };
+        CHECK_EQ(fft_plan_init(&plan, size, FFT_PLAN_REAL), ESP_OK);
+        float bin_width = SAMPLE_RATE / size;
+        int from = (int)ceilf(200.0f / bin_width), to = (int)floorf(2500.0f / bin_width);
+        double err_sum[PEAK_EST_COUNT] = { 0 };
+
+        for (int t = 0; t < TONES; t++) {
+            float f = 200.0f + (t + (float)rand() / RAND_MAX) * (2300.0f / TONES);
+            float phase = (float)rand() / RAND_MAX * 6.283f;
+            for (int i = 0; i < size + size / 2; i++) {
+                x[i] = (int16_t)(2048 + lrintf(600.0f * sinf(2.0f * (float)M_PI * f * i / SAMPLE_RATE + phase)) +
+                                 (rand() & 0x1F) - 0x10);
+            }
+
+            // zwei Frames mit 50 % Überlappung: der erste nur als Vorgänger für den Phase-Vocoder
+            peak_track_t track = { 0 };
+            float delta[PEAK_EST_COUNT] = { 0 };
+            int k = 0;
+            for (int frame = 0; frame < 2; frame++) {
+                frame_load_s16(x + frame * size / 2, plan.window, plan.fft_input, size, 1);
+                fft_plan_execute(&plan);
+                k = peak_bin(plan.fft_input, from, to);
+                bool ok = peak_interp_vocoder(&track, plan.fft_input, k, k, size, frame * size / 2,
+                                              &delta[PEAK_EST_PHASE_VOCODER]);
+                CHECK(ok == (frame == 1));
+            }
+            for (int est = PEAK_EST_QUADRATIC; est <= PEAK_EST_JACOBSEN; est++) {
+                delta[est] = peak_interp_offset((peak_estimator_t)est, plan.fft_input, k, PEAK_JACOBSEN_Q_HANN);
+            }
+            for (int est = 0; est < PEAK_EST_COUNT; est++) {
+                err_sum[est] += fabsf((k + delta[est]) * bin_width - f);
+            }
+        }
+
+        for (int est = 0; est < PEAK_EST_COUNT; est++) {
+            double mean = err_sum[est] / TONES;
+            printf("N=%4d %-13s mean error %7.3f Hz\n", size, peak_estimator_name((peak_estimator_t)est), mean);
+            if (mean > limits[est][s]) {
+                fprintf(stderr, "N=%d %s: %.3f Hz > %.3f Hz\n", size, peak_estimator_name((peak_estimator_t)est),
+                        mean, limits[est][s]);
+                test_failures++;
+            }
+        }
+        CHECK(err_sum[PEAK_EST_QUADRATIC] < err_sum[PEAK_EST_NONE]);
+        CHECK(err_sum[PEAK_EST_GAUSSIAN] < err_sum[PEAK_EST_QUADRATIC]);
+        CHECK(err_sum[PEAK_EST_JACOBSEN] < err_sum[PEAK_EST_GAUSSIAN]);
+        fft_plan_deinit(&plan);
+    }
+
+    // Ohne passenden Vorgänger (anderer Bin, zu großer Abstand) kein Phase-Vocoder-Ergebnis
+    fft_plan_t plan = { 0 };
+    CHECK_EQ(fft_plan_init(&plan, 256, FFT_PLAN_REAL), ESP_OK);
+    frame_load_s16(x, plan.window, plan.fft_input, 256, 1);
+    fft_plan_execute(&plan);
+    peak_track_t track = { 0 };
+    float offset;
+    CHECK(!peak_interp_vocoder(&track, plan.fft_input, 20, 20, 256, 0, &offset));
+    CHECK(!peak_interp_vocoder(&track, plan.fft_input, 30, 30, 256, 128, &offset));   // Bin zu weit entfernt
+    CHECK(!peak_interp_vocoder(&track, plan.fft_input, 30, 30, 256, 128 + 200, &offset));   // Abstand > 3/4 N
+    peak_track_reset(&track);
+    CHECK(!peak_interp_vocoder(&track, plan.fft_input, 30, 30, 256, 400, &offset));
+    fft_plan_deinit(&plan);
+
+    return test_result("test_peak_interp");
+}
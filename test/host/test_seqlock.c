@@ -0,0 +1,157 @@
+/*
+ * seqlock-Stresstest (user-021): ein Schreiber, mehrere Leser, nach dem Muster von fastdetect.c.
+ *  - Momentaufnahme eines Frame-Rings über seqlock_read() (read_snapshot): frames und die letzten
+ *    RING Werte müssen zueinander passen.
+ *  - Chunk-Ring mit head/count über seqlock_read_begin()/seqlock_read_retry() (fastdetect_read_chunks):
+ *    die kopierten Einträge müssen lückenlos absteigende Frames mit passender Prüfsumme tragen.
+ * Ein Leser darf nie eine zerrissene Momentaufnahme akzeptieren. Zusätzlich wird gezählt, wie viele
+ * Kopien der Seqlock als ungültig verworfen hat und davon tatsächlich zerrissen waren.
+ */
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <string.h>
+#include "seqlock.h"
+#include "test_util.h"
+
+#define READERS 3
+#define WRITES 2000000u
+#define RING 64
+#define CHUNKS 256
+#define READ_CHUNKS 20
+
+// Frame-Ring wie freq_store_t: Frame n liegt an n % RING
+typedef struct {
+    uint32_t values[RING];
+    uint32_t frames;
+} frame_store_t;
+
+// Chunk-Ring wie chunk_ring_t: neuester Eintrag vor head
+typedef struct {
+    uint32_t frame;
+    uint32_t check;   // ~frame
+    float freq;
+} chunk_t;
+
+typedef struct {
+    chunk_t entries[CHUNKS];
+    uint32_t head;
+    uint32_t count;
+} chunk_ring_t;
+
+static seqlock_t store_lock, ring_lock;
+static frame_store_t store;
+static chunk_ring_t ring;
+static atomic_bool writer_done;
+
+typedef struct {
+    uint32_t snapshots, torn, discarded, discarded_torn;
+} reader_stats_t;
+
+static bool store_consistent(const frame_store_t *s)
+{
+    uint32_t first = (s->frames > RING) ? s->frames - RING : 0;
+    for (uint32_t n = first; n < s->frames; n++) {
+        if (s->values[n % RING] != n) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool chunks_consistent(const chunk_t *c, int n, uint32_t newest)
+{
+    for (int i = 0; i < n; i++) {
+        if (c[i].frame != newest - i || c[i].check != ~c[i].frame || c[i].freq != (float)(c[i].frame % 1000)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static void *writer(void *arg)
+{
+    for (uint32_t k = 0; k < WRITES; k++) {
+        seqlock_write_begin(&store_lock);
+        store.values[k % RING] = k;
+        store.frames = k + 1;
+        seqlock_write_end(&store_lock);
+
+        seqlock_write_begin(&ring_lock);
+        ring.entries[ring.head] = (chunk_t){ .frame = k, .check = ~k, .freq = (float)(k % 1000) };
+        ring.head = (ring.head + 1) % CHUNKS;
+        ring.count += (ring.count < CHUNKS);
+        seqlock_write_end(&ring_lock);
+    }
+    atomic_store(&writer_done, true);
+    return NULL;
+}
+
+static void *reader(void *arg)
+{
+    reader_stats_t *stats = arg;
+    static __thread frame_store_t copy;
+    chunk_t chunks[READ_CHUNKS];
+    while (!atomic_load(&writer_done)) {
+        // read_snapshot(): seqlock_read mit wenigen Versuchen, sonst abgeben
+        while (!seqlock_read(&store_lock, &copy, &store, sizeof(copy), 8)) {
+            sched_yield();
+        }
+        stats->snapshots++;
+        stats->torn += !store_consistent(&copy);
+
+        // fastdetect_read_chunks(): nur die neuesten Einträge, head/count aus derselben Momentaufnahme
+        for (;;) {
+            uint32_t start = seqlock_read_begin(&ring_lock);
+            uint32_t head = ring.head;
+            uint32_t count = ring.count;
+            int n = (count < READ_CHUNKS) ? (int)count : READ_CHUNKS;
+            if (head >= CHUNKS || count > CHUNKS) {
+                continue;
+            }
+            for (int i = 0; i < n; i++) {
+                chunks[i] = ring.entries[(head + CHUNKS - 1 - i) % CHUNKS];
+            }
+            bool ok = n == 0 || chunks_consistent(chunks, n, chunks[0].frame);
+            if (!seqlock_read_retry(&ring_lock, start)) {
+                stats->snapshots++;
+                stats->torn += !ok;
+                break;
+            }
+            stats->discarded++;
+            stats->discarded_torn += !ok;
+            sched_yield();
+        }
+    }
+    return NULL;
+}
+
+int main(void)
+{
+    seqlock_init(&store_lock);
+    seqlock_init(&ring_lock);
+    pthread_t readers[READERS], w;
+    reader_stats_t stats[READERS];
+    memset(stats, 0, sizeof(stats));
+    for (int i = 0; i < READERS; i++) {
+        pthread_create(&readers[i], NULL, reader, &stats[i]);
+    }
+    pthread_create(&w, NULL, writer, NULL);
+    pthread_join(w, NULL);
+
+    reader_stats_t total = { 0 };
+    for (int i = 0; i < READERS; i++) {
+        pthread_join(readers[i], NULL);
+        total.snapshots += stats[i].snapshots;
+        total.torn += stats[i].torn;
+        total.discarded += stats[i].discarded;
+        total.discarded_torn += stats[i].discarded_torn;
+    }
+    printf("%u writes, %d readers: %u snapshots accepted, %u torn; %u copies discarded (%u of them torn)\n",
+           WRITES, READERS, total.snapshots, total.torn, total.discarded, total.discarded_torn);
+    CHECK_EQ(total.torn, 0);
+    CHECK(total.snapshots > 0);
+    CHECK_EQ(seqlock_generation(&store_lock), WRITES);
+    CHECK(store_consistent(&store));
+    return test_result("test_seqlock");
+}
@@ -0,0 +1,213 @@
+/*
+ * Spektrogramm-Ring (user-017): Quantisierung gegen log10f, Zeilen aus divider Frames (auch gehaltene
+ * und stille Frames), Zurücksetzen mit weniger Bins, Überlauf des Rings und ein nebenläufiger Leser,
+ * der keine zerrissenen Zeilen sehen darf.
+ */
+#include <math.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "spectrogram.h"
+#include "test_util.h"
+
+#define MAX_BINS 100
+#define ROWS 16
+#define DIVIDER 4
+#define SCALE 2.0f
+
+// größter Quantisierungsfehler: halbe Stufe plus Fehler der log2-Tabelle
+#define MAX_ERR_DB (SPECTROGRAM_DB_STEP / 2.0f + 0.05f)
+
+#define STRESS_ROWS 20000
+
+static uint32_t row_seq(const uint8_t *row)
+{
+    uint32_t seq;
+    memcpy(&seq, row, sizeof(seq));
+    return seq;
+}
+
+static float row_top_db(const uint8_t *row)
+{
+    float top_db;
+    memcpy(&top_db, row + 4, sizeof(top_db));
+    return top_db;
+}
+
+// Spitze der Zeile mit Nummer seq im Stresstest
+static int stress_peak(uint32_t seq)
+{
+    return (int)(seq % 20) + 5;
+}
+
+static void stress_power(float *power, uint32_t seq)
+{
+    for (int b = 0; b < MAX_BINS; b++) {
+        power[b] = 1.0f + b * 0.01f;
+    }
+    power[stress_peak(seq)] = 1e6f;
+}
+
+static spectrogram_t sg;
+static volatile int stop;
+static long reader_rows, reader_torn;
+
+static void *reader(void *arg)
+{
+    static uint8_t buf[8 * ((SPECTROGRAM_ROW_HEADER + MAX_BINS + 3) & ~3)];
+    while (!stop) {
+        uint32_t head = spectrogram_head(&sg), first;
+        int n = spectrogram_read(&sg, head > 8 ? head - 8 : 0, 8, buf, &first);
+        for (int r = 0; r < n; r++) {
+            const uint8_t *row = buf + (size_t)r * sg.row_size;
+            const uint8_t *db = row + SPECTROGRAM_ROW_HEADER;
+            int peak = 0;
+            for (int b = 1; b < MAX_BINS; b++) {
+                if (db[b] > db[peak]) {
+                    peak = b;
+                }
+            }
+            if (row_seq(row) != first + r || peak != stress_peak(first + r) || db[peak] != 255) {
+                reader_torn++;
+            } else {
+                reader_rows++;
+            }
+        }
+        sched_yield();
+    }
+    return NULL;
+}
+
+int main(void)
+{
+    CHECK_EQ(spectrogram_init(&sg, 0, ROWS, DIVIDER, SCALE), ESP_ERR_INVALID_ARG);
+    CHECK_EQ(spectrogram_init(&sg, MAX_BINS, 1, DIVIDER, SCALE), ESP_ERR_INVALID_ARG);
+    CHECK_EQ(spectrogram_init(&sg, MAX_BINS, ROWS, DIVIDER, SCALE), ESP_OK);
+    CHECK_EQ(sg.row_size % 4, 0);
+    CHECK_EQ(spectrogram_bins(&sg), MAX_BINS);
+    CHECK_EQ(spectrogram_head(&sg), 0);
+
+    // Quantisierung: Rauschen über 100 dB Dynamik mit einer Spitze gegen 10 log10 je Bin
+    float power[MAX_BINS];
+    uint8_t q[MAX_BINS];
+    float top_db, max_err = 0.0f;
+    srand(17);
+    for (int run = 0; run < 200; run++) {
+        for (int b = 0; b < MAX_BINS; b++) {
+            power[b] = powf(10.0f, (rand() % 1000) / 100.0f);
+        }
+        power[run % MAX_BINS] = 1e11f;
+        spectrogram_quantize(power, MAX_BINS, SCALE, q, &top_db);
+        CHECK(fabsf(top_db - 10.0f * log10f(1e11f * SCALE)) < 1e-3f);
+        CHECK_EQ(q[run % MAX_BINS], 255);
+        for (int b = 0; b < MAX_BINS; b++) {
+            if (q[b] > 0) {
+                float approx = top_db - (255 - q[b]) * SPECTROGRAM_DB_STEP;
+                max_err = fmaxf(max_err, fabsf(approx - 10.0f * log10f(power[b] * SCALE)));
+            }
+        }
+    }
+    printf("quantize: max error %.3f dB\n", max_err);
+    CHECK(max_err <= MAX_ERR_DB);
+
+    // Stille liefert die leere Skala
+    memset(power, 0, sizeof(power));
+    spectrogram_quantize(power, MAX_BINS, SCALE, q, &top_db);
+    CHECK(top_db < -100.0f);
+    CHECK_EQ(q[0], 0);
+
+    // Eine Zeile ist der Mittelwert aus DIVIDER Frames, erst der letzte schließt sie ab
+    for (int b = 0; b < MAX_BINS; b++) {
+        power[b] = 1.0f;
+    }
+    power[24] = 1000.0f;
+    for (int f = 0; f < DIVIDER - 1; f++) {
+        CHECK(!spectrogram_push(&sg, power));
+    }
+    power[24] = 5000.0f;   // Mittelwert 2000
+    CHECK(spectrogram_push(&sg, power));
+    CHECK_EQ(spectrogram_head(&sg), 1);
+    uint8_t rows[ROWS][(SPECTROGRAM_ROW_HEADER + MAX_BINS + 3) & ~3];
+    uint32_t first;
+    CHECK_EQ(spectrogram_read(&sg, 0, 1, rows[0], &first), 1);
+    CHECK_EQ(first, 0);
+    CHECK_EQ(row_seq(rows[0]), 0);
+    CHECK(fabsf(row_top_db(rows[0]) - 10.0f * log10f(2000.0f * SCALE)) < 1e-3f);
+    CHECK_EQ(rows[0][SPECTROGRAM_ROW_HEADER + 24], 255);
+    CHECK(fabsf((255 - rows[0][SPECTROGRAM_ROW_HEADER]) * SPECTROGRAM_DB_STEP - 10.0f * log10f(2000.0f)) <= MAX_ERR_DB);
+
+    // Gehaltene Frames zählen einzeln, stille (NULL) Frames verdünnen den Mittelwert
+    power[24] = 1000.0f;
+    CHECK(spectrogram_push_frames(&sg, power, 2 * DIVIDER + 1));
+    CHECK_EQ(spectrogram_head(&sg), 3);
+    CHECK_EQ(sg.acc_count, 1);
+    CHECK(!spectrogram_push_frames(&sg, NULL, DIVIDER - 2));
+    CHECK(spectrogram_push_frames(&sg, NULL, 1));
+    CHECK_EQ(spectrogram_read(&sg, 1, 3, rows[0], &first), 3);
+    CHECK(fabsf(row_top_db(rows[1]) - 10.0f * log10f(1000.0f * SCALE)) < 1e-3f);
+    CHECK(fabsf(row_top_db(rows[2]) - 10.0f * log10f(1000.0f * SCALE / DIVIDER)) < 1e-3f);
+
+    // Zurücksetzen: alte Zeilen sind weg, neue Zeilen haben nur bins belegte Bins, der Rest ist 0
+    spectrogram_reset(&sg, 40, SCALE);
+    CHECK_EQ(spectrogram_bins(&sg), 40);
+    CHECK_EQ(spectrogram_oldest(&sg), 4);
+    CHECK_EQ(spectrogram_read(&sg, 0, ROWS, rows[0], &first), 0);
+    CHECK_EQ(first, 4);
+    memset(power, 0, sizeof(power));
+    for (int b = 0; b < 40; b++) {
+        power[b] = 10.0f + b;
+    }
+    for (int f = 0; f < DIVIDER; f++) {
+        spectrogram_push(&sg, power);
+    }
+    CHECK_EQ(spectrogram_read(&sg, 0, ROWS, rows[0], &first), 1);
+    CHECK_EQ(first, 4);
+    CHECK_EQ(rows[0][SPECTROGRAM_ROW_HEADER + 39], 255);
+    int tail = 0;
+    for (int b = 40; b < sg.row_size - SPECTROGRAM_ROW_HEADER; b++) {
+        tail |= rows[0][SPECTROGRAM_ROW_HEADER + b];
+    }
+    CHECK_EQ(tail, 0);
+    spectrogram_reset(&sg, 0, SCALE);   // ungültig: alle Bins
+    CHECK_EQ(spectrogram_bins(&sg), MAX_BINS);
+
+    // Überlauf: lesbar sind höchstens ROWS - 1 Zeilen, zu alte Nummern werden angehoben
+    for (int r = 0; r < 3 * ROWS; r++) {
+        stress_power(power, spectrogram_head(&sg));
+        spectrogram_push_frames(&sg, power, DIVIDER);
+    }
+    uint32_t head = spectrogram_head(&sg);
+    CHECK_EQ(head, 5 + 3 * ROWS);
+    CHECK_EQ(spectrogram_oldest(&sg), head - (ROWS - 1));
+    CHECK_EQ(spectrogram_read(&sg, 0, ROWS, rows[0], &first), ROWS - 1);
+    CHECK_EQ(first, head - (ROWS - 1));
+    for (int r = 0; r < ROWS - 1; r++) {
+        CHECK_EQ(row_seq(rows[r]), first + r);
+        CHECK_EQ(rows[r][SPECTROGRAM_ROW_HEADER + stress_peak(first + r)], 255);
+    }
+    CHECK_EQ(spectrogram_read(&sg, head, 1, rows[0], &first), 0);
+
+    // Nebenläufiger Leser über viele Umläufe des Rings
+    pthread_t thread;
+    CHECK_EQ(pthread_create(&thread, NULL, reader, NULL), 0);
+    for (int r = 0; r < STRESS_ROWS; r++) {
+        stress_power(power, spectrogram_head(&sg));
+        for (int f = 0; f < DIVIDER; f++) {
+            spectrogram_push(&sg, power);
+        }
+        if (r % 64 == 0) {
+            sched_yield();
+        }
+    }
+    stop = 1;
+    pthread_join(thread, NULL);
+    printf("reader: %ld rows, %ld torn\n", reader_rows, reader_torn);
+    CHECK(reader_rows > 0);
+    CHECK_EQ(reader_torn, 0);
+
+    spectrogram_deinit(&sg);
+    CHECK(sg.data == NULL && sg.acc == NULL);
+    return test_result("test_spectrogram");
+}
@@ -0,0 +1,90 @@
+/*
+ * spsc_ring (user-004): ein Produzenten- und ein Konsumenten-Thread. Der Konsument muss jeden Wert
+ * genau einmal und in Reihenfolge sehen; die Indizes starten kurz vor dem Überlauf von uint32_t.
+ */
+#include <pthread.h>
+#include <sched.h>
+#include <stdint.h>
+#include "spsc_ring.h"
+#include "test_util.h"
+
+#define CAPACITY 16
+#define ITEMS 5000000u
+
+static spsc_ring_t ring;
+static uint32_t storage[CAPACITY];
+static uint32_t max_count;
+
+static void *producer(void *arg)
+{
+    for (uint32_t i = 0; i < ITEMS; i++) {
+        while (!spsc_ring_push(&ring, i)) {
+            sched_yield();   // voll: Konsument laufen lassen (auch auf einem Kern)
+        }
+        uint32_t count = spsc_ring_count(&ring);
+        if (count > max_count) {
+            max_count = count;
+        }
+    }
+    return NULL;
+}
+
+static void *consumer(void *arg)
+{
+    uint32_t *errors = arg;
+    uint32_t expected = 0;
+    while (expected < ITEMS) {
+        uint32_t value;
+        if (!spsc_ring_pop(&ring, &value)) {
+            sched_yield();
+            continue;
+        }
+        if (value != expected) {
+            (*errors)++;
+            expected = value;
+        }
+        expected++;
+    }
+    return NULL;
+}
+
+static void test_single_thread(void)
+{
+    uint32_t buf[4];
+    uint32_t value;
+    CHECK(!spsc_ring_init(&ring, buf, 3));
+    CHECK(!spsc_ring_init(&ring, buf, 0));
+    CHECK(spsc_ring_init(&ring, buf, 4));
+    CHECK(!spsc_ring_pop(&ring, &value));
+    for (uint32_t i = 0; i < 4; i++) {
+        CHECK(spsc_ring_push(&ring, 10 + i));
+    }
+    CHECK(!spsc_ring_push(&ring, 99));   // voll
+    CHECK_EQ(spsc_ring_count(&ring), 4);
+    for (uint32_t i = 0; i < 4; i++) {
+        CHECK(spsc_ring_pop(&ring, &value));
+        CHECK_EQ(value, 10 + i);
+    }
+    CHECK(!spsc_ring_pop(&ring, &value));
+    CHECK_EQ(spsc_ring_count(&ring), 0);
+}
+
+int main(void)
+{
+    test_single_thread();
+
+    CHECK(spsc_ring_init(&ring, storage, CAPACITY));
+    atomic_store(&ring.head, UINT32_MAX - 1000);
+    atomic_store(&ring.tail, UINT32_MAX - 1000);
+    uint32_t errors = 0;
+    pthread_t prod, cons;
+    pthread_create(&cons, NULL, consumer, &errors);
+    pthread_create(&prod, NULL, producer, NULL);
+    pthread_join(prod, NULL);
+    pthread_join(cons, NULL);
+    printf("%u items, %u out of order, max fill %u of %u\n", ITEMS, errors, max_count, CAPACITY);
+    CHECK_EQ(errors, 0);
+    CHECK(max_count <= CAPACITY);
+    CHECK_EQ(spsc_ring_count(&ring), 0);
+    return test_result("test_spsc_ring");
+}
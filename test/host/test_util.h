@@ -0,0 +1,26 @@
+#pragma once
+// Minimale Prüfmakros für die Host-Tests: Fehler werden gezählt, main liefert test_result()
+#include <stdio.h>
+
+static int test_failures;
+
+#define CHECK(cond) do { \
+        if (!(cond)) { \
+            fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond); \
+            test_failures++; \
+        } \
+    } while (0)
+
+#define CHECK_EQ(a, b) do { \
+        long long a_ = (long long)(a), b_ = (long long)(b); \
+        if (a_ != b_) { \
+            fprintf(stderr, "%s:%d: %s == %s failed (%lld != %lld)\n", __FILE__, __LINE__, #a, #b, a_, b_); \
+            test_failures++; \
+        } \
+    } while (0)
+
+static inline int test_result(const char *name)
+{
+    printf("%s: %s\n", name, test_failures ? "FAILED" : "OK");
+    return test_failures ? 1 : 0;
+}